@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBoxFirstOrderTextureFeaturesImageFilter_h
+#define itkBoxFirstOrderTextureFeaturesImageFilter_h
+
+#include "itkBoxImageFilter.h"
+#include "itkFixedArray.h"
+#include "itkFirstOrderTextureHistogram.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ * \class BoxFirstOrderTextureFeaturesImageFilter
+ * \brief Compute first order statistics in a box neighborhood for each
+ * pixel.
+ *
+ * This filter computes the same features as
+ * FirstOrderTextureFeaturesImageFilter used with
+ * FlatStructuringElement::Box:
+ *   -# mean
+ *   -# minimum
+ *   -# maximum
+ *   -# variance
+ *   -# standard deviation (sigma)
+ *   -# skewness
+ *   -# kurtosis
+ *   -# entropy.
+ *
+ * The mean, variance, skewness and kurtosis are computed from summed-area
+ * tables of the first four powers of the pixel values, and the minimum and
+ * maximum from separable van Herk/Gil-Werman passes, so that the cost per
+ * pixel does not depend on the radius. These tables are built once for the
+ * whole output before the work units run. The entropy needs the histogram of
+ * the neighborhood, which is slid along the rows of the image. It is only
+ * computed when ComputeEntropy is on, and is set to zero otherwise.
+ *
+ * As in FirstOrderTextureFeaturesImageFilter, only the pixels inside of the
+ * image are considered near its boundary.
+ *
+ * \sa FirstOrderTextureFeaturesImageFilter
+ *
+ * \ingroup ITKTextureFeatures
+ */
+template< class TInputImage, class TOutputImage >
+class ITK_TEMPLATE_EXPORT BoxFirstOrderTextureFeaturesImageFilter:
+  public BoxImageFilter< TInputImage, TOutputImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(BoxFirstOrderTextureFeaturesImageFilter);
+
+  /** Standard class type alias. */
+  using Self = BoxFirstOrderTextureFeaturesImageFilter;
+  using Superclass = BoxImageFilter< TInputImage, TOutputImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BoxFirstOrderTextureFeaturesImageFilter, BoxImageFilter);
+
+  /** Image related type alias. */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using RegionType = typename TInputImage::RegionType;
+  using SizeType = typename TInputImage::SizeType;
+  using IndexType = typename TInputImage::IndexType;
+  using IndexValueType = typename IndexType::IndexValueType;
+  using PixelType = typename TInputImage::PixelType;
+  using OutputImageRegionType = typename Superclass::OutputImageRegionType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using RadiusType = typename Superclass::RadiusType;
+
+  /** Image related type alias. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  /** Whether the entropy is computed. (Optional, defaults to false.) */
+  itkSetMacro( ComputeEntropy, bool );
+  itkGetConstMacro( ComputeEntropy, bool );
+  itkBooleanMacro( ComputeEntropy );
+
+protected:
+
+  unsigned int GetNumberOfOutputComponents() { return 8;}
+
+  BoxFirstOrderTextureFeaturesImageFilter();
+  ~BoxFirstOrderTextureFeaturesImageFilter() override {}
+
+  void GenerateOutputInformation() override;
+
+  /** Build the summed-area table and the minimum and maximum images over the
+   * neighborhoods of the output requested region. */
+  void BeforeThreadedGenerateData() override;
+
+  /** Free the tables. */
+  void AfterThreadedGenerateData() override;
+
+  void DynamicThreadedGenerateData( const OutputImageRegionType & outputRegionForThread ) override;
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Summed-area table of the first four powers of the pixel values, shifted
+   * by a value close to their mean to limit the rounding errors. */
+  using MomentsType = FixedArray< double, 4 >;
+  using MomentsImageType = Image< MomentsType, ImageDimension >;
+  using ExtremaImageType = Image< PixelType, ImageDimension >;
+  using EntropyHistogramType = Function::FirstOrderTextureHistogram< PixelType, FixedArray< double, 8 > >;
+
+  /** Fill momentsImage over its buffered region, and return the shift of the
+   * pixel values. The lines are split among the work units. */
+  double ComputeMomentsImage( MomentsImageType * momentsImage );
+
+  /** Replace the pixels of extremaImage by the extremum of their box
+   * neighborhood inside of the buffered region, compare(a, b) being true when
+   * a is a better extremum than b. */
+  template< typename TCompare >
+  void ComputeExtremaImage( ExtremaImageType * extremaImage, const PixelType & identity, TCompare compare );
+
+  /** Add, or remove, the pixels of the region to the histogram. */
+  void UpdateHistogram( EntropyHistogramType & histogram, const RegionType & region, bool add ) const;
+
+private:
+  bool m_ComputeEntropy;
+
+  typename MomentsImageType::Pointer m_MomentsImage;
+  double                             m_Shift;
+  typename ExtremaImageType::Pointer m_MinimumImage;
+  typename ExtremaImageType::Pointer m_MaximumImage;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBoxFirstOrderTextureFeaturesImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,427 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkBoxFirstOrderTextureFeaturesImageFilter_hxx
+#define itkBoxFirstOrderTextureFeaturesImageFilter_hxx
+
+#include "itkBoxFirstOrderTextureFeaturesImageFilter.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace itk
+{
+template< class TInputImage, class TOutputImage >
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::BoxFirstOrderTextureFeaturesImageFilter() :
+    m_ComputeEntropy( false ),
+    m_Shift( 0.0 )
+{
+  this->DynamicMultiThreadingOn();
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation()
+{
+  // Call superclass's version
+  Superclass::GenerateOutputInformation();
+
+  OutputImageType* output = this->GetOutput();
+  // If the output image type is a VectorImage the number of
+  // components will be properly sized if before allocation, if the
+  // output is a fixed width vector and the wrong number of
+  // components, then an exception will be thrown.
+  if ( output->GetNumberOfComponentsPerPixel() != this->GetNumberOfOutputComponents() )
+    {
+    output->SetNumberOfComponentsPerPixel( this->GetNumberOfOutputComponents() );
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  const InputImageType * input = this->GetInput();
+
+  // Region of the input pixels in the neighborhoods of the output. The
+  // tables of the neighborhoods shared by several work units are only built
+  // once.
+  RegionType accumRegion = this->GetOutput()->GetRequestedRegion();
+  accumRegion.PadByRadius( this->GetRadius() );
+  accumRegion.Crop( input->GetRequestedRegion() );
+
+  m_MomentsImage = MomentsImageType::New();
+  m_MomentsImage->SetRegions( accumRegion );
+  m_MomentsImage->Allocate();
+  m_Shift = this->ComputeMomentsImage( m_MomentsImage );
+
+  m_MinimumImage = ExtremaImageType::New();
+  m_MinimumImage->SetRegions( accumRegion );
+  m_MinimumImage->Allocate();
+  ImageAlgorithm::Copy( input, m_MinimumImage.GetPointer(), accumRegion, accumRegion );
+  this->ComputeExtremaImage( m_MinimumImage, NumericTraits< PixelType >::max(), std::less< PixelType >() );
+
+  m_MaximumImage = ExtremaImageType::New();
+  m_MaximumImage->SetRegions( accumRegion );
+  m_MaximumImage->Allocate();
+  ImageAlgorithm::Copy( input, m_MaximumImage.GetPointer(), accumRegion, accumRegion );
+  this->ComputeExtremaImage( m_MaximumImage, NumericTraits< PixelType >::NonpositiveMin(),
+                             std::greater< PixelType >() );
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  m_MomentsImage = nullptr;
+  m_MinimumImage = nullptr;
+  m_MaximumImage = nullptr;
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::DynamicThreadedGenerateData( const OutputImageRegionType & outputRegionForThread )
+{
+  OutputImageType * output = this->GetOutput();
+  const RadiusType radius = this->GetRadius();
+  const MomentsImageType * momentsImage = m_MomentsImage.GetPointer();
+  const ExtremaImageType * minimumImage = m_MinimumImage.GetPointer();
+  const ExtremaImageType * maximumImage = m_MaximumImage.GetPointer();
+  const RegionType accumRegion = momentsImage->GetBufferedRegion();
+
+  const IndexType accumStart = accumRegion.GetIndex();
+  IndexType accumEnd;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    accumEnd[d] = accumStart[d] + static_cast< IndexValueType >( accumRegion.GetSize( d ) ) - 1;
+    }
+
+  EntropyHistogramType histogram;
+  RegionType histogramRegion;
+  bool histogramIsEmpty = true;
+
+  OutputPixelType out;
+  NumericTraits<OutputPixelType>::SetLength( out, 8 );
+
+  ImageRegionIteratorWithIndex< OutputImageType > outputIt( output, outputRegionForThread );
+  for (; !outputIt.IsAtEnd(); ++outputIt )
+    {
+    const IndexType index = outputIt.GetIndex();
+
+    // Box of the neighborhood inside of the image, with the index just below
+    // it in low
+    IndexType low;
+    IndexType high;
+    SizeType boxSize;
+    size_t count = 1;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      const auto r = static_cast< IndexValueType >( radius[d] );
+      low[d] = std::max( index[d] - r, accumStart[d] ) - 1;
+      high[d] = std::min( index[d] + r, accumEnd[d] );
+      boxSize[d] = high[d] - low[d];
+      count *= boxSize[d];
+      }
+
+    // Sums over the box from the summed-area table
+    MomentsType sums;
+    sums.Fill( 0.0 );
+    for ( unsigned int corner = 0; corner < ( 1u << ImageDimension ); ++corner )
+      {
+      IndexType cornerIndex;
+      double sign = 1.0;
+      bool insideTable = true;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        if ( corner & ( 1u << d ) )
+          {
+          cornerIndex[d] = low[d];
+          sign = -sign;
+          insideTable = insideTable && low[d] >= accumStart[d];
+          }
+        else
+          {
+          cornerIndex[d] = high[d];
+          }
+        }
+      if ( insideTable )
+        {
+        const MomentsType & moments = momentsImage->GetPixel( cornerIndex );
+        for ( unsigned int k = 0; k < 4; ++k )
+          {
+          sums[k] += sign * moments[k];
+          }
+        }
+      }
+
+    // The moments of the shifted values give the same central moments
+    const double sum = sums[0];
+    const double sum2 = sums[1];
+    const double sum3 = sums[2];
+    const double sum4 = sums[3];
+    const double mean = sum / count;
+
+    // unbiased estimate, which rounding errors may make slightly negative in
+    // a uniform neighborhood
+    const double variance = std::max( ( sum2 - ( sum * sum ) / count )  / ( count - 1 ), 0.0 );
+    const double sigma = std::sqrt(variance);
+    double skewness = 0.0;
+    double kurtosis = 0.0;
+    if(std::abs(variance * sigma) > itk::NumericTraits<double>::min())
+      {
+
+      skewness = ( ( sum3 - 3.0 * mean * sum2 ) / count + 2.0 * mean * mean*mean ) / ( variance * sigma );
+      }
+    if(std::abs(variance) > itk::NumericTraits<double>::min())
+      {
+      kurtosis = ( sum4 / count  + mean *( -4.0 * sum3 / count  +  mean * ( 6.0 *sum2 / count  - 3.0 * mean * mean ))) /
+        ( variance * variance ) - 3.0;
+      }
+
+    double entropy = 0.0;
+    if ( m_ComputeEntropy )
+      {
+      IndexType boxStart = low;
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        ++boxStart[d];
+        }
+      const RegionType boxRegion( boxStart, boxSize );
+
+      // Slide the histogram along the row, or start again from the box
+      if ( !histogramIsEmpty && index[0] != outputRegionForThread.GetIndex( 0 ) )
+        {
+        RegionType sliceRegion = histogramRegion;
+        sliceRegion.SetSize( 0, 1 );
+        if ( boxRegion.GetIndex( 0 ) > histogramRegion.GetIndex( 0 ) )
+          {
+          this->UpdateHistogram( histogram, sliceRegion, false );
+          }
+        if ( high[0] > histogramRegion.GetUpperIndex()[0] )
+          {
+          sliceRegion.SetIndex( 0, high[0] );
+          this->UpdateHistogram( histogram, sliceRegion, true );
+          }
+        }
+      else
+        {
+        if ( !histogramIsEmpty )
+          {
+          this->UpdateHistogram( histogram, histogramRegion, false );
+          }
+        this->UpdateHistogram( histogram, boxRegion, true );
+        histogramIsEmpty = false;
+        }
+      histogramRegion = boxRegion;
+      entropy = histogram.GetValue( PixelType() )[7];
+      }
+
+    unsigned int i = 0;
+    out[i++] = mean + m_Shift;
+    out[i++] = minimumImage->GetPixel( index );
+    out[i++] = maximumImage->GetPixel( index );
+    out[i++] = variance;
+    out[i++] = sigma;
+    out[i++] = skewness;
+    out[i++] = kurtosis;
+    out[i++] = entropy;
+    outputIt.Set( out );
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+double
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::ComputeMomentsImage( MomentsImageType * momentsImage )
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType region = momentsImage->GetBufferedRegion();
+
+  // Shifting the pixel values by their mean keeps the sums of their powers,
+  // and the rounding errors, small
+  ImageRegionConstIterator< InputImageType > inputIt( input, region );
+  double shift = 0.0;
+  for (; !inputIt.IsAtEnd(); ++inputIt )
+    {
+    shift += inputIt.Get();
+    }
+  shift /= region.GetNumberOfPixels();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+  multiThreader->template ParallelizeImageRegion< ImageDimension >( region,
+    [input, momentsImage, shift]( const RegionType & pieceRegion )
+      {
+      ImageRegionConstIterator< InputImageType > pieceIt( input, pieceRegion );
+      ImageRegionIterator< MomentsImageType > momentsIt( momentsImage, pieceRegion );
+      for (; !pieceIt.IsAtEnd(); ++pieceIt, ++momentsIt )
+        {
+        const double x = double( pieceIt.Get() ) - shift;
+        MomentsType moments;
+        double t = x;
+        moments[0] = t;
+        moments[1] = ( t *= x );
+        moments[2] = ( t *= x );
+        moments[3] = ( t *= x );
+        momentsIt.Set( moments );
+        }
+      },
+    nullptr );
+
+  // Cumulative sums along each dimension, the lines being split among the
+  // work units
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    multiThreader->template ParallelizeImageRegionRestrictDirection< ImageDimension >( d, region,
+      [momentsImage, d]( const RegionType & linesRegion )
+        {
+        ImageLinearIteratorWithIndex< MomentsImageType > lineIt( momentsImage, linesRegion );
+        lineIt.SetDirection( d );
+        lineIt.GoToBegin();
+        while ( !lineIt.IsAtEnd() )
+          {
+          MomentsType sums;
+          sums.Fill( 0.0 );
+          while ( !lineIt.IsAtEndOfLine() )
+            {
+            MomentsType & moments = lineIt.Value();
+            for ( unsigned int k = 0; k < 4; ++k )
+              {
+              sums[k] += moments[k];
+              moments[k] = sums[k];
+              }
+            ++lineIt;
+            }
+          lineIt.NextLine();
+          }
+        },
+      nullptr );
+    }
+
+  return shift;
+}
+
+template< class TInputImage, class TOutputImage >
+template< typename TCompare >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::ComputeExtremaImage( ExtremaImageType * extremaImage, const PixelType & identity, TCompare compare )
+{
+  const RegionType region = extremaImage->GetBufferedRegion();
+  const RadiusType radius = this->GetRadius();
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+
+  // The box extremum is separable
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( radius[d] == 0 )
+      {
+      continue;
+      }
+
+    // The lines are padded by the radius with the identity on both sides, so
+    // that all the windows have the same size, and cut in blocks of the
+    // window size. The extremum over a window is the one of the end of the
+    // block of its first pixel and of the beginning of the block of its last
+    // pixel.
+    const SizeValueType windowSize = 2 * radius[d] + 1;
+    const SizeValueType bufferSize = region.GetSize( d ) + 2 * radius[d];
+    const SizeValueType padding = radius[d];
+
+    multiThreader->template ParallelizeImageRegionRestrictDirection< ImageDimension >( d, region,
+      [extremaImage, d, identity, &compare, windowSize, bufferSize, padding]( const RegionType & linesRegion )
+        {
+        std::vector< PixelType > buffer( bufferSize, identity );
+        std::vector< PixelType > forward( bufferSize );
+        std::vector< PixelType > backward( bufferSize );
+
+        ImageLinearIteratorWithIndex< ExtremaImageType > lineIt( extremaImage, linesRegion );
+        lineIt.SetDirection( d );
+        lineIt.GoToBegin();
+        while ( !lineIt.IsAtEnd() )
+          {
+          for ( SizeValueType i = padding; !lineIt.IsAtEndOfLine(); ++lineIt, ++i )
+            {
+            buffer[i] = lineIt.Get();
+            }
+
+          for ( SizeValueType i = 0; i < bufferSize; ++i )
+            {
+            forward[i] = ( i % windowSize == 0 || compare( buffer[i], forward[i - 1] ) ) ? buffer[i] : forward[i - 1];
+            }
+          for ( SizeValueType i = bufferSize; i-- > 0; )
+            {
+            backward[i] = ( i + 1 == bufferSize || ( i + 1 ) % windowSize == 0
+                            || compare( buffer[i], backward[i + 1] ) ) ? buffer[i] : backward[i + 1];
+            }
+
+          lineIt.GoToBeginOfLine();
+          for ( SizeValueType i = 0; !lineIt.IsAtEndOfLine(); ++lineIt, ++i )
+            {
+            const PixelType & last = forward[i + windowSize - 1];
+            lineIt.Set( compare( last, backward[i] ) ? last : backward[i] );
+            }
+          lineIt.NextLine();
+          }
+        },
+      nullptr );
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::UpdateHistogram( EntropyHistogramType & histogram, const RegionType & region, bool add ) const
+{
+  ImageRegionConstIterator< InputImageType > inputIt( this->GetInput(), region );
+  for (; !inputIt.IsAtEnd(); ++inputIt )
+    {
+    if ( add )
+      {
+      histogram.AddPixel( inputIt.Get() );
+      }
+    else
+      {
+      histogram.RemovePixel( inputIt.Get() );
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void
+BoxFirstOrderTextureFeaturesImageFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "ComputeEntropy: " << m_ComputeEntropy << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -0,0 +1,315 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkCompactTextureFeatures_h
+#define itkCompactTextureFeatures_h
+
+#include "itkDataObject.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageScanlineConstIterator.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class CompactTextureFeatures
+ * \brief Texture features of the voxels inside of the mask only.
+ *
+ * The features are stored as a dense matrix with one row of
+ * NumberOfComponentsPerPixel values per voxel inside of the mask, and the
+ * positions of these voxels as runs along the first dimension, in the order
+ * of the rows. The memory footprint depends on the number of voxels inside
+ * of the mask instead of the size of the image.
+ *
+ * ScatterToImage() writes the features in an image of the geometry of the
+ * output of the filter, the voxels outside of the mask being set to zero.
+ *
+ * \sa CoocurrenceTextureFeaturesImageFilter
+ * \sa RunLengthTextureFeaturesImageFilter
+ * \sa TextureFeatureBankImageFilter
+ *
+ * \ingroup TextureFeatures
+ */
+template< typename TOutputImage >
+class ITK_TEMPLATE_EXPORT CompactTextureFeatures : public DataObject
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(CompactTextureFeatures);
+
+  /** Standard class type alias. */
+  using Self = CompactTextureFeatures;
+  using Superclass = DataObject;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(CompactTextureFeatures, DataObject);
+
+  using ImageType = TOutputImage;
+  using PixelType = typename TOutputImage::PixelType;
+  using ValueType = typename NumericTraits< PixelType >::ValueType;
+  using RegionType = typename TOutputImage::RegionType;
+  using IndexType = typename TOutputImage::IndexType;
+
+  static constexpr unsigned int ImageDimension = TOutputImage::ImageDimension;
+
+  /** Voxels inside of the mask, consecutive along the first dimension, whose
+   * features start at row FirstRow. */
+  struct RunType
+  {
+    IndexType     m_Index;
+    SizeValueType m_Length;
+    SizeValueType m_FirstRow;
+  };
+  using RunVectorType = std::vector< RunType >;
+
+  /** Write the features of consecutive rows, starting from the one of the
+   * first voxel of a region lying in a run. */
+  class Iterator
+  {
+  public:
+    Iterator( Self * features, const RegionType & region ) :
+      m_Row( features->GetFeatures( features->GetRow( region.GetIndex() ) ) ),
+      m_NumberOfComponents( features->GetNumberOfComponentsPerPixel() )
+    {}
+
+    void Set( const PixelType & pixel )
+    {
+      for( unsigned int i = 0; i < m_NumberOfComponents; ++i )
+        {
+        m_Row[i] = pixel[i];
+        }
+    }
+
+    Iterator & operator++()
+    {
+      m_Row += m_NumberOfComponents;
+      return *this;
+    }
+
+  private:
+    ValueType *  m_Row;
+    unsigned int m_NumberOfComponents;
+  };
+
+  /** Geometry of the image the features are computed on. */
+  void CopyImageInformation( const ImageBase< ImageDimension > * image )
+  {
+    m_Region = image->GetRequestedRegion();
+    m_Spacing = image->GetSpacing();
+    m_Origin = image->GetOrigin();
+    m_Direction = image->GetDirection();
+  }
+  const RegionType & GetRegion() const { return m_Region; }
+
+  /** Record the runs of voxels of the digitized image different from
+   * outsideMaskValue in the region, and allocate their features. */
+  template< typename TDigitizedImage >
+  void Allocate( const TDigitizedImage * digitizedImage,
+                 const typename TDigitizedImage::PixelType & outsideMaskValue,
+                 unsigned int numberOfComponents )
+  {
+    m_Runs.clear();
+    m_NumberOfVoxels = 0;
+    ImageScanlineConstIterator< TDigitizedImage > it( digitizedImage, m_Region );
+    while( !it.IsAtEnd() )
+      {
+      IndexType runIndex = it.GetIndex();
+      SizeValueType length = 0;
+      for(; !it.IsAtEndOfLine(); ++it, ++runIndex[0] )
+        {
+        if( it.Get() != outsideMaskValue )
+          {
+          ++length;
+          continue;
+          }
+        this->AddRun( runIndex, length );
+        length = 0;
+        }
+      this->AddRun( runIndex, length );
+      it.NextLine();
+      }
+
+    m_NumberOfComponents = numberOfComponents;
+    m_Features.assign( m_NumberOfVoxels * numberOfComponents, NumericTraits< ValueType >::ZeroValue() );
+  }
+
+  unsigned int GetNumberOfComponentsPerPixel() const { return m_NumberOfComponents; }
+
+  /** Number of voxels inside of the mask, i.e. of rows of the features. */
+  SizeValueType GetNumberOfVoxels() const { return m_NumberOfVoxels; }
+
+  const RunVectorType & GetRuns() const { return m_Runs; }
+
+  /** Region of the voxels of a run. */
+  RegionType GetRunRegion( const RunType & run ) const
+  {
+    RegionType region;
+    region.SetIndex( run.m_Index );
+    region.SetSize( 0, run.m_Length );
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+      region.SetSize( d, 1 );
+      }
+    return region;
+  }
+
+  /** Row of the features of a voxel inside of the mask. */
+  SizeValueType GetRow( const IndexType & index ) const
+  {
+    // Last run starting at or before the index in the scan order
+    const auto run = std::upper_bound( m_Runs.begin(), m_Runs.end(), index,
+      []( const IndexType & a, const RunType & b )
+      {
+      for( unsigned int d = ImageDimension; d > 0; --d )
+        {
+        if( a[d - 1] != b.m_Index[d - 1] )
+          {
+          return a[d - 1] < b.m_Index[d - 1];
+          }
+        }
+      return false;
+      } ) - 1;
+    return run->m_FirstRow + static_cast< SizeValueType >( index[0] - run->m_Index[0] );
+  }
+
+  ValueType * GetFeatures( SizeValueType row ) { return m_Features.data() + row * m_NumberOfComponents; }
+  const ValueType * GetFeatures( SizeValueType row ) const { return m_Features.data() + row * m_NumberOfComponents; }
+
+  /** Split the runs in at most numberOfPieces ranges [ first, last ) of about
+   * the same number of voxels, and return the bounds of the ranges. */
+  std::vector< SizeValueType > SplitRuns( unsigned int numberOfPieces ) const
+  {
+    std::vector< SizeValueType > bounds( 1, 0 );
+    for( SizeValueType r = 0; r < m_Runs.size(); ++r )
+      {
+      const SizeValueType voxels = m_Runs[r].m_FirstRow + m_Runs[r].m_Length;
+      if( voxels * numberOfPieces >= m_NumberOfVoxels * bounds.size() || r + 1 == m_Runs.size() )
+        {
+        bounds.push_back( r + 1 );
+        }
+      }
+    return bounds;
+  }
+
+  /** Image of the geometry of the output of the filter holding the features
+   * inside of the mask, and zero outside of it. */
+  typename TOutputImage::Pointer ScatterToImage() const
+  {
+    typename TOutputImage::Pointer image = TOutputImage::New();
+    image->SetRegions( m_Region );
+    image->SetSpacing( m_Spacing );
+    image->SetOrigin( m_Origin );
+    image->SetDirection( m_Direction );
+    image->SetNumberOfComponentsPerPixel( m_NumberOfComponents );
+    image->Allocate();
+
+    PixelType pixel;
+    NumericTraits< PixelType >::SetLength( pixel, m_NumberOfComponents );
+    pixel.Fill( NumericTraits< ValueType >::ZeroValue() );
+    image->FillBuffer( pixel );
+
+    for( const RunType & run : m_Runs )
+      {
+      const ValueType * row = this->GetFeatures( run.m_FirstRow );
+      for( ImageRegionIterator< TOutputImage > it( image, this->GetRunRegion( run ) ); !it.IsAtEnd(); ++it )
+        {
+        for( unsigned int i = 0; i < m_NumberOfComponents; ++i )
+          {
+          pixel[i] = *row++;
+          }
+        it.Set( pixel );
+        }
+      }
+    return image;
+  }
+
+  /** Release the features and the runs. */
+  void Initialize() override
+  {
+    Superclass::Initialize();
+    m_Runs.clear();
+    m_Features.clear();
+    m_NumberOfVoxels = 0;
+  }
+
+protected:
+  CompactTextureFeatures() = default;
+  ~CompactTextureFeatures() override = default;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override
+  {
+    Superclass::PrintSelf( os, indent );
+    os << indent << "Region: " << m_Region << std::endl;
+    os << indent << "NumberOfComponentsPerPixel: " << m_NumberOfComponents << std::endl;
+    os << indent << "NumberOfVoxels: " << m_NumberOfVoxels << std::endl;
+    os << indent << "NumberOfRuns: " << m_Runs.size() << std::endl;
+  }
+
+private:
+  /** Add the run of length voxels ending before index. */
+  void AddRun( const IndexType & index, SizeValueType length )
+  {
+    if( length == 0 )
+      {
+      return;
+      }
+    RunType run;
+    run.m_Index = index;
+    run.m_Index[0] -= static_cast< IndexValueType >( length );
+    run.m_Length = length;
+    run.m_FirstRow = m_NumberOfVoxels;
+    m_Runs.push_back( run );
+    m_NumberOfVoxels += length;
+  }
+
+  RegionType                           m_Region;
+  typename TOutputImage::SpacingType   m_Spacing;
+  typename TOutputImage::PointType     m_Origin;
+  typename TOutputImage::DirectionType m_Direction;
+  unsigned int                         m_NumberOfComponents{ 0 };
+  SizeValueType                        m_NumberOfVoxels{ 0 };
+  RunVectorType                        m_Runs;
+  std::vector< ValueType >             m_Features;
+};
+
+/** Iterator writing the features of a region to the output of a filter,
+ * either an image or CompactTextureFeatures. */
+template< typename TOutput >
+struct TextureFeatureOutputIterator
+{
+  using Type = ImageRegionIterator< TOutput >;
+};
+
+template< typename TOutputImage >
+struct TextureFeatureOutputIterator< CompactTextureFeatures< TOutputImage > >
+{
+  using Type = typename CompactTextureFeatures< TOutputImage >::Iterator;
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
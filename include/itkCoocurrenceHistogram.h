@@ -0,0 +1,249 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkCoocurrenceHistogram_h
+#define itkCoocurrenceHistogram_h
+
+#include "itkIntTypes.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class DenseCoocurrenceHistogram
+ * \brief Co-occurrence matrix stored as a full NumberOfBins x NumberOfBins
+ * array.
+ *
+ * Increments and decrements are a single memory access. The bins that are
+ * non-zero are also recorded in a list while the matrix is accumulated, so
+ * that clearing the matrix and visiting its non-zero bins only depend on the
+ * number of non-zero bins. The memory footprint is NumberOfBins^2.
+ *
+ * \sa SparseCoocurrenceHistogram
+ * \ingroup TextureFeatures
+ */
+class DenseCoocurrenceHistogram
+{
+public:
+  void Initialize( unsigned int numberOfBins, SizeValueType maximumNumberOfPairs )
+  {
+    const SizeValueType numberOfCells = static_cast< SizeValueType >( numberOfBins ) * numberOfBins;
+    m_NumberOfBins = numberOfBins;
+    m_Frequencies.assign( numberOfCells, 0 );
+    m_Positions.assign( numberOfCells, 0 );
+    m_NonZeroBins.clear();
+    m_NonZeroBins.reserve( std::min( numberOfCells, maximumNumberOfPairs ) );
+  }
+
+  void Clear()
+  {
+    for( const BinType & bin : m_NonZeroBins )
+      {
+      m_Frequencies[this->GetCell( bin.m_First, bin.m_Second )] = 0;
+      }
+    m_NonZeroBins.clear();
+  }
+
+  void Increment( unsigned int a, unsigned int b, unsigned int frequency = 1 )
+  {
+    const SizeValueType cell = this->GetCell( a, b );
+    if( m_Frequencies[cell] == 0 )
+      {
+      m_Positions[cell] = static_cast< unsigned int >( m_NonZeroBins.size() );
+      m_NonZeroBins.push_back( BinType{ a, b } );
+      }
+    m_Frequencies[cell] += frequency;
+  }
+
+  /** The bin ( a, b ) must be non-zero. */
+  void Decrement( unsigned int a, unsigned int b )
+  {
+    const SizeValueType cell = this->GetCell( a, b );
+    if( --m_Frequencies[cell] == 0 )
+      {
+      // Move the last non-zero bin in place of the removed one
+      const BinType last = m_NonZeroBins.back();
+      m_NonZeroBins[m_Positions[cell]] = last;
+      m_Positions[this->GetCell( last.m_First, last.m_Second )] = m_Positions[cell];
+      m_NonZeroBins.pop_back();
+      }
+  }
+
+  /** Call visitor( a, b, frequency ) for each non-zero bin. */
+  template< typename TVisitor >
+  void VisitNonZeroBins( const TVisitor & visitor ) const
+  {
+    for( const BinType & bin : m_NonZeroBins )
+      {
+      visitor( bin.m_First, bin.m_Second, m_Frequencies[this->GetCell( bin.m_First, bin.m_Second )] );
+      }
+  }
+
+private:
+  struct BinType
+  {
+    unsigned int m_First;
+    unsigned int m_Second;
+  };
+
+  SizeValueType GetCell( unsigned int a, unsigned int b ) const
+  {
+    return static_cast< SizeValueType >( a ) * m_NumberOfBins + b;
+  }
+
+  std::vector< unsigned int > m_Frequencies;
+  std::vector< unsigned int > m_Positions;
+  std::vector< BinType >      m_NonZeroBins;
+  unsigned int                m_NumberOfBins{ 0 };
+};
+
+
+/** \class SparseCoocurrenceHistogram
+ * \brief Co-occurrence matrix storing only its non-zero bins in an open
+ * addressing hash table.
+ *
+ * The table is sized from the maximum number of pairs that can be counted in
+ * a neighborhood, so that clearing the matrix and visiting its non-zero bins
+ * only depend on the neighborhood size and not on NumberOfBins^2. Collisions
+ * are resolved by linear probing, and removed bins are backward shifted so
+ * that no tombstone is needed when the matrix is updated with a sliding
+ * window.
+ *
+ * \sa DenseCoocurrenceHistogram
+ * \ingroup TextureFeatures
+ */
+class SparseCoocurrenceHistogram
+{
+public:
+  void Initialize( unsigned int numberOfBins, SizeValueType maximumNumberOfPairs )
+  {
+    // Keep the load factor below one half.
+    const std::uint64_t maximumNumberOfNonZeroBins =
+      std::min( static_cast< std::uint64_t >( numberOfBins ) * numberOfBins,
+                static_cast< std::uint64_t >( maximumNumberOfPairs ) );
+    std::uint64_t capacity = 16;
+    unsigned int  capacityBits = 4;
+    while( capacity < 2 * maximumNumberOfNonZeroBins )
+      {
+      capacity <<= 1;
+      ++capacityBits;
+      }
+    m_NumberOfBins = numberOfBins;
+    m_Mask = capacity - 1;
+    m_Shift = 64 - capacityBits;
+    m_Bins.assign( capacity, BinType() );
+  }
+
+  void Clear()
+  {
+    std::fill( m_Bins.begin(), m_Bins.end(), BinType() );
+  }
+
+  void Increment( unsigned int a, unsigned int b, unsigned int frequency = 1 )
+  {
+    std::uint64_t i = this->Hash( a, b );
+    while( m_Bins[i].m_Frequency != 0 && ( m_Bins[i].m_First != a || m_Bins[i].m_Second != b ) )
+      {
+      i = ( i + 1 ) & m_Mask;
+      }
+    BinType & bin = m_Bins[i];
+    bin.m_First = a;
+    bin.m_Second = b;
+    bin.m_Frequency += frequency;
+  }
+
+  /** The bin ( a, b ) must be non-zero. */
+  void Decrement( unsigned int a, unsigned int b )
+  {
+    std::uint64_t i = this->Hash( a, b );
+    while( m_Bins[i].m_Frequency == 0 || m_Bins[i].m_First != a || m_Bins[i].m_Second != b )
+      {
+      i = ( i + 1 ) & m_Mask;
+      }
+    if( --m_Bins[i].m_Frequency == 0 )
+      {
+      this->RemoveBin( i );
+      }
+  }
+
+  /** Call visitor( a, b, frequency ) for each non-zero bin. */
+  template< typename TVisitor >
+  void VisitNonZeroBins( const TVisitor & visitor ) const
+  {
+    for( const BinType & bin : m_Bins )
+      {
+      if( bin.m_Frequency != 0 )
+        {
+        visitor( bin.m_First, bin.m_Second, bin.m_Frequency );
+        }
+      }
+  }
+
+private:
+  struct BinType
+  {
+    unsigned int m_First = 0;
+    unsigned int m_Second = 0;
+    unsigned int m_Frequency = 0;
+  };
+
+  std::uint64_t Hash( unsigned int a, unsigned int b ) const
+  {
+    // Fibonacci hashing of the linear bin index
+    const std::uint64_t key = static_cast< std::uint64_t >( a ) * m_NumberOfBins + b;
+    return ( key * 11400714819323198485ULL ) >> m_Shift;
+  }
+
+  /** Empty the slot i and shift back the following bins of the same
+   * cluster that can be moved closer to their home slot. */
+  void RemoveBin( std::uint64_t i )
+  {
+    std::uint64_t j = i;
+    while( true )
+      {
+      j = ( j + 1 ) & m_Mask;
+      if( m_Bins[j].m_Frequency == 0 )
+        {
+        break;
+        }
+      const std::uint64_t home = this->Hash( m_Bins[j].m_First, m_Bins[j].m_Second );
+      const bool homeBetween = ( i <= j ) ? ( i < home && home <= j ) : ( i < home || home <= j );
+      if( !homeBetween )
+        {
+        m_Bins[i] = m_Bins[j];
+        i = j;
+        }
+      }
+    m_Bins[i].m_Frequency = 0;
+  }
+
+  std::vector< BinType > m_Bins;
+  std::uint64_t          m_Mask{ 0 };
+  unsigned int           m_Shift{ 64 };
+  unsigned int           m_NumberOfBins{ 0 };
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
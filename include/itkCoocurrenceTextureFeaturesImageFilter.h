@@ -18,9 +18,12 @@
 #ifndef itkCoocurrenceTextureFeaturesImageFilter_h
 #define itkCoocurrenceTextureFeaturesImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include "itkTextureFeaturesImageFilterBase.h"
 #include "itkScalarImageToRunLengthMatrixFilter.h"
-#include "itkConstNeighborhoodIterator.h"
+#include "itkCoocurrenceHistogram.h"
+
+#include <utility>
+#include <vector>
 
 namespace itk
 {
@@ -32,10 +35,11 @@ namespace Statistics
  *  displayed by using colormaps.
  *
  * This filter computes a N-D image where each voxel will contain
- * a vector of up to 8 scalars representing the texture features
+ * a vector of up to 8 scalars representing the selected texture features
  * (of the specified neighborhood) from a N-D scalar image.
  * The texture features are computed for each spatial
- * direction and averaged afterward.
+ * direction and averaged afterward. With PerOffsetFeatures on, the features
+ * of each direction are also kept, in the same pass over the image.
  *
  * This filter use grey-level co-occurence matrix in order to compute  description a la Haralick. (See
  * Haralick, R.M., K. Shanmugam and I. Dinstein. 1973. Textural Features for
@@ -51,15 +55,36 @@ namespace Statistics
  * -# An image
  * -# A mask defining the region over which texture features will be
  *    calculated. (Optional)
+ * -# The image digitized by a DigitizerImageFilter. (Optional, computed from
+ *    the image and the mask by default.)
  * -# The pixel value that defines the "inside" of the mask. (Optional, defaults
  *    to 1 if a mask is set.)
- * -# The number of intensity bins. (Optional, defaults to 256.)
+ * -# The number of intensity bins. (Optional, defaults to 256, at most 65534.)
+ * -# The numbers of bins of coarser quantizations computed from the same
+ *    digitization. (Optional, defaults to none.)
  * -# The set of directions (offsets) to average across. (Optional, defaults to
  *    {(-1, 0), (-1, -1), (0, -1), (1, -1)} for 2D images and scales analogously
  *    for ND images.)
  * -# The pixel intensity range over which the features will be calculated.
  *    (Optional, defaults to the full dynamic range of the pixel type.)
- * -# The size of the neighborhood radius. (Optional, defaults to 2.)
+ * -# The size of the neighborhood radius, or the radii of nested
+ *    neighborhoods. (Optional, defaults to 2.)
+ * -# Whether the co-occurrence matrix is updated incrementally while the
+ *    neighborhood slides along a scan line. (Optional, defaults to true.)
+ * -# Whether the neighborhoods holding a single digitized value are detected
+ *    beforehand, to compute their features once per value. (Optional,
+ *    defaults to true.)
+ * -# Whether the neighborhoods entirely inside of the mask and in range are
+ *    detected beforehand, to count their pairs without testing their values.
+ *    (Optional, defaults to true.)
+ * -# The storage of the co-occurrence matrix, dense or sparse. (Optional,
+ *    defaults to an automatic selection.)
+ * -# The subset of the features to compute. (Optional, defaults to all.)
+ * -# Whether only the features of the voxels inside of the mask are
+ *    computed, into the compact output instead of the image output.
+ *    (Optional, defaults to false.)
+ * -# Whether the features are also computed for each offset separately.
+ *    (Optional, defaults to false.)
  *
  * Recommendations:
  * -# Input image: To improve the computation time, the useful data should take as much
@@ -73,6 +98,8 @@ namespace Statistics
  *    intensity range. For example they could be the minimum and maximum intensity of the image, or 0 and
  *    the maximum intensity (if the negative values are considered as noise).
  *
+ * \sa TextureFeaturesImageFilterBase
+ * \sa DigitizerImageFilter
  * \sa HistogramToTextureFeaturesFilter
  * \sa ScalarImageToCooccurrenceMatrixFilte
  * \sa ScalarImageToTextureFeaturesFilter
@@ -85,56 +112,59 @@ template< typename TInputImage,
           typename TOutputImage,
           typename TMaskImage = Image< unsigned char, TInputImage::ImageDimension> >
 class ITK_TEMPLATE_EXPORT CoocurrenceTextureFeaturesImageFilter
-  : public ImageToImageFilter< TInputImage, TOutputImage >
+  : public TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >
 {
 public:
   /** Standard type alias */
   using Self = CoocurrenceTextureFeaturesImageFilter;
-  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Superclass = TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >;
   using Pointer = SmartPointer< Self >;
   using ConstPointer = SmartPointer< const Self >;
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(CoocurrenceTextureFeaturesImageFilter, ImageToImageFilter);
+  itkTypeMacro(CoocurrenceTextureFeaturesImageFilter, TextureFeaturesImageFilterBase);
 
   /** standard New() method support */
   itkNewMacro(Self);
 
-  using InputImageType = TInputImage;
-  using OutputImageType = TOutputImage;
-  using MaskImageType = TMaskImage;
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using MaskImageType = typename Superclass::MaskImageType;
 
-  using PixelType = typename InputImageType::PixelType;
-  using MaskPixelType = typename MaskImageType::PixelType;
-  using IndexType = typename InputImageType::IndexType;
-  using PointType = typename InputImageType::PointType;
+  using PixelType = typename Superclass::PixelType;
+  using MaskPixelType = typename Superclass::MaskPixelType;
+  using IndexType = typename Superclass::IndexType;
+  using PointType = typename Superclass::PointType;
 
-  using OffsetType = typename InputImageType::OffsetType;
-  using OffsetVector = VectorContainer< unsigned char, OffsetType >;
-  using OffsetVectorPointer = typename OffsetVector::Pointer;
-  using OffsetVectorConstPointer = typename OffsetVector::ConstPointer;
+  using OffsetType = typename Superclass::OffsetType;
+  using OffsetVector = typename Superclass::OffsetVector;
+  using OffsetVectorPointer = typename Superclass::OffsetVectorPointer;
+  using OffsetVectorConstPointer = typename Superclass::OffsetVectorConstPointer;
 
-  using InputRegionType = typename InputImageType::RegionType;
-  using OutputRegionType = typename OutputImageType::RegionType;
+  using InputRegionType = typename Superclass::InputRegionType;
+  using OutputRegionType = typename Superclass::OutputRegionType;
 
-  using NeighborhoodRadiusType = typename itk::ConstNeighborhoodIterator< InputImageType >::RadiusType;
+  using NeighborhoodRadiusType = typename Superclass::NeighborhoodRadiusType;
 
-  using MeasurementType = typename NumericTraits<PixelType>::RealType;
-  using RealType = typename NumericTraits<PixelType>::RealType;
+  using MeasurementType = typename Superclass::MeasurementType;
+  using RealType = typename Superclass::RealType;
 
   /** Method to set/get the Neighborhood radius */
   itkSetMacro(NeighborhoodRadius, NeighborhoodRadiusType);
   itkGetConstMacro(NeighborhoodRadius, NeighborhoodRadiusType);
 
-  /** Method to set the mask image */
-  itkSetInputMacro(MaskImage, MaskImageType);
-
-  /** Method to get the mask image */
-  itkGetInputMacro(MaskImage, MaskImageType);
-
-
-  /** Specify the default number of bins per axis */
-  static constexpr unsigned int DefaultBinsPerAxis = 256;
+  /** Set/Get the radii of nested neighborhoods, whose features are all
+   * computed in the same pass over the image. When not empty,
+   * NeighborhoodRadius is ignored and the output pixels hold the selected
+   * features of each radius in turn. Each radius must be at least the
+   * previous one along every dimension: the pairs of a neighborhood are then
+   * the ones of the previous neighborhood plus the ones of the shell
+   * between them, and the co-occurrence matrices of all the radii are built
+   * from the shells, read once. The output must be a VectorImage when
+   * several radii are set. Empty by default. */
+  using NeighborhoodRadiusVectorType = std::vector< NeighborhoodRadiusType >;
+  void SetNeighborhoodRadii( const NeighborhoodRadiusVectorType & radii );
+  itkGetConstReferenceMacro(NeighborhoodRadii, NeighborhoodRadiusVectorType);
 
   /**
    * Set the offsets over which the intensities pairs will be computed.
@@ -163,11 +193,18 @@ public:
    */
   itkGetModifiableObjectMacro(Offsets, OffsetVector );
 
-  /** Set number of histogram bins along each axis */
-  itkSetMacro( NumberOfBinsPerAxis, unsigned int );
-
-  /** Get number of histogram bins along each axis */
-  itkGetConstMacro( NumberOfBinsPerAxis, unsigned int );
+  /** Set/Get the numbers of bins of coarser quantizations whose features are
+   * computed in the same pass over the image. Each of them must divide
+   * NumberOfBinsPerAxis: the input is only digitized with NumberOfBinsPerAxis
+   * bins, and the co-occurrence matrix of a coarser level is folded from the
+   * one of NumberOfBinsPerAxis bins, merging groups of consecutive bins,
+   * instead of reading the pairs of the neighborhood again. The output
+   * pixels hold the selected features of NumberOfBinsPerAxis bins followed
+   * by the ones of each coarser level, so the output must be a VectorImage
+   * when coarser levels are set. Empty by default. */
+  using NumberOfBinsVectorType = std::vector< unsigned int >;
+  void SetCoarserNumbersOfBinsPerAxis( const NumberOfBinsVectorType & numbersOfBins );
+  itkGetConstReferenceMacro(CoarserNumbersOfBinsPerAxis, NumberOfBinsVectorType);
 
   /** Get the max pixel value defining one dimension of the joint histogram. */
   itkGetConstMacro( HistogramMaximum, PixelType );
@@ -177,67 +214,342 @@ public:
   itkGetConstMacro( HistogramMinimum, PixelType );
   itkSetMacro( HistogramMinimum, PixelType);
 
-  /**
-   * Set the pixel value of the mask that should be considered "inside" the
-   * object. Defaults to 1.
-   */
-  itkSetMacro( InsidePixelValue, MaskPixelType );
-  itkGetConstMacro( InsidePixelValue, MaskPixelType );
-
   /** Set the calculator to normalize the histogram (divide all bins by the
     total frequency). Normalization is off by default. */
   itkSetMacro(Normalize, bool);
   itkGetConstMacro(Normalize, bool);
   itkBooleanMacro(Normalize);
 
-  using OutputPixelType = typename OutputImageType::PixelType;
-  using OutputRealType = typename NumericTraits< OutputPixelType >::ScalarRealType;
-
-#ifdef ITK_USE_CONCEPT_CHECKING
-  // Begin concept checking
-  itkConceptMacro( OutputPixelTypeCheck,
-                   ( Concept::IsFloatingPoint< OutputRealType > ) );
-  // End concept checking
-#endif
+  /** Set/Get whether the co-occurrence matrix is updated with a sliding
+   * window. When enabled, the matrix is only built from scratch at the
+   * beginning of each scan line; moving to the next voxel then removes the
+   * pairs leaving the neighborhood and adds the pairs entering it. The
+   * results are identical to a full rebuild. On by default. */
+  itkSetMacro(UseSlidingWindow, bool);
+  itkGetConstMacro(UseSlidingWindow, bool);
+  itkBooleanMacro(UseSlidingWindow);
+
+  /** Set/Get whether the voxels whose neighborhood holds a single digitized
+   * value are detected beforehand, with a moving minimum and maximum of the
+   * digitized image. All the pairs of such a neighborhood fall in the same
+   * bin of the diagonal, so its features only depend on this value and are
+   * computed once per value instead of from a co-occurrence matrix. The
+   * results are identical. Only used when NeighborhoodRadii,
+   * PerOffsetFeatures and CoarserNumbersOfBinsPerAxis are not set. On by
+   * default. */
+  itkSetMacro(DetectUniformNeighborhoods, bool);
+  itkGetConstMacro(DetectUniformNeighborhoods, bool);
+  itkBooleanMacro(DetectUniformNeighborhoods);
+
+  /** Set/Get whether the voxels whose neighborhood is entirely inside of the
+   * mask and in range are detected beforehand, with the same moving maximum
+   * of the digitized image. The pairs of their neighborhood are then counted
+   * without testing the values of their voxels, which is only done near the
+   * border of the mask or of the intensity range. The results are identical.
+   * On by default. */
+  itkSetMacro(DetectInRangeNeighborhoods, bool);
+  itkGetConstMacro(DetectInRangeNeighborhoods, bool);
+  itkBooleanMacro(DetectInRangeNeighborhoods);
+
+  /** Storage of the co-occurrence matrix. A dense matrix needs
+   * NumberOfBinsPerAxis^2 memory per work unit, while a sparse one only
+   * stores its non-zero bins and scales with the number of pairs in the
+   * neighborhood. AutomaticHistogram selects the sparse storage when the
+   * dense matrix has more than four bins per pair. */
+  enum HistogramRepresentationType
+    {
+    DenseHistogram,
+    SparseHistogram,
+    AutomaticHistogram
+    };
+
+  /** Set/Get the storage of the co-occurrence matrix. Defaults to
+   * AutomaticHistogram. */
+  itkSetMacro(HistogramRepresentation, HistogramRepresentationType);
+  itkGetConstMacro(HistogramRepresentation, HistogramRepresentationType);
+
+  /** Set/Get whether the features are evaluated in two fused passes over the
+   * non-zero bins of the co-occurrence matrix, without memory allocation.
+   * When disabled, the means and variances, then the features, are computed
+   * in separate passes. The results only differ by floating point rounding.
+   * On by default. */
+  itkSetMacro(UseFusedFeatureEvaluation, bool);
+  itkGetConstMacro(UseFusedFeatureEvaluation, bool);
+  itkBooleanMacro(UseFusedFeatureEvaluation);
+
+  /** Bits of the co-occurrence features in FeatureMask, in the order of the
+   * components of the output pixels. */
+  enum FeatureBitType
+    {
+    EnergyFeature = 1 << 0,
+    EntropyFeature = 1 << 1,
+    CorrelationFeature = 1 << 2,
+    InverseDifferenceMomentFeature = 1 << 3,
+    InertiaFeature = 1 << 4,
+    ClusterShadeFeature = 1 << 5,
+    ClusterProminenceFeature = 1 << 6,
+    HaralickCorrelationFeature = 1 << 7,
+    AllFeatures = ( 1 << 8 ) - 1
+    };
+
+  /** Set/Get the features to compute, as a combination of FeatureBitType.
+   * The output pixels only hold the selected features, in the order of their
+   * bits, and the accumulations of the other ones are skipped. Defaults to
+   * AllFeatures. */
+  itkSetMacro(FeatureMask, unsigned int);
+  itkGetConstMacro(FeatureMask, unsigned int);
+
+  /** Number of selected features. */
+  unsigned int GetNumberOfFeatures() const;
+
+  /** Set/Get whether a co-occurrence matrix is also accumulated for each
+   * offset, from the same pairs and in the same pass over the neighborhoods
+   * as the pooled one. The output pixels then hold the selected features of
+   * the pooled matrix, when PooledFeatures is on, followed by the ones of the
+   * matrix of each offset, in the order of Offsets. The output must be a
+   * VectorImage, an exception is thrown when its pixels have a fixed length,
+   * and SeparateFeatureOutputs must be off. Off by default. */
+  itkSetMacro(PerOffsetFeatures, bool);
+  itkGetConstMacro(PerOffsetFeatures, bool);
+  itkBooleanMacro(PerOffsetFeatures);
+
+  /** Set/Get whether the features of the pooled co-occurrence matrix of all
+   * the offsets are computed when PerOffsetFeatures is on. They always are
+   * otherwise. On by default. */
+  itkSetMacro(PooledFeatures, bool);
+  itkGetConstMacro(PooledFeatures, bool);
+  itkBooleanMacro(PooledFeatures);
+
+  /** Number of components of the output pixels: the number of selected
+   * features, times the number of offsets plus one for the pooled features
+   * when PerOffsetFeatures is on, times the number of NeighborhoodRadii
+   * when they are set, or times one plus the number of
+   * CoarserNumbersOfBinsPerAxis. */
+  unsigned int GetNumberOfOutputComponents() const override;
+
+  using OutputPixelType = typename Superclass::OutputPixelType;
+  using OutputRealType = typename Superclass::OutputRealType;
+  using CompactFeaturesType = typename Superclass::CompactFeaturesType;
+  using ScalarFeatureImageType = typename Superclass::ScalarFeatureImageType;
 
 protected:
 
-  using HistogramIndexType = int;
-  using DigitizedImageType = itk::Image< HistogramIndexType, TInputImage::ImageDimension >;
-  using NeighborhoodIteratorType = typename itk::ConstNeighborhoodIterator< DigitizedImageType >;
-  using NeighborIndexType = typename NeighborhoodIteratorType::NeighborIndexType;
+  using NarrowDigitizedImageType = typename Superclass::NarrowDigitizedImageType;
+  using WideDigitizedImageType = typename Superclass::WideDigitizedImageType;
+  using NeighborIndexType = typename Superclass::NeighborIndexType;
+  using RegionVectorType = typename Superclass::RegionVectorType;
+  using FeatureImagesType = typename Superclass::FeatureImagesType;
+
+  /** Number of features when all of them are selected, i.e. of per feature
+   * outputs. */
+  static constexpr unsigned int MaximumNumberOfFeatures = 8;
+  using NeighborIndexPairType = std::pair< NeighborIndexType, NeighborIndexType >;
+  using NeighborIndexPairVector = std::vector< NeighborIndexPairType >;
 
   CoocurrenceTextureFeaturesImageFilter();
   ~CoocurrenceTextureFeaturesImageFilter() override {}
 
   bool IsInsideNeighborhood(const OffsetType &iteratedOffset);
-  void ComputeFeatures(const vnl_matrix<unsigned int> &hist, const unsigned int totalNumberOfFreq,
+  static bool IsInsideNeighborhood(const OffsetType &iteratedOffset, const NeighborhoodRadiusType &radius);
+
+  /** Radius of the neighborhood read around each voxel: the last of
+   * NeighborhoodRadii when they are set, NeighborhoodRadius otherwise. */
+  const NeighborhoodRadiusType & GetLargestNeighborhoodRadius() const override;
+
+  /** The intensity range is the one of the joint histogram. */
+  PixelType GetDigitizerMinimum() const override { return m_HistogramMinimum; }
+  PixelType GetDigitizerMaximum() const override { return m_HistogramMaximum; }
+
+  /** Compute the neighborhood index pairs of co-occurring voxels for all the
+   * offsets, and the pairs leaving and entering the neighborhood when it
+   * moves by one voxel along the first dimension. */
+  void ComputeNeighborhoodPairs();
+
+  /** Compute the neighborhood pairs and select the co-occurrence matrix
+   * storage, once the input is digitized. */
+  void ComputeNeighborhoodTables();
+
+  /** The voxels whose neighborhood is uniform or in range are located when
+   * they are used: DetectInRangeNeighborhoods is on, or
+   * DetectUniformNeighborhoods is on and the features are only computed
+   * from one co-occurrence matrix. */
+  bool UsesUniformNeighborhoodsTable() const override;
+
+  /** Whether the features of the uniform neighborhoods are computed once per
+   * value: DetectUniformNeighborhoods is on, and NeighborhoodRadii,
+   * PerOffsetFeatures and CoarserNumbersOfBinsPerAxis are not set. */
+  bool UsesUniformNeighborhoods() const;
+
+  /** Compute the features of the regions with DispatchRegionsFeatures. */
+  void ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output ) override;
+
+  /** Compute the features of the regions into the output, an image, the
+   * compact output or the scalar images of the features, from the narrow or
+   * wide digitized image. */
+  template< typename TOutput >
+  void DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output );
+
+  /** Compute the features of the regions from the digitized image, selecting
+   * the co-occurrence matrix storage. */
+  template< typename TOutput, typename TDigitizedImage >
+  void ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                                const TDigitizedImage * digitizedImage );
+
+  /** Compute the features of the regions from the digitized image with the
+   * given co-occurrence matrix storage. */
+  template< typename TOutput, typename TDigitizedImage, typename THistogram >
+  void ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                                const TDigitizedImage * digitizedImage,
+                                THistogram & hist );
+
+  /** Compute the features of the voxel at the center of the
+   * TextureNeighborhoodKernel over the digitized image. When
+   * slideFromPreviousVoxel is true, hist and totalNumberOfFreq must hold the
+   * state left by the call on the previous voxel of the same scan line and
+   * are updated incrementally. */
+  template< typename TNeighborhoodIterator, typename THistogram >
+  void ComputeVoxelFeatures( const TNeighborhoodIterator & inputNIt,
+                             bool slideFromPreviousVoxel,
+                             THistogram & hist,
+                             unsigned int & totalNumberOfFreq,
+                             double *marginalSums,
+                             typename TOutputImage::PixelType &outputPixel );
+
+  /** Compute the features of the voxel for each offset, from offsetHists,
+   * and the pooled ones from hist when PooledFeatures is on. The matrices
+   * are updated as in ComputeVoxelFeatures. featurePixel is a scratch pixel
+   * of the length of the output pixels. */
+  template< typename TNeighborhoodIterator, typename THistogram >
+  void ComputeVoxelOffsetFeatures( const TNeighborhoodIterator & inputNIt,
+                                   bool slideFromPreviousVoxel,
+                                   THistogram & hist,
+                                   unsigned int & totalNumberOfFreq,
+                                   std::vector< THistogram > & offsetHists,
+                                   std::vector< unsigned int > & offsetTotalNumberOfFreqs,
+                                   double *marginalSums,
+                                   typename TOutputImage::PixelType &featurePixel,
+                                   typename TOutputImage::PixelType &outputPixel );
+
+  /** Compute the features of the voxel for each of NeighborhoodRadii, from
+   * radiusHists updated as in ComputeVoxelFeatures. Without sliding window,
+   * the shells are accumulated in hist instead, the features of each radius
+   * being computed once its shell is added. featurePixel is a scratch pixel
+   * of the length of the output pixels. */
+  template< typename TNeighborhoodIterator, typename THistogram >
+  void ComputeVoxelRadiiFeatures( const TNeighborhoodIterator & inputNIt,
+                                  bool slideFromPreviousVoxel,
+                                  THistogram & hist,
+                                  unsigned int & totalNumberOfFreq,
+                                  std::vector< THistogram > & radiusHists,
+                                  std::vector< unsigned int > & radiusTotalNumberOfFreqs,
+                                  double *marginalSums,
+                                  typename TOutputImage::PixelType &featurePixel,
+                                  typename TOutputImage::PixelType &outputPixel );
+
+  /** Compute the features of the voxel from hist, updated as in
+   * ComputeVoxelFeatures, then the ones of each of
+   * CoarserNumbersOfBinsPerAxis from coarserHists, folded from hist.
+   * featurePixel is a scratch pixel of the length of the output pixels. */
+  template< typename TNeighborhoodIterator, typename THistogram >
+  void ComputeVoxelCoarserFeatures( const TNeighborhoodIterator & inputNIt,
+                                    bool slideFromPreviousVoxel,
+                                    THistogram & hist,
+                                    unsigned int & totalNumberOfFreq,
+                                    std::vector< THistogram > & coarserHists,
+                                    double *marginalSums,
+                                    typename TOutputImage::PixelType &featurePixel,
+                                    typename TOutputImage::PixelType &outputPixel );
+
+  /** Call visitor( a, b ) with the digitized values of the pairs of voxels
+   * of the neighborhood that are both inside of the mask and in range. The
+   * values are not tested when the neighborhood is known to be in range. */
+  template< typename TNeighborhoodIterator, typename TVisitor >
+  static void VisitPairs( const TNeighborhoodIterator & inputNIt,
+                          const NeighborIndexPairVector & pairs,
+                          const TVisitor & visitor );
+
+  /** Compute the selected features of a co-occurrence matrix of
+   * numberOfBins bins per axis, with the fused evaluation when
+   * UseFusedFeatureEvaluation is on. */
+  template< typename THistogram >
+  void ComputeHistogramFeatures(const THistogram &hist, const unsigned int totalNumberOfFreq,
+                                unsigned int numberOfBins,
+                                double *marginalSums,
+                                typename TOutputImage::PixelType &outputPixel);
+
+  template< typename THistogram >
+  void ComputeFeatures(const THistogram &hist, const unsigned int totalNumberOfFreq,
+                       unsigned int numberOfBins,
                        typename TOutputImage::PixelType &outputPixel);
-  void ComputeMeansAndVariances(const vnl_matrix<unsigned int> &hist,
+  /** Compute the features in two passes over the non-zero bins of the
+   * co-occurrence matrix. marginalSums is a scratch buffer of at least
+   * numberOfBins zeros, which is zeroed again on return. */
+  template< typename THistogram >
+  void ComputeFeaturesFused(const THistogram &hist, const unsigned int totalNumberOfFreq,
+                            unsigned int numberOfBins,
+                            double *marginalSums,
+                            typename TOutputImage::PixelType &outputPixel);
+  template< typename THistogram >
+  void ComputeMeansAndVariances(const THistogram &hist,
                                 const unsigned int totalNumberOfFreq,
+                                unsigned int numberOfBins,
                                 double & pixelMean,
                                 double & marginalMean,
                                 double & marginalDevSquared,
                                 double & pixelVariance);
+
+  /** Copy the selected features among the 8 co-occurrence features to the
+   * components of outputPixel. */
+  void SetSelectedFeatures(const double *features, typename TOutputImage::PixelType &outputPixel) const;
+
   void PrintSelf( std::ostream & os, Indent indent ) const override;
 
-  /** This method causes the filter to generate its output. */
+  /** Check that the feature mask and the options computing several sets of
+   * features are compatible. */
+  void VerifyPreconditions() ITKv5_CONST override;
+
+  /** Digitize the input, then compute the neighborhood tables. */
   void BeforeThreadedGenerateData() override;
   void AfterThreadedGenerateData() override;
-  void DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread ) override;
-  void GenerateOutputInformation() override;
+
+  double EstimateInsideVoxelCost() const override;
 
 private:
-  typename DigitizedImageType::Pointer  m_DigitizedInputImage;
+  template< typename, typename, typename > friend class TextureFeatureBankImageFilter;
 
   NeighborhoodRadiusType            m_NeighborhoodRadius;
+  NeighborhoodRadiusVectorType      m_NeighborhoodRadii;
   OffsetVectorPointer               m_Offsets;
-  unsigned int                      m_NumberOfBinsPerAxis;
+  NumberOfBinsVectorType            m_CoarserNumbersOfBinsPerAxis;
   PixelType                         m_HistogramMinimum;
   PixelType                         m_HistogramMaximum;
-  MaskPixelType                     m_InsidePixelValue;
   bool                              m_Normalize;
-
+  bool                              m_UseSlidingWindow;
+  bool                              m_DetectUniformNeighborhoods;
+  bool                              m_DetectInRangeNeighborhoods;
+  HistogramRepresentationType       m_HistogramRepresentation;
+  bool                              m_UseFusedFeatureEvaluation;
+  unsigned int                      m_FeatureMask;
+  bool                              m_PerOffsetFeatures;
+  bool                              m_PooledFeatures;
+  bool                              m_UseSparseHistogram;
+
+  NeighborIndexPairVector           m_NeighborhoodPairs;
+  NeighborIndexPairVector           m_LeavingPairs;
+  NeighborIndexPairVector           m_EnteringPairs;
+
+  /** Neighborhood pairs of each offset taken separately. */
+  std::vector< NeighborIndexPairVector > m_OffsetNeighborhoodPairs;
+  std::vector< NeighborIndexPairVector > m_OffsetLeavingPairs;
+  std::vector< NeighborIndexPairVector > m_OffsetEnteringPairs;
+
+  /** Pairs of each of NeighborhoodRadii that are not in the smaller ones,
+   * and pairs leaving and entering each of these neighborhoods. */
+  std::vector< NeighborIndexPairVector > m_RadiusShellPairs;
+  std::vector< NeighborIndexPairVector > m_RadiusLeavingPairs;
+  std::vector< NeighborIndexPairVector > m_RadiusEnteringPairs;
 
 };
 } // end of namespace Statistics
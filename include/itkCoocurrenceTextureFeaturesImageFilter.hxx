@@ -19,10 +19,9 @@
 #define itkCoocurrenceTextureFeaturesImageFilter_hxx
 
 #include "itkCoocurrenceTextureFeaturesImageFilter.h"
-#include "itkRegionOfInterestImageFilter.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkBinaryFunctorImageFilter.h"
-#include "itkDigitizerFunctor.h"
+#include "itkTextureNeighborhoodKernel.h"
+
+#include <bitset>
 
 namespace itk
 {
@@ -31,20 +30,10 @@ namespace Statistics
 template< typename TInputImage, typename TOutputImage, typename TMaskImage>
 CoocurrenceTextureFeaturesImageFilter< TInputImage, TOutputImage, TMaskImage>
 ::CoocurrenceTextureFeaturesImageFilter() :
-    m_NumberOfBinsPerAxis( itkGetStaticConstMacro( DefaultBinsPerAxis ) ),
+    Superclass( MaximumNumberOfFeatures ),
     m_HistogramMinimum( NumericTraits<PixelType>::NonpositiveMin() ),
-    m_HistogramMaximum( NumericTraits<PixelType>::max() ),
-    m_InsidePixelValue( NumericTraits<MaskPixelType>::OneValue() )
+    m_HistogramMaximum( NumericTraits<PixelType>::max() )
 {
-  this->SetNumberOfRequiredInputs( 1 );
-  this->SetNumberOfRequiredOutputs( 1 );
-
-  // Mark the "MaskImage" as an optional named input. First it has to
-  // be added to the list of named inputs then removed from the
-  // required list.
-  Self::AddRequiredInputName("MaskImage");
-  Self::RemoveRequiredInputName("MaskImage");
-
   // Set the offset directions to their defaults: half of all the possible
   // directions 1 pixel away. (The other half is included by symmetry.)
   // We use a neighborhood iterator to calculate the appropriate offsets.
@@ -68,7 +57,15 @@ CoocurrenceTextureFeaturesImageFilter< TInputImage, TOutputImage, TMaskImage>
   this->m_NeighborhoodRadius = nhood.GetRadius( );
 
   this->m_Normalize = false;
-  this->DynamicMultiThreadingOn();
+  this->m_UseSlidingWindow = true;
+  this->m_DetectUniformNeighborhoods = true;
+  this->m_DetectInRangeNeighborhoods = true;
+  this->m_HistogramRepresentation = AutomaticHistogram;
+  this->m_UseFusedFeatureEvaluation = true;
+  this->m_FeatureMask = AllFeatures;
+  this->m_PerOffsetFeatures = false;
+  this->m_PooledFeatures = true;
+  this->m_UseSparseHistogram = false;
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
@@ -84,36 +81,165 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::BeforeThreadedGenerateData()
+::SetNeighborhoodRadii( const NeighborhoodRadiusVectorType & radii )
 {
+  if( m_NeighborhoodRadii != radii )
+    {
+    m_NeighborhoodRadii = radii;
+    this->Modified();
+    }
+}
 
-  typename TInputImage::Pointer input = InputImageType::New();
-  input->Graft(const_cast<TInputImage *>(this->GetInput()));
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::SetCoarserNumbersOfBinsPerAxis( const NumberOfBinsVectorType & numbersOfBins )
+{
+  if( m_CoarserNumbersOfBinsPerAxis != numbersOfBins )
+    {
+    m_CoarserNumbersOfBinsPerAxis = numbersOfBins;
+    this->Modified();
+    }
+}
 
-  using DigitizerFunctorType = Digitizer<PixelType,
-                      PixelType,
-                      typename DigitizedImageType::PixelType>;
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+const typename CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>::NeighborhoodRadiusType &
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetLargestNeighborhoodRadius() const
+{
+  return m_NeighborhoodRadii.empty() ? m_NeighborhoodRadius : m_NeighborhoodRadii.back();
+}
 
-  DigitizerFunctorType digitalizer(m_NumberOfBinsPerAxis, m_InsidePixelValue, m_HistogramMinimum, m_HistogramMaximum);
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetNumberOfFeatures() const
+{
+  return static_cast< unsigned int >( std::bitset< 8 >( m_FeatureMask ).count() );
+}
 
-  using FilterType = BinaryFunctorImageFilter< MaskImageType, InputImageType, DigitizedImageType, DigitizerFunctorType>;
-  typename FilterType::Pointer filter = FilterType::New();
-  if (this->GetMaskImage() != nullptr)
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetNumberOfOutputComponents() const
+{
+  if( !m_NeighborhoodRadii.empty() )
     {
-    typename TMaskImage::Pointer mask = MaskImageType::New();
-    mask->Graft(const_cast<TMaskImage *>(this->GetMaskImage()));
-    filter->SetInput1(mask);
+    return this->GetNumberOfFeatures() * static_cast< unsigned int >( m_NeighborhoodRadii.size() );
     }
-  else
+  if( !m_CoarserNumbersOfBinsPerAxis.empty() )
     {
-    filter->SetConstant1(m_InsidePixelValue);
+    return this->GetNumberOfFeatures() * static_cast< unsigned int >( 1 + m_CoarserNumbersOfBinsPerAxis.size() );
     }
-  filter->SetInput2(input);
-  filter->SetFunctor(digitalizer);
-  filter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  if( !m_PerOffsetFeatures )
+    {
+    return this->GetNumberOfFeatures();
+    }
+  const auto numberOfHistograms = static_cast< unsigned int >( m_Offsets->Size() ) + ( m_PooledFeatures ? 1 : 0 );
+  return this->GetNumberOfFeatures() * numberOfHistograms;
+}
 
-  filter->Update();
-  m_DigitizedInputImage = filter->GetOutput();
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VerifyPreconditions() ITKv5_CONST
+{
+  Superclass::VerifyPreconditions();
+
+  if( m_FeatureMask == 0 || ( m_FeatureMask & ~static_cast< unsigned int >( AllFeatures ) ) != 0 )
+    {
+    itkExceptionMacro( "FeatureMask is " << m_FeatureMask << " but must select at least one of the "
+                       "features of FeatureBitType" );
+    }
+  if( m_PerOffsetFeatures && this->GetSeparateFeatureOutputs() )
+    {
+    itkExceptionMacro( "PerOffsetFeatures and SeparateFeatureOutputs cannot be both on" );
+    }
+  if( m_PerOffsetFeatures && !m_PooledFeatures && m_Offsets->Size() == 0 )
+    {
+    itkExceptionMacro( "PerOffsetFeatures needs at least one offset when PooledFeatures is off" );
+    }
+  if( !m_NeighborhoodRadii.empty() && ( m_PerOffsetFeatures || this->GetSeparateFeatureOutputs() ) )
+    {
+    itkExceptionMacro( "NeighborhoodRadii cannot be set when PerOffsetFeatures or SeparateFeatureOutputs is on" );
+    }
+  for( unsigned int k = 1; k < m_NeighborhoodRadii.size(); ++k )
+    {
+    for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+      {
+      if( m_NeighborhoodRadii[k][d] < m_NeighborhoodRadii[k - 1][d] )
+        {
+        itkExceptionMacro( "NeighborhoodRadii must be nested, but radius " << m_NeighborhoodRadii[k]
+                           << " is smaller than " << m_NeighborhoodRadii[k - 1] );
+        }
+      }
+    }
+  if( !m_CoarserNumbersOfBinsPerAxis.empty()
+      && ( !m_NeighborhoodRadii.empty() || m_PerOffsetFeatures || this->GetSeparateFeatureOutputs() ) )
+    {
+    itkExceptionMacro( "CoarserNumbersOfBinsPerAxis cannot be set when NeighborhoodRadii are set or "
+                       "PerOffsetFeatures or SeparateFeatureOutputs is on" );
+    }
+  for( const unsigned int numberOfBins : m_CoarserNumbersOfBinsPerAxis )
+    {
+    if( numberOfBins == 0 || this->GetNumberOfBinsPerAxis() % numberOfBins != 0 )
+      {
+      itkExceptionMacro( "CoarserNumbersOfBinsPerAxis must divide NumberOfBinsPerAxis "
+                         << this->GetNumberOfBinsPerAxis() << ", but holds " << numberOfBins );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  this->ComputeNeighborhoodTables();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeNeighborhoodTables()
+{
+  this->ComputeNeighborhoodPairs();
+
+  // The sparse matrix pays off when the dense one has many more bins than
+  // the number of pairs that can be counted in a neighborhood
+  const SizeValueType numberOfHistogramBins =
+    static_cast< SizeValueType >( this->GetNumberOfBinsPerAxis() ) * this->GetNumberOfBinsPerAxis();
+  const SizeValueType numberOfNeighborhoodPairs = m_NeighborhoodPairs.size();
+  switch( m_HistogramRepresentation )
+    {
+    case DenseHistogram:
+      m_UseSparseHistogram = false;
+      break;
+    case SparseHistogram:
+      m_UseSparseHistogram = true;
+      break;
+    default:
+      m_UseSparseHistogram = numberOfHistogramBins > 4 * numberOfNeighborhoodPairs;
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::UsesUniformNeighborhoodsTable() const
+{
+  return m_DetectInRangeNeighborhoods || this->UsesUniformNeighborhoods();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::UsesUniformNeighborhoods() const
+{
+  return m_DetectUniformNeighborhoods && m_NeighborhoodRadii.empty() && !m_PerOffsetFeatures
+    && m_CoarserNumbersOfBinsPerAxis.empty();
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
@@ -121,116 +247,268 @@ void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 ::AfterThreadedGenerateData()
 {
-  // Free internal image
-  this->m_DigitizedInputImage = nullptr;
+  Superclass::AfterThreadedGenerateData();
+
+  this->m_NeighborhoodPairs.clear();
+  this->m_LeavingPairs.clear();
+  this->m_EnteringPairs.clear();
+  this->m_OffsetNeighborhoodPairs.clear();
+  this->m_OffsetLeavingPairs.clear();
+  this->m_OffsetEnteringPairs.clear();
+  this->m_RadiusShellPairs.clear();
+  this->m_RadiusLeavingPairs.clear();
+  this->m_RadiusEnteringPairs.clear();
 }
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+double
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::EstimateInsideVoxelCost() const
+{
+  // Pairs of the neighborhood accumulated for each voxel, in the pooled
+  // matrix and in the ones of the offsets
+  const SizeValueType numberOfPairs = m_UseSlidingWindow ? m_EnteringPairs.size() + m_LeavingPairs.size()
+                                                         : m_NeighborhoodPairs.size();
+  const unsigned int numberOfAccumulations = m_PerOffsetFeatures && m_PooledFeatures ? 2 : 1;
+  if( !m_NeighborhoodRadii.empty() && m_UseSlidingWindow )
+    {
+    SizeValueType numberOfRadiusPairs = 0;
+    for( unsigned int k = 0; k < m_NeighborhoodRadii.size(); ++k )
+      {
+      numberOfRadiusPairs += m_RadiusEnteringPairs[k].size() + m_RadiusLeavingPairs[k].size();
+      }
+    return 1.0 + static_cast< double >( numberOfRadiusPairs );
+    }
+  // The matrix of each coarser level is folded from the non-zero bins of the
+  // finest one, at most one per pair of the neighborhood
+  const SizeValueType numberOfFoldedBins = m_CoarserNumbersOfBinsPerAxis.size() *
+    std::min( static_cast< SizeValueType >( m_NeighborhoodPairs.size() ),
+              static_cast< SizeValueType >( this->GetNumberOfBinsPerAxis() ) * this->GetNumberOfBinsPerAxis() );
+  return 1.0 + static_cast< double >( numberOfPairs ) * numberOfAccumulations
+    + static_cast< double >( numberOfFoldedBins );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread )
+::ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output )
 {
-  // Recuperation of the different inputs/outputs
-  OutputImageType* outputPtr = this->GetOutput();
+  this->DispatchRegionsFeatures( regions, output );
+}
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output )
+{
+  const auto * narrowDigitizedImage =
+    dynamic_cast< const NarrowDigitizedImageType * >( this->GetDigitizedInputImage() );
+  if( narrowDigitizedImage != nullptr )
+    {
+    this->ThreadedComputeFeatures( regions, output, narrowDigitizedImage );
+    }
+  else
+    {
+    this->ThreadedComputeFeatures( regions, output,
+      static_cast< const WideDigitizedImageType * >( this->GetDigitizedInputImage() ) );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput, typename TDigitizedImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                           const TDigitizedImage * digitizedImage )
+{
+  if( this->m_UseSparseHistogram )
+    {
+    SparseCoocurrenceHistogram hist;
+    hist.Initialize( this->GetNumberOfBinsPerAxis(), m_NeighborhoodPairs.size() );
+    this->ThreadedComputeFeatures( regions, output, digitizedImage, hist );
+    }
+  else
+    {
+    DenseCoocurrenceHistogram hist;
+    hist.Initialize( this->GetNumberOfBinsPerAxis(), m_NeighborhoodPairs.size() );
+    this->ThreadedComputeFeatures( regions, output, digitizedImage, hist );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput, typename TDigitizedImage, typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                           const TDigitizedImage * digitizedImage,
+                           THistogram & hist )
+{
   // Creation of the output pixel type
   typename TOutputImage::PixelType outputPixel;
-  NumericTraits<typename TOutputImage::PixelType>::SetLength(outputPixel, outputPtr->GetNumberOfComponentsPerPixel());
+  NumericTraits<typename TOutputImage::PixelType>::SetLength(outputPixel, output->GetNumberOfComponentsPerPixel());
 
-  // Separation of the non-boundary region that will be processed in a different way
-  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< DigitizedImageType > boundaryFacesCalculator;
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< DigitizedImageType >::FaceListType
-  faceList = boundaryFacesCalculator( this->m_DigitizedInputImage, outputRegionForThread, m_NeighborhoodRadius );
-  auto fit = faceList.begin();
+  using DigitizedPixelType = typename TDigitizedImage::PixelType;
+  using NeighborhoodIteratorType = TextureNeighborhoodKernel< TDigitizedImage >;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
 
-  // Declaration of the variables useful to iterate over the all image region
-  bool isInImage;
-  typename OffsetVector::ConstIterator offsets;
+  // Digitized value of the voxels outside of the mask
+  const DigitizedPixelType outsideMaskValue = DigitizerFunctorType::GetOutsideMaskValue();
 
-  // Declaration of the variables useful to iterate over the all the offsets
-  OffsetType offset;
-  unsigned int totalNumberOfFreq;
+  // Declaration of the variables useful to iterate over the all the pairs
+  unsigned int totalNumberOfFreq = 0;
 
+  // Scratch buffer of the fused feature evaluation
+  std::vector< double > marginalSums( this->GetNumberOfBinsPerAxis(), 0.0 );
 
-  vnl_matrix<unsigned int> hist(m_NumberOfBinsPerAxis, m_NumberOfBinsPerAxis);
+  // Features of a single matrix, written to their components of the output
+  // pixel. The output pixels hold GetNumberOfOutputComponents() components,
+  // checked by GenerateOutputInformation(), so a copy of outputPixel is
+  // large enough and is never resized here
+  typename TOutputImage::PixelType featurePixel( outputPixel );
 
-  // Declaration of the variables useful to iterate over the all neighborhood region
-  HistogramIndexType currentInNeighborhoodPixelIntensity;
+  // Co-occurrence matrices of the offsets taken separately
+  std::vector< THistogram > offsetHists;
+  std::vector< unsigned int > offsetTotalNumberOfFreqs;
+  if( m_PerOffsetFeatures )
+    {
+    offsetHists.resize( m_OffsetNeighborhoodPairs.size() );
+    for( unsigned int o = 0; o < offsetHists.size(); ++o )
+      {
+      offsetHists[o].Initialize( this->GetNumberOfBinsPerAxis(), m_OffsetNeighborhoodPairs[o].size() );
+      }
+    offsetTotalNumberOfFreqs.assign( offsetHists.size(), 0 );
+    }
 
-  // Declaration of the variables useful to iterate over the run
-  HistogramIndexType pixelIntensity( NumericTraits<HistogramIndexType>::ZeroValue() );
-  OffsetType tempOffset;
+  // Co-occurrence matrices of the nested neighborhoods, each one updated
+  // with its own sliding window
+  std::vector< THistogram > radiusHists;
+  std::vector< unsigned int > radiusTotalNumberOfFreqs;
+  if( !m_NeighborhoodRadii.empty() )
+    {
+    if( m_UseSlidingWindow )
+      {
+      radiusHists.resize( m_RadiusShellPairs.size() );
+      SizeValueType numberOfRadiusPairs = 0;
+      for( unsigned int k = 0; k < radiusHists.size(); ++k )
+        {
+        numberOfRadiusPairs += m_RadiusShellPairs[k].size();
+        radiusHists[k].Initialize( this->GetNumberOfBinsPerAxis(), numberOfRadiusPairs );
+        }
+      radiusTotalNumberOfFreqs.assign( radiusHists.size(), 0 );
+      }
+    }
+
+  // Co-occurrence matrices of the coarser quantizations, folded from hist
+  std::vector< THistogram > coarserHists( m_CoarserNumbersOfBinsPerAxis.size() );
+  for( unsigned int l = 0; l < coarserHists.size(); ++l )
+    {
+    coarserHists[l].Initialize( m_CoarserNumbersOfBinsPerAxis[l], m_NeighborhoodPairs.size() );
+    }
+
+  // Features of the last value met in a uniform neighborhood, whose
+  // co-occurrence matrix is the single bin of this value on the diagonal
+  const bool detectUniformNeighborhoods = !this->GetUniformNeighborhoods().IsEmpty() && this->UsesUniformNeighborhoods()
+    && !m_NeighborhoodPairs.empty();
+  const bool detectInRangeNeighborhoods = !this->GetUniformNeighborhoods().IsEmpty() && m_DetectInRangeNeighborhoods;
+  const auto numberOfNeighborhoodPairs = static_cast< unsigned int >( m_NeighborhoodPairs.size() );
+  SparseCoocurrenceHistogram uniformHist;
+  uniformHist.Initialize( this->GetNumberOfBinsPerAxis(), 1 );
+  DigitizedPixelType uniformValue = outsideMaskValue;
+  typename TOutputImage::PixelType uniformPixel;
+  NumericTraits<typename TOutputImage::PixelType>::SetLength(uniformPixel, output->GetNumberOfComponentsPerPixel());
 
-  /// ***** Non-boundary Region *****
-  for (; fit != faceList.end(); ++fit )
+  for( const OutputRegionType & region : regions )
     {
-    NeighborhoodIteratorType inputNIt(m_NeighborhoodRadius, this->m_DigitizedInputImage, *fit );
-    using IteratorType = itk::ImageRegionIterator< OutputImageType>;
-    IteratorType outputIt( outputPtr, *fit );
+    // The halo of the digitized image holds all the neighborhoods of the region,
+    // they are read directly from its buffer
+    NeighborhoodIteratorType inputNIt(this->GetLargestNeighborhoodRadius(), digitizedImage, region );
+    using OutputIteratorType = typename TextureFeatureOutputIterator< TOutput >::Type;
+    OutputIteratorType outputIt( output, region );
+
+    // The histogram can only be updated incrementally from the one of the
+    // previous voxel of the same scan line.
+    const IndexValueType lineStart = region.GetIndex( 0 );
+    bool histogramIsValid = false;
 
     // Iteration over the all image region
     while( !inputNIt.IsAtEnd() )
       {
       // If the voxel is outside of the mask, don't treat it
-      if( inputNIt.GetCenterPixel() < ( - 5) ) //the pixel is outside of the mask
+      if( inputNIt.GetCenterPixel() == outsideMaskValue ) //the pixel is outside of the mask
         {
         outputPixel.Fill(0);
         outputIt.Set(outputPixel);
+        histogramIsValid = false;
         ++inputNIt;
         ++outputIt;
         continue;
         }
-      // Initialisation of the histogram
-      hist.fill(0);
 
-      totalNumberOfFreq = 0;
-      // Iteration over all the offsets
-      for( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); ++offsets )
+      if( detectUniformNeighborhoods && this->GetUniformNeighborhoods().IsUniform( inputNIt.GetIndex() ) )
         {
-        offset = offsets.Value();
-        // Iteration over the all neighborhood region
-        for(NeighborIndexType nb = 0; nb<inputNIt.Size(); ++nb)
-          {
-          // Test if the current voxel is in the mask and is the range of the image intensity specified
-          currentInNeighborhoodPixelIntensity =  inputNIt.GetPixel(nb);
-          if( currentInNeighborhoodPixelIntensity < 0 )
-            {
-            continue;
-            }
-
-          // Test if the current offset is still pointing to a voxel inside th neighborhood
-          tempOffset = inputNIt.GetOffset(nb) + offset;
-          if(!(this->IsInsideNeighborhood(tempOffset)))
+        // The matrix is neither built nor updated, the next voxel rebuilds it
+        if( inputNIt.GetCenterPixel() != uniformValue )
           {
-            continue;
+          uniformValue = inputNIt.GetCenterPixel();
+          uniformHist.Clear();
+          uniformHist.Increment( uniformValue, uniformValue, numberOfNeighborhoodPairs );
+          this->ComputeHistogramFeatures( uniformHist, numberOfNeighborhoodPairs, this->GetNumberOfBinsPerAxis(),
+                                          marginalSums.data(), uniformPixel );
           }
+        outputIt.Set(uniformPixel);
+        histogramIsValid = false;
+        ++inputNIt;
+        ++outputIt;
+        continue;
+        }
 
-          // Test if the part of the neighborhood pointed by the offset is still part of the image
-          if(fit == faceList.begin())
-            {
-            inputNIt.GetPixel(tempOffset, isInImage);
-            if(!isInImage)
-              {
-              break;
-              }
-            }
-
-          // Test if the pointed voxel is in the mask and is the range of the image intensity specified
-          pixelIntensity = inputNIt.GetPixel(tempOffset);
-          if(pixelIntensity< 0 )
-            {
-            continue;
-            }
-
-          // Increase the corresponding bin in the histogram
-          ++totalNumberOfFreq;
-          ++hist[currentInNeighborhoodPixelIntensity][pixelIntensity];
-          }
+      // The pairs of a neighborhood in range are all counted
+      inputNIt.SetNeighborhoodInRange( detectInRangeNeighborhoods
+                                       && this->GetUniformNeighborhoods().IsInRange( inputNIt.GetIndex() ) );
+
+      // Compute the co-occurrence features
+      const bool slideFromPreviousVoxel = histogramIsValid && inputNIt.GetIndex()[0] != lineStart;
+      if( !m_NeighborhoodRadii.empty() )
+        {
+        this->ComputeVoxelRadiiFeatures( inputNIt, slideFromPreviousVoxel, hist, totalNumberOfFreq,
+                                         radiusHists, radiusTotalNumberOfFreqs,
+                                         marginalSums.data(), featurePixel, outputPixel );
+        }
+      else if( !coarserHists.empty() )
+        {
+        this->ComputeVoxelCoarserFeatures( inputNIt, slideFromPreviousVoxel, hist, totalNumberOfFreq,
+                                           coarserHists, marginalSums.data(), featurePixel, outputPixel );
+        }
+      else if( m_PerOffsetFeatures )
+        {
+        this->ComputeVoxelOffsetFeatures( inputNIt, slideFromPreviousVoxel, hist, totalNumberOfFreq,
+                                          offsetHists, offsetTotalNumberOfFreqs,
+                                          marginalSums.data(), featurePixel, outputPixel );
+        }
+      else
+        {
+        this->ComputeVoxelFeatures( inputNIt, slideFromPreviousVoxel, hist, totalNumberOfFreq,
+                                    marginalSums.data(), outputPixel );
         }
-      // Compute the run length features
-      this->ComputeFeatures( hist, totalNumberOfFreq, outputPixel);
       outputIt.Set(outputPixel);
+      histogramIsValid = m_UseSlidingWindow;
 
       ++inputNIt;
       ++outputIt;
@@ -239,21 +517,372 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeVoxelFeatures( const TNeighborhoodIterator & inputNIt,
+                        bool slideFromPreviousVoxel,
+                        THistogram & hist,
+                        unsigned int & totalNumberOfFreq,
+                        double *marginalSums,
+                        typename TOutputImage::PixelType &outputPixel )
+{
+  const auto increment = [&hist, &totalNumberOfFreq]( unsigned int a, unsigned int b )
+    {
+    ++totalNumberOfFreq;
+    hist.Increment( a, b );
+    };
+
+  if( m_UseSlidingWindow && slideFromPreviousVoxel )
+    {
+    // Add the pairs entering the neighborhood, the leaving ones have
+    // already been removed after processing the previous voxel
+    Self::VisitPairs( inputNIt, m_EnteringPairs, increment );
+    }
+  else
+    {
+    // Initialisation of the histogram
+    hist.Clear();
+    totalNumberOfFreq = 0;
+
+    // Iteration over all the pairs of the neighborhood, for all the offsets
+    Self::VisitPairs( inputNIt, m_NeighborhoodPairs, increment );
+    }
+
+  // Compute the co-occurrence features
+  this->ComputeHistogramFeatures( hist, totalNumberOfFreq, this->GetNumberOfBinsPerAxis(), marginalSums, outputPixel );
+
+  if( m_UseSlidingWindow )
+    {
+    // Remove the pairs that will leave the neighborhood when moving to
+    // the next voxel
+    Self::VisitPairs( inputNIt, m_LeavingPairs, [&hist, &totalNumberOfFreq]( unsigned int a, unsigned int b )
+      {
+      --totalNumberOfFreq;
+      hist.Decrement( a, b );
+      } );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeVoxelOffsetFeatures( const TNeighborhoodIterator & inputNIt,
+                              bool slideFromPreviousVoxel,
+                              THistogram & hist,
+                              unsigned int & totalNumberOfFreq,
+                              std::vector< THistogram > & offsetHists,
+                              std::vector< unsigned int > & offsetTotalNumberOfFreqs,
+                              double *marginalSums,
+                              typename TOutputImage::PixelType &featurePixel,
+                              typename TOutputImage::PixelType &outputPixel )
+{
+  const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+  const auto numberOfOffsets = static_cast< unsigned int >( offsetHists.size() );
+  const bool slide = m_UseSlidingWindow && slideFromPreviousVoxel;
+
+  // The pooled matrix is the sum of the ones of the offsets, so it is
+  // accumulated from the same pairs, read once
+  if( m_PooledFeatures && !slide )
+    {
+    hist.Clear();
+    totalNumberOfFreq = 0;
+    }
+
+  const unsigned int firstOffsetComponent = m_PooledFeatures ? numberOfFeatures : 0;
+  for( unsigned int o = 0; o < numberOfOffsets; ++o )
+    {
+    THistogram & offsetHist = offsetHists[o];
+    unsigned int & offsetTotalNumberOfFreq = offsetTotalNumberOfFreqs[o];
+    const auto increment = [&]( unsigned int a, unsigned int b )
+      {
+      ++offsetTotalNumberOfFreq;
+      offsetHist.Increment( a, b );
+      if( m_PooledFeatures )
+        {
+        ++totalNumberOfFreq;
+        hist.Increment( a, b );
+        }
+      };
+    if( slide )
+      {
+      Self::VisitPairs( inputNIt, m_OffsetEnteringPairs[o], increment );
+      }
+    else
+      {
+      offsetHist.Clear();
+      offsetTotalNumberOfFreq = 0;
+      Self::VisitPairs( inputNIt, m_OffsetNeighborhoodPairs[o], increment );
+      }
+
+    this->ComputeHistogramFeatures( offsetHist, offsetTotalNumberOfFreq, this->GetNumberOfBinsPerAxis(),
+                                    marginalSums, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[firstOffsetComponent + o * numberOfFeatures + i] = featurePixel[i];
+      }
+    }
+
+  if( m_PooledFeatures )
+    {
+    this->ComputeHistogramFeatures( hist, totalNumberOfFreq, this->GetNumberOfBinsPerAxis(),
+                                    marginalSums, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[i] = featurePixel[i];
+      }
+    }
+
+  if( m_UseSlidingWindow )
+    {
+    // Remove the pairs that will leave the neighborhood when moving to
+    // the next voxel
+    for( unsigned int o = 0; o < numberOfOffsets; ++o )
+      {
+      THistogram & offsetHist = offsetHists[o];
+      unsigned int & offsetTotalNumberOfFreq = offsetTotalNumberOfFreqs[o];
+      Self::VisitPairs( inputNIt, m_OffsetLeavingPairs[o], [&]( unsigned int a, unsigned int b )
+        {
+        --offsetTotalNumberOfFreq;
+        offsetHist.Decrement( a, b );
+        if( m_PooledFeatures )
+          {
+          --totalNumberOfFreq;
+          hist.Decrement( a, b );
+          }
+        } );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename THistogram>
 void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::GenerateOutputInformation()
+::ComputeVoxelRadiiFeatures( const TNeighborhoodIterator & inputNIt,
+                             bool slideFromPreviousVoxel,
+                             THistogram & hist,
+                             unsigned int & totalNumberOfFreq,
+                             std::vector< THistogram > & radiusHists,
+                             std::vector< unsigned int > & radiusTotalNumberOfFreqs,
+                             double *marginalSums,
+                             typename TOutputImage::PixelType &featurePixel,
+                             typename TOutputImage::PixelType &outputPixel )
 {
-  // Call superclass's version
-  Superclass::GenerateOutputInformation();
+  const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+  const auto numberOfRadii = static_cast< unsigned int >( m_RadiusShellPairs.size() );
+
+  if( !m_UseSlidingWindow )
+    {
+    // Each shell is added to the matrix of the smaller neighborhoods, which
+    // then holds the pairs of the next radius
+    hist.Clear();
+    totalNumberOfFreq = 0;
+    for( unsigned int k = 0; k < numberOfRadii; ++k )
+      {
+      Self::VisitPairs( inputNIt, m_RadiusShellPairs[k], [&hist, &totalNumberOfFreq]( unsigned int a, unsigned int b )
+        {
+        ++totalNumberOfFreq;
+        hist.Increment( a, b );
+        } );
+      this->ComputeHistogramFeatures( hist, totalNumberOfFreq, this->GetNumberOfBinsPerAxis(),
+                                      marginalSums, featurePixel );
+      for( unsigned int i = 0; i < numberOfFeatures; ++i )
+        {
+        outputPixel[k * numberOfFeatures + i] = featurePixel[i];
+        }
+      }
+    return;
+    }
+
+  if( slideFromPreviousVoxel )
+    {
+    for( unsigned int k = 0; k < numberOfRadii; ++k )
+      {
+      THistogram & radiusHist = radiusHists[k];
+      unsigned int & radiusTotalNumberOfFreq = radiusTotalNumberOfFreqs[k];
+      Self::VisitPairs( inputNIt, m_RadiusEnteringPairs[k], [&]( unsigned int a, unsigned int b )
+        {
+        ++radiusTotalNumberOfFreq;
+        radiusHist.Increment( a, b );
+        } );
+      }
+    }
+  else
+    {
+    // The pairs of a shell are read once, and counted in the matrices of
+    // its radius and of the larger ones
+    for( unsigned int k = 0; k < numberOfRadii; ++k )
+      {
+      radiusHists[k].Clear();
+      radiusTotalNumberOfFreqs[k] = 0;
+      }
+    for( unsigned int shell = 0; shell < numberOfRadii; ++shell )
+      {
+      Self::VisitPairs( inputNIt, m_RadiusShellPairs[shell], [&]( unsigned int a, unsigned int b )
+        {
+        for( unsigned int k = shell; k < numberOfRadii; ++k )
+          {
+          ++radiusTotalNumberOfFreqs[k];
+          radiusHists[k].Increment( a, b );
+          }
+        } );
+      }
+    }
 
-  OutputImageType* output = this->GetOutput();
-  // If the output image type is a VectorImage the number of
-  // components will be properly sized if before allocation, if the
-  // output is a fixed width vector and the wrong number of
-  // components, then an exception will be thrown.
-  if ( output->GetNumberOfComponentsPerPixel() != 8 )
+  for( unsigned int k = 0; k < numberOfRadii; ++k )
     {
-    output->SetNumberOfComponentsPerPixel( 8 );
+    this->ComputeHistogramFeatures( radiusHists[k], radiusTotalNumberOfFreqs[k], this->GetNumberOfBinsPerAxis(),
+                                    marginalSums, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[k * numberOfFeatures + i] = featurePixel[i];
+      }
+
+    // Remove the pairs that will leave the neighborhood when moving to the
+    // next voxel
+    THistogram & radiusHist = radiusHists[k];
+    unsigned int & radiusTotalNumberOfFreq = radiusTotalNumberOfFreqs[k];
+    Self::VisitPairs( inputNIt, m_RadiusLeavingPairs[k], [&]( unsigned int a, unsigned int b )
+      {
+      --radiusTotalNumberOfFreq;
+      radiusHist.Decrement( a, b );
+      } );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeVoxelCoarserFeatures( const TNeighborhoodIterator & inputNIt,
+                               bool slideFromPreviousVoxel,
+                               THistogram & hist,
+                               unsigned int & totalNumberOfFreq,
+                               std::vector< THistogram > & coarserHists,
+                               double *marginalSums,
+                               typename TOutputImage::PixelType &featurePixel,
+                               typename TOutputImage::PixelType &outputPixel )
+{
+  const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+  const auto increment = [&hist, &totalNumberOfFreq]( unsigned int a, unsigned int b )
+    {
+    ++totalNumberOfFreq;
+    hist.Increment( a, b );
+    };
+
+  if( m_UseSlidingWindow && slideFromPreviousVoxel )
+    {
+    Self::VisitPairs( inputNIt, m_EnteringPairs, increment );
+    }
+  else
+    {
+    hist.Clear();
+    totalNumberOfFreq = 0;
+    Self::VisitPairs( inputNIt, m_NeighborhoodPairs, increment );
+    }
+
+  this->ComputeHistogramFeatures( hist, totalNumberOfFreq, this->GetNumberOfBinsPerAxis(), marginalSums, featurePixel );
+  for( unsigned int i = 0; i < numberOfFeatures; ++i )
+    {
+    outputPixel[i] = featurePixel[i];
+    }
+
+  // A bin of a coarser level merges factor consecutive bins of the finest
+  // one along each axis, so its matrix sums the blocks of factor x factor
+  // bins of hist. The pairs are only read at the finest level, the coarser
+  // matrices are folded from its non-zero bins.
+  for( unsigned int l = 0; l < coarserHists.size(); ++l )
+    {
+    THistogram & coarserHist = coarserHists[l];
+    const unsigned int factor = this->GetNumberOfBinsPerAxis() / m_CoarserNumbersOfBinsPerAxis[l];
+    coarserHist.Clear();
+    hist.VisitNonZeroBins( [&coarserHist, factor]( unsigned int a, unsigned int b, unsigned int count )
+      {
+      coarserHist.Increment( a / factor, b / factor, count );
+      } );
+
+    this->ComputeHistogramFeatures( coarserHist, totalNumberOfFreq, m_CoarserNumbersOfBinsPerAxis[l],
+                                    marginalSums, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[( l + 1 ) * numberOfFeatures + i] = featurePixel[i];
+      }
+    }
+
+  if( m_UseSlidingWindow )
+    {
+    // Remove the pairs that will leave the neighborhood when moving to
+    // the next voxel
+    Self::VisitPairs( inputNIt, m_LeavingPairs, [&hist, &totalNumberOfFreq]( unsigned int a, unsigned int b )
+      {
+      --totalNumberOfFreq;
+      hist.Decrement( a, b );
+      } );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename TVisitor>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VisitPairs( const TNeighborhoodIterator & inputNIt,
+              const NeighborIndexPairVector & pairs,
+              const TVisitor & visitor )
+{
+  using DigitizedPixelType = typename TNeighborhoodIterator::ImageType::PixelType;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
+
+  // Digitized values from this one are outside of the mask or out of range
+  const DigitizedPixelType outOfRangeValue = DigitizerFunctorType::GetOutOfRangeValue();
+
+  if( inputNIt.IsNeighborhoodInRange() )
+    {
+    // All the voxels of the neighborhood are inside of the mask and in range
+    for( const NeighborIndexPairType & pair : pairs )
+      {
+      visitor( inputNIt.GetPixel( pair.first ), inputNIt.GetPixel( pair.second ) );
+      }
+    return;
+    }
+
+  for( const NeighborIndexPairType & pair : pairs )
+    {
+    // Test if the current voxel is in the mask and is the range of the image intensity specified
+    const DigitizedPixelType currentInNeighborhoodPixelIntensity = inputNIt.GetPixel( pair.first );
+    if( currentInNeighborhoodPixelIntensity >= outOfRangeValue )
+      {
+      continue;
+      }
+
+    // Test if the pointed voxel is in the mask and is the range of the image intensity specified
+    const DigitizedPixelType pixelIntensity = inputNIt.GetPixel( pair.second );
+    if( pixelIntensity >= outOfRangeValue )
+      {
+      continue;
+      }
+
+    visitor( currentInNeighborhoodPixelIntensity, pixelIntensity );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeHistogramFeatures( const THistogram &hist, const unsigned int totalNumberOfFreq,
+                            unsigned int numberOfBins,
+                            double *marginalSums,
+                            typename TOutputImage::PixelType &outputPixel )
+{
+  if( m_UseFusedFeatureEvaluation )
+    {
+    this->ComputeFeaturesFused( hist, totalNumberOfFreq, numberOfBins, marginalSums, outputPixel );
+    }
+  else
+    {
+    this->ComputeFeatures( hist, totalNumberOfFreq, numberOfBins, outputPixel );
     }
 }
 
@@ -261,11 +890,19 @@ template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 bool
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 ::IsInsideNeighborhood(const OffsetType &iteratedOffset)
+{
+  return Self::IsInsideNeighborhood( iteratedOffset, this->GetLargestNeighborhoodRadius() );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::IsInsideNeighborhood(const OffsetType &iteratedOffset, const NeighborhoodRadiusType &radius)
 {
   bool insideNeighborhood = true;
-  for ( unsigned int i = 0; i < this->m_NeighborhoodRadius.Dimension; ++i )
+  for ( unsigned int i = 0; i < radius.Dimension; ++i )
     {
-    int boundDistance = m_NeighborhoodRadius[i] - Math::abs(iteratedOffset[i]);
+    int boundDistance = radius[i] - Math::abs(iteratedOffset[i]);
     if(boundDistance < 0)
       {
       insideNeighborhood = false;
@@ -278,7 +915,87 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::ComputeFeatures( const vnl_matrix<unsigned int> &hist, const unsigned int totalNumberOfFreq,
+::ComputeNeighborhoodPairs()
+{
+  m_NeighborhoodPairs.clear();
+  m_LeavingPairs.clear();
+  m_EnteringPairs.clear();
+  m_OffsetNeighborhoodPairs.assign( m_Offsets->Size(), NeighborIndexPairVector() );
+  m_OffsetLeavingPairs.assign( m_Offsets->Size(), NeighborIndexPairVector() );
+  m_OffsetEnteringPairs.assign( m_Offsets->Size(), NeighborIndexPairVector() );
+  m_RadiusShellPairs.assign( m_NeighborhoodRadii.size(), NeighborIndexPairVector() );
+  m_RadiusLeavingPairs.assign( m_NeighborhoodRadii.size(), NeighborIndexPairVector() );
+  m_RadiusEnteringPairs.assign( m_NeighborhoodRadii.size(), NeighborIndexPairVector() );
+
+  Neighborhood< PixelType, TInputImage::ImageDimension > hood;
+  hood.SetRadius( this->GetLargestNeighborhoodRadius() );
+  const auto radius = static_cast< OffsetValueType >( this->GetLargestNeighborhoodRadius()[0] );
+
+  // A pair leaves the neighborhood when one of its voxels lies on the first
+  // slice along the sliding dimension, and enters it when one of its voxels
+  // lies on the last one.
+  typename OffsetVector::ConstIterator offsets;
+  for( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); ++offsets )
+    {
+    const OffsetType offset = offsets.Value();
+    const auto o = static_cast< unsigned int >( offsets.Index() );
+    for( NeighborIndexType nb = 0; nb < hood.Size(); ++nb )
+      {
+      const OffsetType firstOffset = hood.GetOffset( nb );
+      const OffsetType secondOffset = firstOffset + offset;
+      if( !this->IsInsideNeighborhood( secondOffset ) )
+        {
+        continue;
+        }
+      const NeighborIndexPairType pair( nb, hood.GetNeighborhoodIndex( secondOffset ) );
+      m_NeighborhoodPairs.push_back( pair );
+      m_OffsetNeighborhoodPairs[o].push_back( pair );
+      if( firstOffset[0] == -radius || secondOffset[0] == -radius )
+        {
+        m_LeavingPairs.push_back( pair );
+        m_OffsetLeavingPairs[o].push_back( pair );
+        }
+      if( firstOffset[0] == radius || secondOffset[0] == radius )
+        {
+        m_EnteringPairs.push_back( pair );
+        m_OffsetEnteringPairs[o].push_back( pair );
+        }
+
+      // The pair belongs to the shell of the first of the nested
+      // neighborhoods holding both of its voxels, and to all the larger ones
+      bool inShell = false;
+      for( unsigned int k = 0; k < m_NeighborhoodRadii.size(); ++k )
+        {
+        const NeighborhoodRadiusType & radiusK = m_NeighborhoodRadii[k];
+        if( !Self::IsInsideNeighborhood( firstOffset, radiusK ) || !Self::IsInsideNeighborhood( secondOffset, radiusK ) )
+          {
+          continue;
+          }
+        if( !inShell )
+          {
+          m_RadiusShellPairs[k].push_back( pair );
+          inShell = true;
+          }
+        const auto radiusK0 = static_cast< OffsetValueType >( radiusK[0] );
+        if( firstOffset[0] == -radiusK0 || secondOffset[0] == -radiusK0 )
+          {
+          m_RadiusLeavingPairs[k].push_back( pair );
+          }
+        if( firstOffset[0] == radiusK0 || secondOffset[0] == radiusK0 )
+          {
+          m_RadiusEnteringPairs[k].push_back( pair );
+          }
+        }
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeFeatures( const THistogram &hist, const unsigned int totalNumberOfFreq,
+                   unsigned int numberOfBins,
                    typename TOutputImage::PixelType &outputPixel)
 {
     // Now get the various means and variances. This is takes two passes
@@ -290,6 +1007,7 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 
     this->ComputeMeansAndVariances(hist,
                                    totalNumberOfFreq,
+                                   numberOfBins,
                                    pixelMean,
                                    marginalMean,
                                    marginalDevSquared,
@@ -318,45 +1036,174 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
       }
     const double log2 = std::log(2.0);
 
-    for(unsigned int a = 0; a < m_NumberOfBinsPerAxis; ++a)
+    hist.VisitNonZeroBins( [&]( unsigned int a, unsigned int b, unsigned int count )
       {
-      for(unsigned int b = 0; b < m_NumberOfBinsPerAxis; ++b)
+      float frequency = count / (float)totalNumberOfFreq;
+      if ( Math::AlmostEquals( frequency, NumericTraits< float >::ZeroValue() ) )
         {
-        float frequency = hist[a][b] / (float)totalNumberOfFreq;
-        if ( Math::AlmostEquals( frequency, NumericTraits< float >::ZeroValue() ) )
-          {
-          continue; // no use doing these calculations if we're just multiplying by
-                    // zero.
-          }
+        return; // no use doing these calculations if we're just multiplying by
+                // zero.
+        }
 
       energy += frequency * frequency;
       entropy -= ( frequency > 0.0001 ) ? frequency *std::log(frequency) / log2:0;
       correlation += ( ( a - pixelMean ) * ( b - pixelMean ) * frequency ) / pixelVarianceSquared;
       inverseDifferenceMoment += frequency / ( 1.0 + ( a - b ) * ( a - b ) );
       inertia += ( a - b ) * ( a - b ) * frequency;
-      clusterShade += std::pow( ( a - pixelMean ) + ( b - pixelMean ), 3 )  * frequency;
-      clusterProminence += std::pow( ( a - pixelMean ) + ( b - pixelMean ), 4 ) * frequency;
-      haralickCorrelation += a * b * frequency;
+      if( m_FeatureMask & ClusterShadeFeature )
+        {
+        clusterShade += std::pow( ( a - pixelMean ) + ( b - pixelMean ), 3 )  * frequency;
         }
-      }
+      if( m_FeatureMask & ClusterProminenceFeature )
+        {
+        clusterProminence += std::pow( ( a - pixelMean ) + ( b - pixelMean ), 4 ) * frequency;
+        }
+      haralickCorrelation += a * b * frequency;
+      } );
 
     haralickCorrelation = ( haralickCorrelation - marginalMean * marginalMean ) / marginalDevSquared;
 
-    outputPixel[0] = energy;
-    outputPixel[1] = entropy;
-    outputPixel[2] = correlation;
-    outputPixel[3] = inverseDifferenceMoment;
-    outputPixel[4] = inertia;
-    outputPixel[5] = clusterShade;
-    outputPixel[6] = clusterProminence;
-    outputPixel[7] = haralickCorrelation;
+    const double features[8] = { energy, entropy, correlation, inverseDifferenceMoment,
+                                 inertia, clusterShade, clusterProminence, haralickCorrelation };
+    this->SetSelectedFeatures( features, outputPixel );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename THistogram>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeFeaturesFused( const THistogram &hist, const unsigned int totalNumberOfFreq,
+                        unsigned int numberOfBins,
+                        double *marginalSums,
+                        typename TOutputImage::PixelType &outputPixel)
+{
+  const double log2 = std::log(2.0);
+  const double totalFrequency = totalNumberOfFreq;
+
+  // The accumulations of the features that are not selected are skipped
+  const bool computeEnergy = ( m_FeatureMask & EnergyFeature ) != 0;
+  const bool computeEntropy = ( m_FeatureMask & EntropyFeature ) != 0;
+  const bool computeInverseDifferenceMoment = ( m_FeatureMask & InverseDifferenceMomentFeature ) != 0;
+  const bool computeInertia = ( m_FeatureMask & InertiaFeature ) != 0;
+  const bool computeHaralickCorrelation = ( m_FeatureMask & HaralickCorrelationFeature ) != 0;
+  const bool computeCenteredFeatures =
+    ( m_FeatureMask & ( CorrelationFeature | ClusterShadeFeature | ClusterProminenceFeature ) ) != 0;
+
+  // First pass: the features that do not depend on the pixel mean, the
+  // first two moments and the marginal sums.
+  double pixelMean = 0.0;
+  double pixelSquaredMean = 0.0;
+  double energy = 0.0;
+  double entropy = 0.0;
+  double inverseDifferenceMoment = 0.0;
+  double inertia = 0.0;
+  double haralickCorrelation = 0.0;
+
+  hist.VisitNonZeroBins( [&]( unsigned int a, unsigned int b, unsigned int count )
+    {
+    const double frequency = count / totalFrequency;
+    const double difference = static_cast< double >( a ) - static_cast< double >( b );
+    const double differenceSquared = difference * difference;
+
+    pixelMean += a * frequency;
+    pixelSquaredMean += a * ( a * frequency );
+
+    if( computeEnergy )
+      {
+      energy += frequency * frequency;
+      }
+    if( computeEntropy )
+      {
+      entropy -= ( frequency > 0.0001 ) ? frequency * std::log( frequency ) / log2 : 0;
+      }
+    if( computeInverseDifferenceMoment )
+      {
+      inverseDifferenceMoment += frequency / ( 1.0 + differenceSquared );
+      }
+    if( computeInertia )
+      {
+      inertia += differenceSquared * frequency;
+      }
+    if( computeHaralickCorrelation )
+      {
+      marginalSums[a] += frequency;
+      haralickCorrelation += a * ( b * frequency );
+      }
+    } );
+
+  const double pixelVariance = pixelSquaredMean - pixelMean * pixelMean;
+  double pixelVarianceSquared = pixelVariance * pixelVariance;
+  // Variance is only used in correlation. If variance is 0, then
+  //   (index[0] - pixelMean) * (index[1] - pixelMean)
+  // should be zero as well. In this case, set the variance to 1. in
+  // order to avoid NaN correlation.
+  if( Math::FloatAlmostEqual( pixelVarianceSquared, 0.0, 4, 2*NumericTraits<double>::epsilon() ) )
+    {
+    pixelVarianceSquared = 1.;
+    }
+
+  // Second pass: the features centered on the pixel mean. The marginal sums
+  // are gathered and reset on the first visit of each row.
+  double correlation = 0.0;
+  double clusterShade = 0.0;
+  double clusterProminence = 0.0;
+  double marginalSquaredSum = 0.0;
+
+  if( computeCenteredFeatures || computeHaralickCorrelation )
+    {
+    hist.VisitNonZeroBins( [&]( unsigned int a, unsigned int b, unsigned int count )
+      {
+      const double frequency = count / totalFrequency;
+      const double centeredA = a - pixelMean;
+      const double centeredB = b - pixelMean;
+      const double centeredSum = centeredA + centeredB;
+      const double centeredSumSquared = centeredSum * centeredSum;
+
+      correlation += centeredA * centeredB * frequency;
+      clusterShade += centeredSumSquared * centeredSum * frequency;
+      clusterProminence += centeredSumSquared * centeredSumSquared * frequency;
+
+      if( marginalSums[a] != 0.0 )
+        {
+        marginalSquaredSum += marginalSums[a] * marginalSums[a];
+        marginalSums[a] = 0.0;
+        }
+      } );
+    }
+
+  // Mean and population variance of the marginal sums over all the bins.
+  // The marginal sums add up to one unless the matrix is empty.
+  const double marginalMean = ( totalNumberOfFreq > 0 ? 1.0 : 0.0 ) / numberOfBins;
+  const double marginalDevSquared = marginalSquaredSum / numberOfBins - marginalMean * marginalMean;
+
+  const double features[8] = { energy, entropy, correlation / pixelVarianceSquared, inverseDifferenceMoment,
+                               inertia, clusterShade, clusterProminence,
+                               ( haralickCorrelation - marginalMean * marginalMean ) / marginalDevSquared };
+  this->SetSelectedFeatures( features, outputPixel );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::SetSelectedFeatures( const double *features, typename TOutputImage::PixelType &outputPixel ) const
+{
+  unsigned int component = 0;
+  for( unsigned int i = 0; i < 8; ++i )
+    {
+    if( m_FeatureMask & ( 1u << i ) )
+      {
+      outputPixel[component++] = features[i];
+      }
+    }
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename THistogram>
 void
 CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::ComputeMeansAndVariances(const vnl_matrix<unsigned int> &hist,
+::ComputeMeansAndVariances(const THistogram &hist,
                            const unsigned int totalNumberOfFreq,
+                           unsigned int numberOfBins,
                            double & pixelMean,
                            double & marginalMean,
                            double & marginalDevSquared,
@@ -367,10 +1214,10 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
   // cleverly compressed to one pass, but it's not clear that that's necessary.
 
   // Initialize everything
-  auto *marginalSums = new double[m_NumberOfBinsPerAxis];
+  auto *marginalSums = new double[numberOfBins];
 
   for ( double *ms_It = marginalSums;
-        ms_It < marginalSums + m_NumberOfBinsPerAxis; ms_It++ )
+        ms_It < marginalSums + numberOfBins; ms_It++ )
     {
     *ms_It = 0;
     }
@@ -378,15 +1225,12 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 
   // Ok, now do the first pass through the histogram to get the marginal sums
   // and compute the pixel mean
-  for(unsigned int a = 0; a < m_NumberOfBinsPerAxis; a++)
+  hist.VisitNonZeroBins( [&]( unsigned int a, unsigned int, unsigned int count )
     {
-    for(unsigned int b = 0; b < m_NumberOfBinsPerAxis; b++)
-      {
-      float frequency = hist[a][b] / (float)totalNumberOfFreq;
-      pixelMean += a * frequency;
-      marginalSums[a] += frequency;
-      }
-    }
+    float frequency = count / (float)totalNumberOfFreq;
+    pixelMean += a * frequency;
+    marginalSums[a] += frequency;
+    } );
 
   /*  Now get the mean and deviaton of the marginal sums.
       Compute incremental mean and SD, a la Knuth, "The  Art of Computer
@@ -400,7 +1244,7 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
   */
   marginalMean = marginalSums[0];
   marginalDevSquared = 0;
-  for ( unsigned int arrayIndex = 1; arrayIndex < m_NumberOfBinsPerAxis; arrayIndex++ )
+  for ( unsigned int arrayIndex = 1; arrayIndex < numberOfBins; arrayIndex++ )
     {
     int    k = arrayIndex + 1;
     double M_k_minus_1 = marginalMean;
@@ -413,18 +1257,15 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
     marginalMean = M_k;
     marginalDevSquared = S_k;
     }
-  marginalDevSquared = marginalDevSquared / m_NumberOfBinsPerAxis;
+  marginalDevSquared = marginalDevSquared / numberOfBins;
 
   // OK, now compute the pixel variances.
   pixelVariance = 0;
-  for(unsigned int a = 0; a < m_NumberOfBinsPerAxis; a++)
+  hist.VisitNonZeroBins( [&]( unsigned int a, unsigned int, unsigned int count )
     {
-    for(unsigned int b = 0; b < m_NumberOfBinsPerAxis; b++)
-      {
-      float frequency = hist[a][b] / (float)totalNumberOfFreq;
-      pixelVariance += ( a - pixelMean ) * ( a - pixelMean ) * (frequency);
-      }
-    }
+    float frequency = count / (float)totalNumberOfFreq;
+    pixelVariance += ( a - pixelMean ) * ( a - pixelMean ) * (frequency);
+    } );
 
   delete[] marginalSums;
 }
@@ -437,25 +1278,39 @@ CoocurrenceTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 
   Superclass::PrintSelf( os, indent );
 
-  itkPrintSelfObjectMacro( DigitizedInputImage );
-
   os << indent << "NeighborhoodRadius: "
     << static_cast< typename NumericTraits<
     NeighborhoodRadiusType >::PrintType >( m_NeighborhoodRadius ) << std::endl;
+  os << indent << "NeighborhoodRadii:";
+  for( const NeighborhoodRadiusType & radius : m_NeighborhoodRadii )
+    {
+    os << " " << static_cast< typename NumericTraits< NeighborhoodRadiusType >::PrintType >( radius );
+    }
+  os << std::endl;
 
   itkPrintSelfObjectMacro( Offsets );
 
-  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "CoarserNumbersOfBinsPerAxis:";
+  for( const unsigned int numberOfBins : m_CoarserNumbersOfBinsPerAxis )
+    {
+    os << " " << numberOfBins;
+    }
+  os << std::endl;
   os << indent << "Min: "
     << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMinimum )
     << std::endl;
   os << indent << "Max: "
     << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMaximum )
     << std::endl;
-  os << indent << "InsidePixelValue: "
-    << static_cast< typename NumericTraits< PixelType >::PrintType >(
-    m_InsidePixelValue ) << std::endl;
   os << indent << "Normalize: " << m_Normalize << std::endl;
+  os << indent << "UseSlidingWindow: " << m_UseSlidingWindow << std::endl;
+  os << indent << "DetectUniformNeighborhoods: " << m_DetectUniformNeighborhoods << std::endl;
+  os << indent << "DetectInRangeNeighborhoods: " << m_DetectInRangeNeighborhoods << std::endl;
+  os << indent << "HistogramRepresentation: " << m_HistogramRepresentation << std::endl;
+  os << indent << "UseFusedFeatureEvaluation: " << m_UseFusedFeatureEvaluation << std::endl;
+  os << indent << "FeatureMask: " << m_FeatureMask << std::endl;
+  os << indent << "PerOffsetFeatures: " << m_PerOffsetFeatures << std::endl;
+  os << indent << "PooledFeatures: " << m_PooledFeatures << std::endl;
 }
 } // end of namespace Statistics
 } // end of namespace itk
@@ -21,11 +21,26 @@
 #include "itkNumericTraits.h"
 #include "itkMath.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace itk
 {
 namespace Statistics
 {
 
+/** \class Digitizer
+ * \brief Functor mapping a mask value and an intensity to the index of the
+ * intensity bin.
+ *
+ * The two largest values of the output type are reserved: the largest one
+ * marks the voxels outside of the mask, and the next one the voxels whose
+ * intensity is outside of [min, max). All the smaller values are bin
+ * indices, so the output type must be able to hold the number of bins plus
+ * two.
+ *
+ * \ingroup TextureFeatures
+ */
 template< typename TInput1, typename TInput2 = TInput1, typename TOutput = TInput1>
 class Digitizer
 {
@@ -33,6 +48,34 @@ public:
   using PixelType = TInput2;
   using MaskPixelType = TInput1;
 
+  /** Output value of the voxels outside of the mask. */
+  static constexpr TOutput GetOutsideMaskValue()
+    {
+      return std::numeric_limits< TOutput >::max();
+    }
+
+  /** Output value of the voxels inside of the mask whose intensity is out of
+   * range. Any smaller output value is a bin index. */
+  static constexpr TOutput GetOutOfRangeValue()
+    {
+      return std::numeric_limits< TOutput >::max() - 1;
+    }
+
+  /** Largest number of bins that the output type can represent. */
+  static constexpr unsigned int GetMaximumNumberOfBins()
+    {
+      return static_cast< unsigned int >( std::numeric_limits< TOutput >::max() ) - 1;
+    }
+
+  /** Output value for factor times fewer bins over the same range, from the
+   * output value for a number of bins multiple of factor. The bins are merged
+   * by groups of factor consecutive bins, and the reserved values are kept,
+   * so an image is digitized once at the finest level. */
+  static constexpr TOutput Coarsen( TOutput value, unsigned int factor )
+    {
+      return value >= GetOutOfRangeValue() ? value : static_cast< TOutput >( value / factor );
+    }
+
   Digitizer()
     : m_NumberOfBinsPerAxis(256),
       m_MaskValue(1),
@@ -69,15 +112,19 @@ public:
 
       if(maskPixel != m_MaskValue)
         {
-        return - 10;
+        return GetOutsideMaskValue();
         }
       else if (inputPixel < this->m_Min || inputPixel >= m_Max)
         {
-        return - 1;
+        return GetOutOfRangeValue();
         }
       else
         {
-        return Math::Floor< TOutput >((inputPixel - m_Min)/((m_Max-m_Min)/ (float)m_NumberOfBinsPerAxis));
+        // Rounding can floor an intensity just below max to the number of
+        // bins, which would alias the reserved values or an array bound
+        const TOutput bin =
+          Math::Floor< TOutput >((inputPixel - m_Min)/((m_Max-m_Min)/ (float)m_NumberOfBinsPerAxis));
+        return std::min( bin, static_cast< TOutput >( m_NumberOfBinsPerAxis - 1 ) );
         }
     }
 
@@ -0,0 +1,183 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDigitizerImageFilter_h
+#define itkDigitizerImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkDigitizerFunctor.h"
+#include "itkMetaDataObject.h"
+
+namespace itk
+{
+namespace Statistics
+{
+/** \class DigitizerImageFilter
+ *  \brief This class maps each voxel of an image, and of a mask image if
+ *  provided, to the index of its intensity bin.
+ *
+ * The output is the digitized image computed internally by the
+ * CoocurrenceTextureFeaturesImageFilter and the
+ * RunLengthTextureFeaturesImageFilter. It can be given to both of them with
+ * SetDigitizedImage(), so that the input is digitized only once when they
+ * share the same image, mask, number of bins and intensity range. The number
+ * of bins and the intensity range are recorded in the MetaDataDictionary of
+ * the output, as the unsigned int "NumberOfBinsPerAxis" and the doubles
+ * "HistogramMinimum" and "HistogramMaximum", and the texture feature filters
+ * throw an exception when their own parameters differ. Whether a mask was
+ * used and its inside pixel value are recorded as the bool "UsesMask" and
+ * the double "InsidePixelValue", and checked by the texture feature filters
+ * given the mask too.
+ *
+ * The output can also hold a halo of HaloRadius voxels around the image,
+ * where the digitized voxels at the boundary of the image are replicated
+ * (zero flux Neumann). The texture feature filters read the neighborhoods of
+ * their voxels directly from the buffer of the digitized image, so they
+ * digitize their input with the radius of their largest neighborhood, and a
+ * DigitizedImage with this halo is used without being copied.
+ *
+ * The two largest values of the output pixel type are reserved for the voxels
+ * outside of the mask and the voxels out of the intensity range (see
+ * Digitizer). The texture feature filters accept an output pixel type of
+ * uint8_t, for up to 254 bins, or uint16_t, for up to 65534 bins.
+ *
+ * Template Parameters:
+ * -# The input image type: a N dimensional image where the pixel type MUST be integer.
+ * -# The mask image type. (Optional, defaults to an unsigned char image.)
+ * -# The output image type: a N dimensional image of uint8_t or uint16_t.
+ *    (Optional, defaults to uint16_t.)
+ *
+ * Inputs and parameters:
+ * -# An image
+ * -# A mask defining the region over which texture features will be
+ *    calculated. (Optional)
+ * -# The pixel value that defines the "inside" of the mask. (Optional, defaults
+ *    to 1 if a mask is set.)
+ * -# The number of intensity bins. (Optional, defaults to 256.)
+ * -# The pixel intensity range over which the features will be calculated.
+ *    (Optional, defaults to the full dynamic range of the pixel type.)
+ *
+ * \sa CoocurrenceTextureFeaturesImageFilter
+ * \sa RunLengthTextureFeaturesImageFilter
+ *
+ * \ingroup TextureFeatures
+ **/
+
+template< typename TInputImage,
+          typename TMaskImage = Image< unsigned char, TInputImage::ImageDimension >,
+          typename TOutputImage = Image< uint16_t, TInputImage::ImageDimension > >
+class ITK_TEMPLATE_EXPORT DigitizerImageFilter
+  : public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard type alias */
+  using Self = DigitizerImageFilter;
+  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DigitizerImageFilter, ImageToImageFilter);
+
+  /** standard New() method support */
+  itkNewMacro(Self);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using MaskImageType = TMaskImage;
+
+  using PixelType = typename InputImageType::PixelType;
+  using MaskPixelType = typename MaskImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+  using OutputSizeType = typename OutputImageType::SizeType;
+
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, OutputPixelType >;
+
+  /** Method to set the mask image */
+  itkSetInputMacro(MaskImage, MaskImageType);
+
+  /** Method to get the mask image */
+  itkGetInputMacro(MaskImage, MaskImageType);
+
+  /** Specify the default number of bins per axis */
+  static constexpr unsigned int DefaultBinsPerAxis = 256;
+
+  /** Set number of intensity bins */
+  itkSetMacro( NumberOfBinsPerAxis, unsigned int );
+
+  /** Get number of intensity bins */
+  itkGetConstMacro( NumberOfBinsPerAxis, unsigned int );
+
+  /** Get the max pixel value of the intensity range. */
+  itkGetConstMacro( HistogramMaximum, PixelType );
+  itkSetMacro( HistogramMaximum, PixelType);
+
+  /** Get the min pixel value of the intensity range. */
+  itkGetConstMacro( HistogramMinimum, PixelType );
+  itkSetMacro( HistogramMinimum, PixelType);
+
+  /**
+   * Set the pixel value of the mask that should be considered "inside" the
+   * object. Defaults to 1.
+   */
+  itkSetMacro( InsidePixelValue, MaskPixelType );
+  itkGetConstMacro( InsidePixelValue, MaskPixelType );
+
+  /** Set/Get the radius of the halo around the image. The largest possible
+   * region of the output is the one of the input padded by HaloRadius, and
+   * the voxels of the halo hold the digitized value of the nearest voxel of
+   * the image. Zero by default. */
+  itkSetMacro( HaloRadius, OutputSizeType );
+  itkGetConstReferenceMacro( HaloRadius, OutputSizeType );
+
+protected:
+  DigitizerImageFilter();
+  ~DigitizerImageFilter() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Pad the largest possible region of the output by HaloRadius. */
+  void GenerateOutputInformation() override;
+
+  /** Request the output requested region from the input and the mask,
+   * clamped to their largest possible region: the voxels of the halo only
+   * depend on the voxels at the boundary of the image. */
+  void GenerateInputRequestedRegion() override;
+
+  void BeforeThreadedGenerateData() override;
+  void DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread ) override;
+
+private:
+  /** Digitize the voxels of a region of the halo from the nearest voxel of
+   * the image. */
+  void DigitizeHalo( const DigitizerFunctorType & digitizer, const OutputRegionType & haloRegion );
+
+  unsigned int                          m_NumberOfBinsPerAxis;
+  PixelType                             m_HistogramMinimum;
+  PixelType                             m_HistogramMaximum;
+  MaskPixelType                         m_InsidePixelValue;
+  OutputSizeType                        m_HaloRadius;
+};
+} // end of namespace Statistics
+} // end of namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDigitizerImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkDigitizerImageFilter_hxx
+#define itkDigitizerImageFilter_hxx
+
+#include "itkDigitizerImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+
+namespace itk
+{
+namespace Statistics
+{
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::DigitizerImageFilter() :
+    m_NumberOfBinsPerAxis( itkGetStaticConstMacro( DefaultBinsPerAxis ) ),
+    m_HistogramMinimum( NumericTraits<PixelType>::NonpositiveMin() ),
+    m_HistogramMaximum( NumericTraits<PixelType>::max() ),
+    m_InsidePixelValue( NumericTraits<MaskPixelType>::OneValue() )
+{
+  m_HaloRadius.Fill( 0 );
+
+  this->SetNumberOfRequiredInputs( 1 );
+  this->SetNumberOfRequiredOutputs( 1 );
+
+  // Mark the "MaskImage" as an optional named input. First it has to
+  // be added to the list of named inputs then removed from the
+  // required list.
+  Self::AddRequiredInputName("MaskImage");
+  Self::RemoveRequiredInputName("MaskImage");
+
+  this->DynamicMultiThreadingOn();
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  OutputRegionType largestRegion = this->GetInput()->GetLargestPossibleRegion();
+  largestRegion.PadByRadius( m_HaloRadius );
+  this->GetOutput()->SetLargestPossibleRegion( largestRegion );
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  const OutputRegionType & outputRequestedRegion = this->GetOutput()->GetRequestedRegion();
+
+  for( const auto & input : this->GetInputs() )
+    {
+    auto * image = dynamic_cast< ImageBase< TInputImage::ImageDimension > * >( input.GetPointer() );
+    if( image == nullptr )
+      {
+      continue;
+      }
+
+    // Clamp the bounds of the requested region in each dimension to the
+    // image, so that the nearest voxels of the halo are requested
+    const typename TInputImage::RegionType & largestRegion = image->GetLargestPossibleRegion();
+    typename TInputImage::RegionType requestedRegion;
+    for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+      {
+      const IndexValueType largestStart = largestRegion.GetIndex( d );
+      const IndexValueType largestEnd = largestStart + static_cast< IndexValueType >( largestRegion.GetSize( d ) ) - 1;
+      const IndexValueType start = std::min( std::max( outputRequestedRegion.GetIndex( d ), largestStart ),
+                                             largestEnd );
+      const IndexValueType end = std::min( std::max( outputRequestedRegion.GetIndex( d )
+        + static_cast< IndexValueType >( outputRequestedRegion.GetSize( d ) ) - 1, largestStart ), largestEnd );
+      requestedRegion.SetIndex( d, start );
+      requestedRegion.SetSize( d, static_cast< SizeValueType >( end - start + 1 ) );
+      }
+    image->SetRequestedRegion( requestedRegion );
+    }
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  if( m_NumberOfBinsPerAxis > DigitizerFunctorType::GetMaximumNumberOfBins() )
+    {
+    itkExceptionMacro( "NumberOfBinsPerAxis is " << m_NumberOfBinsPerAxis << " but must be at most "
+                       << DigitizerFunctorType::GetMaximumNumberOfBins() << " for the output pixel type" );
+    }
+
+  // The texture feature filters check that the digitized image they are
+  // given matches their own parameters
+  MetaDataDictionary & dictionary = this->GetOutput()->GetMetaDataDictionary();
+  EncapsulateMetaData< unsigned int >( dictionary, "NumberOfBinsPerAxis", m_NumberOfBinsPerAxis );
+  EncapsulateMetaData< double >( dictionary, "HistogramMinimum", static_cast< double >( m_HistogramMinimum ) );
+  EncapsulateMetaData< double >( dictionary, "HistogramMaximum", static_cast< double >( m_HistogramMaximum ) );
+  EncapsulateMetaData< bool >( dictionary, "UsesMask", this->GetMaskImage() != nullptr );
+  EncapsulateMetaData< double >( dictionary, "InsidePixelValue", static_cast< double >( m_InsidePixelValue ) );
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread )
+{
+  const DigitizerFunctorType digitizer( m_NumberOfBinsPerAxis, m_InsidePixelValue,
+                                        m_HistogramMinimum, m_HistogramMaximum );
+
+  // The voxels of the image are digitized in a single pass, the ones of the
+  // halo around it are then filled slab by slab
+  OutputRegionType imageRegion = outputRegionForThread;
+  if( !imageRegion.Crop( this->GetInput()->GetLargestPossibleRegion() ) )
+    {
+    this->DigitizeHalo( digitizer, outputRegionForThread );
+    return;
+    }
+
+  ImageRegionConstIterator< InputImageType > inputIt( this->GetInput(), imageRegion );
+  ImageRegionIterator< OutputImageType > outputIt( this->GetOutput(), imageRegion );
+
+  const MaskImageType * maskPtr = this->GetMaskImage();
+  if( maskPtr == nullptr )
+    {
+    for(; !outputIt.IsAtEnd(); ++inputIt, ++outputIt )
+      {
+      outputIt.Set( digitizer( m_InsidePixelValue, inputIt.Get() ) );
+      }
+    }
+  else
+    {
+    ImageRegionConstIterator< MaskImageType > maskIt( maskPtr, imageRegion );
+    for(; !outputIt.IsAtEnd(); ++inputIt, ++maskIt, ++outputIt )
+      {
+      outputIt.Set( digitizer( maskIt.Get(), inputIt.Get() ) );
+      }
+    }
+
+  // The rest of the region is split in the slabs below and above the image
+  // along each dimension, restricted to the image along the previous ones
+  OutputRegionType remainingRegion = outputRegionForThread;
+  for( unsigned int d = 0; d < OutputImageType::ImageDimension; ++d )
+    {
+    const IndexValueType remainingStart = remainingRegion.GetIndex( d );
+    const IndexValueType remainingEnd = remainingStart + static_cast< IndexValueType >( remainingRegion.GetSize( d ) );
+    const IndexValueType imageStart = imageRegion.GetIndex( d );
+    const IndexValueType imageEnd = imageStart + static_cast< IndexValueType >( imageRegion.GetSize( d ) );
+    if( remainingStart < imageStart )
+      {
+      OutputRegionType slab = remainingRegion;
+      slab.SetSize( d, static_cast< SizeValueType >( imageStart - remainingStart ) );
+      this->DigitizeHalo( digitizer, slab );
+      }
+    if( imageEnd < remainingEnd )
+      {
+      OutputRegionType slab = remainingRegion;
+      slab.SetIndex( d, imageEnd );
+      slab.SetSize( d, static_cast< SizeValueType >( remainingEnd - imageEnd ) );
+      this->DigitizeHalo( digitizer, slab );
+      }
+    remainingRegion.SetIndex( d, imageStart );
+    remainingRegion.SetSize( d, imageRegion.GetSize( d ) );
+    }
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::DigitizeHalo( const DigitizerFunctorType & digitizer, const OutputRegionType & haloRegion )
+{
+  const InputImageType * inputPtr = this->GetInput();
+  const MaskImageType * maskPtr = this->GetMaskImage();
+  const typename InputImageType::RegionType & largestRegion = inputPtr->GetLargestPossibleRegion();
+
+  for( ImageRegionIteratorWithIndex< OutputImageType > outputIt( this->GetOutput(), haloRegion );
+       !outputIt.IsAtEnd(); ++outputIt )
+    {
+    // Nearest voxel of the image
+    typename InputImageType::IndexType index = outputIt.GetIndex();
+    for( unsigned int d = 0; d < InputImageType::ImageDimension; ++d )
+      {
+      const IndexValueType largestStart = largestRegion.GetIndex( d );
+      const IndexValueType largestEnd = largestStart + static_cast< IndexValueType >( largestRegion.GetSize( d ) ) - 1;
+      index[d] = std::min( std::max( index[d], largestStart ), largestEnd );
+      }
+    const MaskPixelType maskValue = maskPtr == nullptr ? m_InsidePixelValue : maskPtr->GetPixel( index );
+    outputIt.Set( digitizer( maskValue, inputPtr->GetPixel( index ) ) );
+    }
+}
+
+template< typename TInputImage, typename TMaskImage, typename TOutputImage >
+void
+DigitizerImageFilter< TInputImage, TMaskImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "Min: "
+    << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMinimum )
+    << std::endl;
+  os << indent << "Max: "
+    << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMaximum )
+    << std::endl;
+  os << indent << "InsidePixelValue: "
+    << static_cast< typename NumericTraits< MaskPixelType >::PrintType >(
+    m_InsidePixelValue ) << std::endl;
+  os << indent << "HaloRadius: " << m_HaloRadius << std::endl;
+}
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
@@ -20,104 +20,120 @@
 
 #include "itkNumericTraits.h"
 #include "itkMath.h"
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace itk
 {
 namespace Function
 {
 
-/* \class FirstOrderTextureHistogram
+#if defined( __SIZEOF_INT128__ )
+/** Power sums of the 8 and 16 bit integral pixel values are accumulated
+ * exactly in 128 bit integers where the compiler provides them. */
+template< class TInputPixel >
+struct FirstOrderTextureExactMomentsTraits
+{
+  static constexpr bool Exact = std::is_integral< TInputPixel >::value && sizeof( TInputPixel ) <= 2;
+};
+#else
+template< class TInputPixel >
+struct FirstOrderTextureExactMomentsTraits
+{
+  static constexpr bool Exact = false;
+};
+#endif
+
+
+/* \class FirstOrderTextureMoments
  *
- * An implementation of the "MovingHistogram" interface for the
- * MovingHistogramImageFilter class. This implementation maintains a
- * std::map based "histogram" during iteration and computes first
- * order statistics from the histogram.
+ * Count of the pixels and sum of n log(n) over the pixel value
+ * frequencies n of a FirstOrderTextureHistogram, updated when a pixel
+ * is added or removed, and first order statistics computed from the
+ * sums of the powers of the deviations of the pixel values to their
+ * mean.
+ *
+ * For 8 and 16 bit integral pixel types, the sums of the powers of the
+ * pixel values are also updated, exactly, so that the statistics are
+ * computed without visiting the histogram. Otherwise, updating them in
+ * floating point would let the rounding errors of the removed pixels
+ * build up along the image, so the histogram sums the deviations again
+ * when the features are computed.
  *
  * \ingroup ITKTextureFeatures
  */
-template< class TInputPixel, class TOutputPixel >
-class ITK_TEMPLATE_EXPORT FirstOrderTextureHistogram
+template< class TInputPixel, class TOutputPixel,
+          bool VExactMoments = FirstOrderTextureExactMomentsTraits< TInputPixel >::Exact >
+class ITK_TEMPLATE_EXPORT FirstOrderTextureMoments
 {
-public:
+protected:
 
-  FirstOrderTextureHistogram()
+  FirstOrderTextureMoments()
     {
-      m_Count = 0;
+      this->ResetMoments();
     }
 
-  void AddPixel(const TInputPixel & p)
+  /** Account for a pixel of value p, previousFrequency being the
+   * number of pixels of this value before the addition. */
+  void AddMoments(const TInputPixel &, const size_t previousFrequency)
   {
-    m_Map[p]++;
+    m_SumFrequencyLogFrequency += XLogX( previousFrequency + 1 ) - XLogX( previousFrequency );
     ++m_Count;
   }
 
-  void RemovePixel(const TInputPixel & p)
+  /** Remove a pixel of value p, previousFrequency being the number of
+   * pixels of this value before the removal. */
+  void RemoveMoments(const TInputPixel &, const size_t previousFrequency)
   {
-
-    // insert new item if one doesn't exist
-    auto it = m_Map.find( p );
-
-    assert( it != m_Map.end() );
-
-    if ( --(it->second) == 0 )
+    if ( --m_Count == 0 )
       {
-      m_Map.erase( it );
+      // start again from exact sums
+      this->ResetMoments();
+      return;
       }
-    --m_Count;
-
+    m_SumFrequencyLogFrequency -= XLogX( previousFrequency ) - XLogX( previousFrequency - 1 );
   }
 
-  TOutputPixel GetValue(const TInputPixel &)
+  /** Compute the features from the mean of the pixel values and the
+   * sums of the second, third and fourth powers of their deviations to
+   * the mean. */
+  TOutputPixel GetFeatures(const TInputPixel & minimum, const TInputPixel & maximum,
+                           const double mean, const double sum2, const double sum3, const double sum4) const
   {
     TOutputPixel out;
     NumericTraits<TOutputPixel>::SetLength( out, 8 );
 
-    double sum = 0.0;
-    double sum2 = 0.0;
-    double sum3 = 0.0;
-    double sum4 = 0.0;
     const size_t count = m_Count;
 
-    double entropy = 0.0;
-    size_t curCount = 0;
-
-    for ( auto i = m_Map.begin(); i != m_Map.end(); ++i )
+    // -sum p log2(p) with p = n / count
+    double entropy = ( std::log( double( count ) ) - m_SumFrequencyLogFrequency / count ) / itk::Math::ln2;
+    if ( entropy < 0.0 )
       {
-      double t = double(i->first)*double(i->second);
-      sum += t;
-      sum2 += ( t *= double(i->first) );
-      sum3 += ( t *= double(i->first) );
-      sum4 += ( t *= double(i->first) );
-
-      curCount += i->second;
-
-      const double p_x = double( i->second ) / count;
-      entropy += -p_x*std::log( p_x ) / itk::Math::ln2;
+      entropy = 0.0;
       }
 
-    const double mean = sum / count;
-
     // unbiased estimate
-    const double variance = ( sum2 - ( sum * sum ) / count )  / ( count - 1 );
+    const double variance = std::max( sum2, 0.0 ) / ( count - 1 );
     const double sigma = std::sqrt(variance);
     double skewness = 0.0;
     double kurtosis = 0.0;
     if(std::abs(variance * sigma) > itk::NumericTraits<double>::min())
       {
-
-      skewness = ( ( sum3 - 3.0 * mean * sum2 ) / count + 2.0 * mean * mean*mean ) / ( variance * sigma );
+      skewness = ( sum3 / count ) / ( variance * sigma );
       }
     if(std::abs(variance) > itk::NumericTraits<double>::min())
       {
-      kurtosis = ( sum4 / count  + mean *( -4.0 * sum3 / count  +  mean * ( 6.0 *sum2 / count  - 3.0 * mean * mean ))) /
-        ( variance * variance ) - 3.0;
+      kurtosis = ( sum4 / count ) / ( variance * variance ) - 3.0;
       }
 
     unsigned int i = 0;
     out[i++] = mean;
-    out[i++] = m_Map.begin()->first;
-    out[i++] = m_Map.rbegin()->first;
+    out[i++] = minimum;
+    out[i++] = maximum;
     out[i++] = variance;
     out[i++] = sigma;
     out[i++] = skewness;
@@ -126,15 +142,365 @@ public:
     return out;
   }
 
+  /** Compute the features by summing the deviations of the pixel values
+   * to their mean over the bins of the histogram, visited in order by
+   * [begin, end) and given as pairs of a pixel value and a frequency. */
+  template< class TBinIterator >
+  TOutputPixel SumFeatures(const TInputPixel & minimum, const TInputPixel & maximum,
+                           const TBinIterator & begin, const TBinIterator & end) const
+  {
+    double sum = 0.0;
+    for ( TBinIterator it = begin; it != end; ++it )
+      {
+      sum += double( it->second ) * double( it->first );
+      }
+    const double mean = sum / m_Count;
+
+    double sum2 = 0.0;
+    double sum3 = 0.0;
+    double sum4 = 0.0;
+    for ( TBinIterator it = begin; it != end; ++it )
+      {
+      const double x = double( it->first ) - mean;
+      const double n = double( it->second );
+      double t = n * x;
+      sum2 += ( t *= x );
+      sum3 += ( t *= x );
+      sum4 += ( t *= x );
+      }
+    return this->GetFeatures( minimum, maximum, mean, sum2, sum3, sum4 );
+  }
+
+  /** Start again from an empty histogram. */
+  void ResetMoments()
+  {
+    m_Count = 0;
+    m_SumFrequencyLogFrequency = 0.0;
+  }
+
+  size_t        m_Count;
+
+private:
+  static double XLogX(const size_t n)
+  {
+    return n > 1 ? double( n ) * std::log( double( n ) ) : 0.0;
+  }
+
+  double        m_SumFrequencyLogFrequency;
+};
+
+
+#if defined( __SIZEOF_INT128__ )
+/* \class FirstOrderTextureMoments
+ *
+ * Specialization of FirstOrderTextureMoments for 8 and 16 bit integral
+ * pixel types, also updating the sums of the powers of the pixel values
+ * in integers. Their fourth power sum needs 128 bits over large
+ * neighborhoods of 16 bit values.
+ *
+ * \ingroup ITKTextureFeatures
+ */
+template< class TInputPixel, class TOutputPixel >
+class ITK_TEMPLATE_EXPORT FirstOrderTextureMoments< TInputPixel, TOutputPixel, true >:
+  public FirstOrderTextureMoments< TInputPixel, TOutputPixel, false >
+{
+protected:
+  using Superclass = FirstOrderTextureMoments< TInputPixel, TOutputPixel, false >;
+
+  FirstOrderTextureMoments() :
+    m_Sum( 0 ),
+    m_Sum2( 0 ),
+    m_Sum3( 0 ),
+    m_Sum4( 0 )
+    {
+    }
+
+  void AddMoments(const TInputPixel & p, const size_t previousFrequency)
+  {
+    Superclass::AddMoments( p, previousFrequency );
+    const SumType x = p;
+    SumType t = x;
+    m_Sum += t;
+    m_Sum2 += ( t *= x );
+    m_Sum3 += ( t *= x );
+    m_Sum4 += ( t *= x );
+  }
+
+  void RemoveMoments(const TInputPixel & p, const size_t previousFrequency)
+  {
+    Superclass::RemoveMoments( p, previousFrequency );
+    const SumType x = p;
+    SumType t = x;
+    m_Sum -= t;
+    m_Sum2 -= ( t *= x );
+    m_Sum3 -= ( t *= x );
+    m_Sum4 -= ( t *= x );
+  }
+
+  TOutputPixel GetFeatures(const TInputPixel & minimum, const TInputPixel & maximum) const
+  {
+    // Shift the exact power sums to the integral part c of the mean,
+    // still exactly, so that the deviations to the mean are computed
+    // from sums of small values, without cancellation.
+    const SumType n = this->m_Count;
+    const SumType c = m_Sum / n;
+    const SumType s1 = m_Sum - n * c;
+    const SumType s2 = m_Sum2 + c * ( -2 * m_Sum + n * c );
+    const SumType s3 = m_Sum3 + c * ( -3 * m_Sum2 + c * ( 3 * m_Sum - n * c ) );
+    const SumType s4 = m_Sum4 + c * ( -4 * m_Sum3 + c * ( 6 * m_Sum2 + c * ( -4 * m_Sum + n * c ) ) );
+
+    const double count = double( this->m_Count );
+    const double d = double( s1 ) / count;
+    const double t2 = double( s2 );
+    const double t3 = double( s3 );
+    const double t4 = double( s4 );
+    const double sum2 = t2 - d * d * count;
+    const double sum3 = t3 + d * ( -3.0 * t2 + 2.0 * d * d * count );
+    const double sum4 = t4 + d * ( -4.0 * t3 + d * ( 6.0 * t2 - 3.0 * d * d * count ) );
+    return Superclass::GetFeatures( minimum, maximum, double( c ) + d, sum2, sum3, sum4 );
+  }
+
+  void ResetMoments()
+  {
+    Superclass::ResetMoments();
+    m_Sum = 0;
+    m_Sum2 = 0;
+    m_Sum3 = 0;
+    m_Sum4 = 0;
+  }
+
+private:
+  using SumType = __int128;
+
+  SumType       m_Sum;
+  SumType       m_Sum2;
+  SumType       m_Sum3;
+  SumType       m_Sum4;
+};
+#endif
+
+
+/* \class FirstOrderTextureHistogram
+ *
+ * An implementation of the "MovingHistogram" interface for the
+ * MovingHistogramImageFilter class. This implementation maintains a
+ * std::map based "histogram" during iteration and computes first
+ * order statistics from moments updated along with the histogram.
+ *
+ * For 8 and 16 bit integral pixel types, VUseVectorBasedAlgorithm
+ * selects a specialization storing the counts in a vector indexed by
+ * the pixel value.
+ *
+ * \ingroup ITKTextureFeatures
+ */
+template< class TInputPixel, class TOutputPixel,
+          bool VUseVectorBasedAlgorithm = std::is_integral< TInputPixel >::value && sizeof( TInputPixel ) <= 2 >
+class ITK_TEMPLATE_EXPORT FirstOrderTextureHistogram:
+  public FirstOrderTextureMoments< TInputPixel, TOutputPixel >
+{
+public:
+
+  void AddPixel(const TInputPixel & p)
+  {
+    size_t & frequency = m_Map[p];
+    this->AddMoments( p, frequency );
+    ++frequency;
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+
+    auto it = m_Map.find( p );
+
+    assert( it != m_Map.end() );
+
+    this->RemoveMoments( p, it->second );
+    if ( --(it->second) == 0 )
+      {
+      m_Map.erase( it );
+      }
+
+  }
+
+  /** Remove all the pixels. */
+  void Clear()
+  {
+    m_Map.clear();
+    this->ResetMoments();
+  }
+
+  TOutputPixel GetValue(const TInputPixel &)
+  {
+    return this->ComputeValue( std::integral_constant< bool, ExactMoments >() );
+  }
+
   void AddBoundary(){}
 
   void RemoveBoundary(){}
 
 private:
+    static constexpr bool ExactMoments = FirstOrderTextureExactMomentsTraits< TInputPixel >::Exact;
+
+    TOutputPixel ComputeValue(std::true_type)
+    {
+      return this->GetFeatures( m_Map.begin()->first, m_Map.rbegin()->first );
+    }
+
+    TOutputPixel ComputeValue(std::false_type)
+    {
+      return this->SumFeatures( m_Map.begin()->first, m_Map.rbegin()->first, m_Map.begin(), m_Map.end() );
+    }
+
     using MapType = typename std::map< TInputPixel, size_t >;
 
     MapType       m_Map;
-    size_t        m_Count;
+  };
+
+
+/* \class FirstOrderTextureHistogram
+ *
+ * Specialization of FirstOrderTextureHistogram for 8 and 16 bit
+ * integral pixel types. The counts are stored in a vector covering
+ * the whole range of the pixel type, and the range of the pixel
+ * values in the histogram is tracked while adding and removing
+ * pixels.
+ *
+ * \ingroup ITKTextureFeatures
+ */
+template< class TInputPixel, class TOutputPixel >
+class ITK_TEMPLATE_EXPORT FirstOrderTextureHistogram< TInputPixel, TOutputPixel, true >:
+  public FirstOrderTextureMoments< TInputPixel, TOutputPixel >
+{
+public:
+
+  FirstOrderTextureHistogram() :
+    m_Counts( ToIndex( std::numeric_limits< TInputPixel >::max() ) + 1, 0 ),
+    m_Minimum( 0 ),
+    m_Maximum( 0 )
+    {
+    }
+
+  void AddPixel(const TInputPixel & p)
+  {
+    const size_t index = ToIndex( p );
+    if ( this->m_Count == 0 )
+      {
+      m_Minimum = index;
+      m_Maximum = index;
+      }
+    else if ( index < m_Minimum )
+      {
+      m_Minimum = index;
+      }
+    else if ( index > m_Maximum )
+      {
+      m_Maximum = index;
+      }
+    this->AddMoments( p, m_Counts[index] );
+    ++m_Counts[index];
+  }
+
+  void RemovePixel(const TInputPixel & p)
+  {
+    const size_t index = ToIndex( p );
+
+    assert( m_Counts[index] > 0 );
+
+    this->RemoveMoments( p, m_Counts[index] );
+    if ( --m_Counts[index] == 0 && this->m_Count > 0 )
+      {
+      // shrink the range to the remaining pixel values
+      while ( m_Counts[m_Minimum] == 0 )
+        {
+        ++m_Minimum;
+        }
+      while ( m_Counts[m_Maximum] == 0 )
+        {
+        --m_Maximum;
+        }
+      }
+  }
+
+  /** Remove all the pixels, only visiting the counts of the range of
+   * their values. */
+  void Clear()
+  {
+    if ( this->m_Count > 0 )
+      {
+      std::fill( m_Counts.begin() + m_Minimum, m_Counts.begin() + m_Maximum + 1, 0 );
+      }
+    this->ResetMoments();
+  }
+
+  TOutputPixel GetValue(const TInputPixel &)
+  {
+    return this->ComputeValue( std::integral_constant< bool, ExactMoments >() );
+  }
+
+  void AddBoundary(){}
+
+  void RemoveBoundary(){}
+
+private:
+    static constexpr bool ExactMoments = FirstOrderTextureExactMomentsTraits< TInputPixel >::Exact;
+
+    /** Iterator over the bins of the range of the pixel values, giving
+     * pairs of a pixel value and a frequency. */
+    class BinIterator
+    {
+    public:
+      BinIterator(const std::vector< size_t > & counts, const size_t index) :
+        m_Counts( &counts ),
+        m_Index( index )
+        {
+        }
+
+      const std::pair< TInputPixel, size_t > * operator->() const
+      {
+        m_Bin = std::make_pair( FromIndex( m_Index ), ( *m_Counts )[m_Index] );
+        return &m_Bin;
+      }
+
+      BinIterator & operator++()
+      {
+        ++m_Index;
+        return *this;
+      }
+
+      bool operator!=(const BinIterator & other) const { return m_Index != other.m_Index; }
+
+    private:
+      const std::vector< size_t > *              m_Counts;
+      size_t                                     m_Index;
+      mutable std::pair< TInputPixel, size_t >   m_Bin;
+    };
+
+    TOutputPixel ComputeValue(std::true_type)
+    {
+      return this->GetFeatures( FromIndex( m_Minimum ), FromIndex( m_Maximum ) );
+    }
+
+    TOutputPixel ComputeValue(std::false_type)
+    {
+      return this->SumFeatures( FromIndex( m_Minimum ), FromIndex( m_Maximum ),
+                                BinIterator( m_Counts, m_Minimum ), BinIterator( m_Counts, m_Maximum + 1 ) );
+    }
+
+    static size_t ToIndex(const TInputPixel & p)
+    {
+      return static_cast< size_t >( static_cast< long >( p ) - static_cast< long >( std::numeric_limits< TInputPixel >::min() ) );
+    }
+
+    static TInputPixel FromIndex(const size_t index)
+    {
+      return static_cast< TInputPixel >( static_cast< long >( index ) + static_cast< long >( std::numeric_limits< TInputPixel >::min() ) );
+    }
+
+    using CountsType = typename std::vector< size_t >;
+
+    CountsType    m_Counts;
+    size_t        m_Minimum;
+    size_t        m_Maximum;
   };
 
 } // end namespace Function
@@ -18,9 +18,10 @@
 #ifndef itkRunLengthTextureFeaturesImageFilter_h
 #define itkRunLengthTextureFeaturesImageFilter_h
 
-#include "itkImageToImageFilter.h"
+#include "itkTextureFeaturesImageFilterBase.h"
 #include "itkScalarImageToRunLengthMatrixFilter.h"
-#include "itkConstNeighborhoodIterator.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -36,7 +37,8 @@ namespace Statistics
  * (of the specified neighborhood) from a N-D scalar image.
  * The run length features are computed from joint histograms of
  * pixel intensities and distance (run length) per spatial direction
- * then averaged afterward.
+ * then averaged afterward. With PerOffsetFeatures on, the features of each
+ * direction are also kept, in the same pass over the image.
  *
  * The result obtained is a possible texture description. See the following references.
  * M. M. Galloway. Texture analysis using gray level run lengths. Computer
@@ -58,9 +60,13 @@ namespace Statistics
  * -# An image
  * -# A mask defining the region over which texture features will be
  *    calculated. (Optional)
+ * -# The image digitized by a DigitizerImageFilter. (Optional, computed from
+ *    the image and the mask by default.)
  * -# The pixel value that defines the "inside" of the mask. (Optional, defaults
  *    to 1 if a mask is set.)
- * -# The number of intensity bins. (Optional, defaults to 256.)
+ * -# The number of intensity bins. (Optional, defaults to 256, at most 65534.)
+ * -# The numbers of bins of coarser quantizations computed from the same
+ *    digitization. (Optional, defaults to none.)
  * -# The set of directions (offsets) to average across. (Optional, defaults to
  *    {(-1, 0), (-1, -1), (0, -1), (1, -1)} for 2D images and scales analogously
  *    for ND images.)
@@ -70,7 +76,20 @@ namespace Statistics
  * -# The distance range for the joint histogram over which the
  *    features will be calculated. (Optional, defaults to the full
  *    dynamic range of double type.)
- * -# The size of the neighborhood radius. (Optional, defaults to 2.)
+ * -# The size of the neighborhood radius, or the radii of nested
+ *    neighborhoods. (Optional, defaults to 2.)
+ * -# Whether the neighborhoods holding a single digitized value are detected
+ *    beforehand, to compute their features once per value. (Optional,
+ *    defaults to true.)
+ * -# Whether the neighborhoods entirely inside of the mask and in range are
+ *    detected beforehand, to look for their runs without testing their
+ *    values. (Optional, defaults to true.)
+ * -# The subset of the features to compute. (Optional, defaults to all.)
+ * -# Whether only the features of the voxels inside of the mask are
+ *    computed, into the compact output instead of the image output.
+ *    (Optional, defaults to false.)
+ * -# Whether the features are also computed for each offset separately.
+ *    (Optional, defaults to false.)
  *
  * Recommendations:
  * -# Input image: To improve the computation time, the useful data should take as much
@@ -86,6 +105,8 @@ namespace Statistics
  * -# Distance range: For better results the distance range should be adapted to the spacing of the input image
  *    and the size of the neighborhood.
  *
+ * \sa TextureFeaturesImageFilterBase
+ * \sa DigitizerImageFilter
  * \sa ScalarImageToRunLengthFeaturesFilter
  * \sa ScalarImageToRunLengthMatrixFilter
  * \sa HistogramToRunLengthFeaturesFilter
@@ -98,56 +119,57 @@ template< typename TInputImage,
           typename TOutputImage,
           typename TMaskImage = Image< unsigned char, TInputImage::ImageDimension> >
 class ITK_TEMPLATE_EXPORT RunLengthTextureFeaturesImageFilter
-  : public ImageToImageFilter< TInputImage, TOutputImage >
+  : public TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >
 {
 public:
   /** Standard type alias */
   using Self = RunLengthTextureFeaturesImageFilter;
-  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Superclass = TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >;
   using Pointer = SmartPointer< Self >;
   using ConstPointer = SmartPointer< const Self >;
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(RunLengthTextureFeaturesImageFilter, ImageToImageFilter);
+  itkTypeMacro(RunLengthTextureFeaturesImageFilter, TextureFeaturesImageFilterBase);
 
   /** standard New() method support */
   itkNewMacro(Self);
 
-  using InputImageType = TInputImage;
-  using OutputImageType = TOutputImage;
-  using MaskImageType = TMaskImage;
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using MaskImageType = typename Superclass::MaskImageType;
 
-  using PixelType = typename InputImageType::PixelType;
-  using MaskPixelType = typename MaskImageType::PixelType;
-  using IndexType = typename InputImageType::IndexType;
-  using PointType = typename InputImageType::PointType;
+  using PixelType = typename Superclass::PixelType;
+  using MaskPixelType = typename Superclass::MaskPixelType;
+  using IndexType = typename Superclass::IndexType;
+  using PointType = typename Superclass::PointType;
 
-  using OffsetType = typename InputImageType::OffsetType;
-  using OffsetVector = VectorContainer< unsigned char, OffsetType >;
-  using OffsetVectorPointer = typename OffsetVector::Pointer;
-  using OffsetVectorConstPointer = typename OffsetVector::ConstPointer;
+  using OffsetType = typename Superclass::OffsetType;
+  using OffsetVector = typename Superclass::OffsetVector;
+  using OffsetVectorPointer = typename Superclass::OffsetVectorPointer;
+  using OffsetVectorConstPointer = typename Superclass::OffsetVectorConstPointer;
 
-  using InputRegionType = typename InputImageType::RegionType;
-  using OutputRegionType = typename OutputImageType::RegionType;
+  using InputRegionType = typename Superclass::InputRegionType;
+  using OutputRegionType = typename Superclass::OutputRegionType;
 
-  using NeighborhoodRadiusType = typename itk::ConstNeighborhoodIterator< InputImageType >::RadiusType;
+  using NeighborhoodRadiusType = typename Superclass::NeighborhoodRadiusType;
 
-  using MeasurementType = typename NumericTraits<PixelType>::RealType;
-  using RealType = typename NumericTraits<PixelType>::RealType;
+  using MeasurementType = typename Superclass::MeasurementType;
+  using RealType = typename Superclass::RealType;
 
   /** Method to set/get the Neighborhood radius */
   itkSetMacro(NeighborhoodRadius, NeighborhoodRadiusType);
   itkGetConstMacro(NeighborhoodRadius, NeighborhoodRadiusType);
 
-  /** Method to set the mask image */
-  itkSetInputMacro(MaskImage, MaskImageType);
-
-  /** Method to get the mask image */
-  itkGetInputMacro(MaskImage, MaskImageType);
-
-
-  /** Specify the default number of bins per axis */
-  static constexpr unsigned int DefaultBinsPerAxis = 256;
+  /** Set/Get the radii of nested neighborhoods, whose features are all
+   * computed in the same pass over the image. When not empty,
+   * NeighborhoodRadius is ignored and the output pixels hold the selected
+   * features of each radius in turn. Each radius must be at least the
+   * previous one along every dimension. The runs are cut at the boundary of
+   * each neighborhood, so they are looked for in each of them. The output
+   * must be a VectorImage when several radii are set. Empty by default. */
+  using NeighborhoodRadiusVectorType = std::vector< NeighborhoodRadiusType >;
+  void SetNeighborhoodRadii( const NeighborhoodRadiusVectorType & radii );
+  itkGetConstReferenceMacro(NeighborhoodRadii, NeighborhoodRadiusVectorType);
 
   /**
    * Set the offsets over which the intensity/distance pairs will be computed.
@@ -176,11 +198,18 @@ public:
    */
   itkGetModifiableObjectMacro(Offsets, OffsetVector );
 
-  /** Set number of histogram bins along each axis */
-  itkSetMacro( NumberOfBinsPerAxis, unsigned int );
-
-  /** Get number of histogram bins along each axis */
-  itkGetConstMacro( NumberOfBinsPerAxis, unsigned int );
+  /** Set/Get the numbers of bins of coarser quantizations whose features are
+   * computed in the same pass over the image. Each of them must divide
+   * NumberOfBinsPerAxis: the input is only digitized with NumberOfBinsPerAxis
+   * bins, and the digitized values of a coarser level are derived by integer
+   * division. Merging bins can merge runs, so the runs of each level are
+   * looked for in the same neighborhood, read once. The output pixels hold
+   * the selected features of NumberOfBinsPerAxis bins followed by the ones of
+   * each coarser level, so the output must be a VectorImage when coarser
+   * levels are set. Empty by default. */
+  using NumberOfBinsVectorType = std::vector< unsigned int >;
+  void SetCoarserNumbersOfBinsPerAxis( const NumberOfBinsVectorType & numbersOfBins );
+  itkGetConstReferenceMacro(CoarserNumbersOfBinsPerAxis, NumberOfBinsVectorType);
 
   /** Set/Get the minimum (inclusive) pixel value defining one dimension of the joint
    * value distance histogram. */
@@ -207,59 +236,263 @@ public:
   itkGetConstMacro( HistogramDistanceMaximum, RealType );
   itkSetMacro( HistogramDistanceMaximum, RealType);
 
-  /**
-   * Set the pixel value of the mask that should be considered "inside" the
-   * object. Defaults to 1.
-   */
-  itkSetMacro( InsidePixelValue, MaskPixelType );
-  itkGetConstMacro( InsidePixelValue, MaskPixelType );
-
-  using OutputPixelType = typename OutputImageType::PixelType;
-  using OutputRealType = typename NumericTraits< OutputPixelType >::ScalarRealType;
-
-#ifdef ITK_USE_CONCEPT_CHECKING
-  // Begin concept checking
-  itkConceptMacro( OutputPixelTypeCheck,
-                   ( Concept::IsFloatingPoint< OutputRealType > ) );
-  // End concept checking
-#endif
+  /** Set/Get whether the voxels whose neighborhood holds a single digitized
+   * value are detected beforehand, with a moving minimum and maximum of the
+   * digitized image. The runs of such a neighborhood all have this value and
+   * span the neighborhood along their offset, so their distance bins are
+   * counted once, and the features are computed once per value instead of
+   * from the runs of each neighborhood. The results are identical. Only used
+   * when NeighborhoodRadii, PerOffsetFeatures and CoarserNumbersOfBinsPerAxis
+   * are not set. On by default. */
+  itkSetMacro(DetectUniformNeighborhoods, bool);
+  itkGetConstMacro(DetectUniformNeighborhoods, bool);
+  itkBooleanMacro(DetectUniformNeighborhoods);
+
+  /** Set/Get whether the voxels whose neighborhood is entirely inside of the
+   * mask and in range are detected beforehand, with the same moving maximum
+   * of the digitized image. The runs of their neighborhood are then looked
+   * for without testing whether their voxels are inside of the mask and in
+   * range, which is only done near the border of the mask or of the
+   * intensity range. The results are identical. On by default. */
+  itkSetMacro(DetectInRangeNeighborhoods, bool);
+  itkGetConstMacro(DetectInRangeNeighborhoods, bool);
+  itkBooleanMacro(DetectInRangeNeighborhoods);
+
+  /** Bits of the run length features in FeatureMask, in the order of the
+   * components of the output pixels. */
+  enum FeatureBitType
+    {
+    ShortRunEmphasisFeature = 1 << 0,
+    LongRunEmphasisFeature = 1 << 1,
+    GreyLevelNonuniformityFeature = 1 << 2,
+    RunLengthNonuniformityFeature = 1 << 3,
+    LowGreyLevelRunEmphasisFeature = 1 << 4,
+    HighGreyLevelRunEmphasisFeature = 1 << 5,
+    ShortRunLowGreyLevelEmphasisFeature = 1 << 6,
+    ShortRunHighGreyLevelEmphasisFeature = 1 << 7,
+    LongRunLowGreyLevelEmphasisFeature = 1 << 8,
+    LongRunHighGreyLevelEmphasisFeature = 1 << 9,
+    AllFeatures = ( 1 << 10 ) - 1
+    };
+
+  /** Set/Get the features to compute, as a combination of FeatureBitType.
+   * The output pixels only hold the selected features, in the order of their
+   * bits, and the accumulations of the other ones are skipped. Defaults to
+   * AllFeatures. */
+  itkSetMacro(FeatureMask, unsigned int);
+  itkGetConstMacro(FeatureMask, unsigned int);
+
+  /** Number of selected features. */
+  unsigned int GetNumberOfFeatures() const;
+
+  /** Set/Get whether a run length histogram is also accumulated for each
+   * offset, from the same runs and in the same pass over the neighborhoods
+   * as the pooled one. The output pixels then hold the selected features of
+   * the pooled histogram, when PooledFeatures is on, followed by the ones of
+   * the histogram of each offset, in the order of Offsets. The output must be
+   * a VectorImage, an exception is thrown when its pixels have a fixed
+   * length, and SeparateFeatureOutputs must be off. Off by default. */
+  itkSetMacro(PerOffsetFeatures, bool);
+  itkGetConstMacro(PerOffsetFeatures, bool);
+  itkBooleanMacro(PerOffsetFeatures);
+
+  /** Set/Get whether the features of the pooled histogram of all the offsets
+   * are computed when PerOffsetFeatures is on. They always are otherwise. On
+   * by default. */
+  itkSetMacro(PooledFeatures, bool);
+  itkGetConstMacro(PooledFeatures, bool);
+  itkBooleanMacro(PooledFeatures);
+
+  /** Number of components of the output pixels: the number of selected
+   * features, times the number of offsets plus one for the pooled features
+   * when PerOffsetFeatures is on, times the number of NeighborhoodRadii
+   * when they are set, or times one plus the number of
+   * CoarserNumbersOfBinsPerAxis. */
+  unsigned int GetNumberOfOutputComponents() const override;
+
+  using OutputPixelType = typename Superclass::OutputPixelType;
+  using OutputRealType = typename Superclass::OutputRealType;
+  using CompactFeaturesType = typename Superclass::CompactFeaturesType;
+  using ScalarFeatureImageType = typename Superclass::ScalarFeatureImageType;
 
 protected:
 
-  using HistogramIndexType = int;
-  using DigitizedImageType = itk::Image< HistogramIndexType, TInputImage::ImageDimension >;
-  using NeighborhoodIteratorType = typename itk::ConstNeighborhoodIterator< DigitizedImageType >;
-  using NeighborIndexType = typename NeighborhoodIteratorType::NeighborIndexType;
+  using NarrowDigitizedImageType = typename Superclass::NarrowDigitizedImageType;
+  using WideDigitizedImageType = typename Superclass::WideDigitizedImageType;
+  using NeighborIndexType = typename Superclass::NeighborIndexType;
+  using RegionVectorType = typename Superclass::RegionVectorType;
+  using FeatureImagesType = typename Superclass::FeatureImagesType;
+
+  /** Number of features when all of them are selected, i.e. of per feature
+   * outputs. */
+  static constexpr unsigned int MaximumNumberOfFeatures = 10;
 
   RunLengthTextureFeaturesImageFilter();
   ~RunLengthTextureFeaturesImageFilter() override {}
 
   void NormalizeOffsetDirection(OffsetType &offset);
   bool IsInsideNeighborhood(const OffsetType &iteratedOffset);
+  static bool IsInsideNeighborhood(const OffsetType &iteratedOffset, const NeighborhoodRadiusType &radius);
+
+  /** Radius of the neighborhood read around each voxel: the last of
+   * NeighborhoodRadii when they are set, NeighborhoodRadius otherwise. */
+  const NeighborhoodRadiusType & GetLargestNeighborhoodRadius() const override;
+
+  /** The intensity range is the value range of the joint histogram. */
+  PixelType GetDigitizerMinimum() const override { return m_HistogramValueMinimum; }
+  PixelType GetDigitizerMaximum() const override { return m_HistogramValueMaximum; }
+
+  /** Compute the normalized offsets and, for each of them and each window,
+   * the neighborhood indices of the next and previous voxels of each
+   * neighborhood index. The windows are the nested neighborhoods of
+   * NeighborhoodRadii, or the whole neighborhood when they are not set. */
+  void ComputeNextNeighborIndices();
+
+  /** Compute the neighbor indices and the distance bins, once the input is
+   * digitized. */
+  void ComputeNeighborhoodTables();
+
+  /** Compute, for each quantization level and each normalized offset, the
+   * distance bin of the runs of each number of pixels. */
+  void ComputeDistanceBins();
+
+  /** Count the runs of the whole neighborhood in each distance bin when it
+   * holds a single value, once the distance bins are computed. */
+  void ComputeUniformRuns();
+
+  /** Number of bins of the quantization level of index level: 0 for
+   * NumberOfBinsPerAxis, then each of CoarserNumbersOfBinsPerAxis. */
+  unsigned int GetLevelNumberOfBins( unsigned int level ) const;
+
   void IncreaseHistogram(vnl_matrix<unsigned int> &hist, unsigned int &totalNumberOfRuns,
-                          const HistogramIndexType &currentInNeighborhoodPixelIntensity,
-                          const OffsetType &offset, const unsigned int &pixelDistance);
+                          const unsigned int &currentInNeighborhoodPixelIntensity,
+                          const unsigned int &offsetDistanceBin);
   void ComputeFeatures( vnl_matrix<unsigned int> &hist, const unsigned int &totalNumberOfRuns,
                        typename TOutputImage::PixelType &outputPixel);
   void PrintSelf( std::ostream & os, Indent indent ) const override;
 
-  /** This method causes the filter to generate its output. */
+  /** Check that the feature mask and the options computing several sets of
+   * features are compatible. */
+  void VerifyPreconditions() ITKv5_CONST override;
+
+  /** Digitize the input, then compute the neighborhood tables. */
   void BeforeThreadedGenerateData() override;
   void AfterThreadedGenerateData() override;
-  void DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread ) override;
-  void GenerateOutputInformation() override;
+
+  double EstimateInsideVoxelCost() const override;
+
+  /** The voxels whose neighborhood is uniform or in range are located when
+   * they are used: DetectInRangeNeighborhoods is on, or
+   * DetectUniformNeighborhoods is on and the features are only computed
+   * from one run length histogram. */
+  bool UsesUniformNeighborhoodsTable() const override;
+
+  /** Whether the features of the uniform neighborhoods are computed once per
+   * value: DetectUniformNeighborhoods is on, and NeighborhoodRadii,
+   * PerOffsetFeatures and CoarserNumbersOfBinsPerAxis are not set. */
+  bool UsesUniformNeighborhoods() const;
+
+  /** Compute the features of the regions with DispatchRegionsFeatures. */
+  void ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output ) override;
+
+  /** Compute the features of the regions into the output, an image, the
+   * compact output or the scalar images of the features, from the narrow or
+   * wide digitized image. */
+  template< typename TOutput >
+  void DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output );
+
+  /** Compute the features of the regions from the digitized image. */
+  template< typename TOutput, typename TDigitizedImage >
+  void ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                                const TDigitizedImage * digitizedImage );
+
+  /** Compute the features of the voxel at the center of the
+   * TextureNeighborhoodKernel over the digitized image, from the runs of the
+   * window of index window at the quantization level of index level.
+   * histogram is a scratch buffer of the work unit, with the number of bins
+   * of the level along each axis. */
+  template< typename TNeighborhoodIterator >
+  void ComputeVoxelFeatures( const TNeighborhoodIterator & inputNIt,
+                             vnl_matrix<unsigned int> & histogram,
+                             typename TOutputImage::PixelType & outputPixel,
+                             unsigned int window = 0,
+                             unsigned int level = 0 );
+
+  /** Compute the features of the voxel for each offset, from the scratch
+   * buffer offsetHistogram, and the pooled ones from histogram when
+   * PooledFeatures is on. featurePixel is a scratch pixel of
+   * the length of the output pixels. */
+  template< typename TNeighborhoodIterator >
+  void ComputeVoxelOffsetFeatures( const TNeighborhoodIterator & inputNIt,
+                                   vnl_matrix<unsigned int> & histogram,
+                                   vnl_matrix<unsigned int> & offsetHistogram,
+                                   typename TOutputImage::PixelType & featurePixel,
+                                   typename TOutputImage::PixelType & outputPixel );
+
+  /** Call visitor( intensity, distanceBin ) for each run of the window of
+   * index window along the normalized offset of index o, at the quantization
+   * level of index level. */
+  template< typename TNeighborhoodIterator, typename TVisitor >
+  void VisitRuns( const TNeighborhoodIterator & inputNIt, unsigned int window, unsigned int o,
+                  const TVisitor & visitor, unsigned int level = 0 ) const;
+
+  /** VisitRuns on the digitized values mapped by quantize( value ), with the
+   * distance bins of the quantization level. The voxels outside of the mask
+   * or out of range are only skipped when TCheckRange is std::true_type,
+   * i.e. when the neighborhood is not known to be in range. */
+  template< typename TNeighborhoodIterator, typename TQuantizer, typename TVisitor, typename TCheckRange >
+  void VisitQuantizedRuns( const TNeighborhoodIterator & inputNIt, unsigned int window, unsigned int o,
+                           const unsigned int * distanceBins, const TQuantizer & quantize,
+                           const TVisitor & visitor, TCheckRange checkRange ) const;
 
 private:
-  typename DigitizedImageType::Pointer  m_DigitizedInputImage;
+  template< typename, typename, typename > friend class TextureFeatureBankImageFilter;
+
   NeighborhoodRadiusType                m_NeighborhoodRadius;
+  NeighborhoodRadiusVectorType          m_NeighborhoodRadii;
   OffsetVectorPointer                   m_Offsets;
-  unsigned int                          m_NumberOfBinsPerAxis;
+  NumberOfBinsVectorType                m_CoarserNumbersOfBinsPerAxis;
   PixelType                             m_HistogramValueMinimum;
   PixelType                             m_HistogramValueMaximum;
   RealType                              m_HistogramDistanceMinimum;
   RealType                              m_HistogramDistanceMaximum;
-  MaskPixelType                         m_InsidePixelValue;
+  unsigned int                          m_FeatureMask;
+  bool                                  m_PerOffsetFeatures;
+  bool                                  m_PooledFeatures;
+  bool                                  m_DetectUniformNeighborhoods;
+  bool                                  m_DetectInRangeNeighborhoods;
   typename TInputImage::SpacingType     m_Spacing;
+
+  /** Offsets with their rightmost non-zero element made positive */
+  std::vector< OffsetType >             m_NormalizedOffsets;
+
+  /** For each window and each normalized offset, the neighborhood index
+   * following each neighborhood index along the offset, or the neighborhood
+   * size when it falls outside of the window. */
+  std::vector< NeighborIndexType >      m_NextNeighborIndices;
+
+  /** For each window and each normalized offset, the neighborhood index
+   * preceding each neighborhood index along the offset, laid out as
+   * m_NextNeighborIndices. Used to detect the voxels starting a run. */
+  std::vector< NeighborIndexType >      m_PreviousNeighborIndices;
+  NeighborIndexType                     m_NeighborhoodSize;
+
+  /** For each window, the neighborhood indices of its voxels. */
+  std::vector< std::vector< NeighborIndexType > > m_WindowNeighborIndices;
+
+  /** For each quantization level and each normalized offset, the distance
+   * bin of a run indexed by its number of pixels after the first one, or the
+   * number of bins of the level when the run length is out of the histogram
+   * range. */
+  std::vector< unsigned int >           m_DistanceBins;
+  SizeValueType                         m_NumberOfDistanceBinsPerOffset;
+
+  /** Number of runs of a uniform neighborhood in each distance bin, at
+   * NumberOfBinsPerAxis, and their total in the histogram range. */
+  std::vector< unsigned int >           m_UniformRunCounts;
+  unsigned int                          m_UniformNumberOfRuns;
 };
 } // end of namespace Statistics
 } // end of namespace itk
@@ -19,10 +19,11 @@
 #define itkRunLengthTextureFeaturesImageFilter_hxx
 
 #include "itkRunLengthTextureFeaturesImageFilter.h"
-#include "itkRegionOfInterestImageFilter.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkBinaryFunctorImageFilter.h"
-#include "itkDigitizerFunctor.h"
+#include "itkTextureNeighborhoodKernel.h"
+
+#include <algorithm>
+#include <bitset>
+#include <type_traits>
 
 namespace itk
 {
@@ -31,23 +32,16 @@ namespace Statistics
 template< typename TInputImage, typename TOutputImage, typename TMaskImage>
 RunLengthTextureFeaturesImageFilter< TInputImage, TOutputImage, TMaskImage>
 ::RunLengthTextureFeaturesImageFilter() :
-    m_NumberOfBinsPerAxis( itkGetStaticConstMacro( DefaultBinsPerAxis ) ),
+    Superclass( MaximumNumberOfFeatures ),
     m_HistogramValueMinimum( NumericTraits<PixelType>::NonpositiveMin() ),
     m_HistogramValueMaximum( NumericTraits<PixelType>::max() ),
     m_HistogramDistanceMinimum( NumericTraits<RealType>::ZeroValue() ),
     m_HistogramDistanceMaximum( NumericTraits<RealType>::max() ),
-    m_InsidePixelValue( NumericTraits<MaskPixelType>::OneValue() ),
-    m_Spacing( 1.0 )
+    m_Spacing( 1.0 ),
+    m_NeighborhoodSize( 0 ),
+    m_NumberOfDistanceBinsPerOffset( 0 ),
+    m_UniformNumberOfRuns( 0 )
 {
-  this->SetNumberOfRequiredInputs( 1 );
-  this->SetNumberOfRequiredOutputs( 1 );
-
-  // Mark the "MaskImage" as an optional named input. First it has to
-  // be added to the list of named inputs then removed from the
-  // required list.
-  Self::AddRequiredInputName("MaskImage");
-  Self::RemoveRequiredInputName("MaskImage");
-
   // Set the offset directions to their defaults: half of all the possible
   // directions 1 pixel away. (The other half is included by symmetry.)
   // We use a neighborhood iterator to calculate the appropriate offsets.
@@ -69,7 +63,11 @@ RunLengthTextureFeaturesImageFilter< TInputImage, TOutputImage, TMaskImage>
   NeighborhoodType nhood;
   nhood.SetRadius( 2 );
   this->m_NeighborhoodRadius = nhood.GetRadius( );
-  this->DynamicMultiThreadingOn();
+  this->m_FeatureMask = AllFeatures;
+  this->m_PerOffsetFeatures = false;
+  this->m_PooledFeatures = true;
+  this->m_DetectUniformNeighborhoods = true;
+  this->m_DetectInRangeNeighborhoods = true;
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
@@ -85,122 +83,298 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::BeforeThreadedGenerateData()
+::SetNeighborhoodRadii( const NeighborhoodRadiusVectorType & radii )
 {
+  if( m_NeighborhoodRadii != radii )
+    {
+    m_NeighborhoodRadii = radii;
+    this->Modified();
+    }
+}
 
-  typename TInputImage::Pointer input = InputImageType::New();
-  input->Graft(const_cast<TInputImage *>(this->GetInput()));
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::SetCoarserNumbersOfBinsPerAxis( const NumberOfBinsVectorType & numbersOfBins )
+{
+  if( m_CoarserNumbersOfBinsPerAxis != numbersOfBins )
+    {
+    m_CoarserNumbersOfBinsPerAxis = numbersOfBins;
+    this->Modified();
+    }
+}
 
-  using DigitizerFunctorType = Digitizer<PixelType,
-                      PixelType,
-                      typename DigitizedImageType::PixelType>;
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetLevelNumberOfBins( unsigned int level ) const
+{
+  return level == 0 ? this->GetNumberOfBinsPerAxis() : m_CoarserNumbersOfBinsPerAxis[level - 1];
+}
 
-  DigitizerFunctorType digitalizer(m_NumberOfBinsPerAxis, m_InsidePixelValue, m_HistogramValueMinimum, m_HistogramValueMaximum);
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+const typename RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>::NeighborhoodRadiusType &
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetLargestNeighborhoodRadius() const
+{
+  return m_NeighborhoodRadii.empty() ? m_NeighborhoodRadius : m_NeighborhoodRadii.back();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetNumberOfFeatures() const
+{
+  return static_cast< unsigned int >( std::bitset< 10 >( m_FeatureMask ).count() );
+}
 
-  using FilterType = BinaryFunctorImageFilter< MaskImageType, InputImageType, DigitizedImageType, DigitizerFunctorType>;
-  typename FilterType::Pointer filter = FilterType::New();
-  if (this->GetMaskImage() != nullptr)
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetNumberOfOutputComponents() const
+{
+  if( !m_NeighborhoodRadii.empty() )
     {
-    typename TMaskImage::Pointer mask = MaskImageType::New();
-    mask->Graft(const_cast<TMaskImage *>(this->GetMaskImage()));
-    filter->SetInput1(mask);
+    return this->GetNumberOfFeatures() * static_cast< unsigned int >( m_NeighborhoodRadii.size() );
     }
-  else
+  if( !m_CoarserNumbersOfBinsPerAxis.empty() )
+    {
+    return this->GetNumberOfFeatures() * static_cast< unsigned int >( 1 + m_CoarserNumbersOfBinsPerAxis.size() );
+    }
+  if( !m_PerOffsetFeatures )
+    {
+    return this->GetNumberOfFeatures();
+    }
+  const auto numberOfHistograms = static_cast< unsigned int >( m_Offsets->Size() ) + ( m_PooledFeatures ? 1 : 0 );
+  return this->GetNumberOfFeatures() * numberOfHistograms;
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VerifyPreconditions() ITKv5_CONST
+{
+  Superclass::VerifyPreconditions();
+
+  if( m_FeatureMask == 0 || ( m_FeatureMask & ~static_cast< unsigned int >( AllFeatures ) ) != 0 )
+    {
+    itkExceptionMacro( "FeatureMask is " << m_FeatureMask << " but must select at least one of the "
+                       "features of FeatureBitType" );
+    }
+  if( m_PerOffsetFeatures && this->GetSeparateFeatureOutputs() )
+    {
+    itkExceptionMacro( "PerOffsetFeatures and SeparateFeatureOutputs cannot be both on" );
+    }
+  if( m_PerOffsetFeatures && !m_PooledFeatures && m_Offsets->Size() == 0 )
+    {
+    itkExceptionMacro( "PerOffsetFeatures needs at least one offset when PooledFeatures is off" );
+    }
+  if( !m_NeighborhoodRadii.empty() && ( m_PerOffsetFeatures || this->GetSeparateFeatureOutputs() ) )
+    {
+    itkExceptionMacro( "NeighborhoodRadii cannot be set when PerOffsetFeatures or SeparateFeatureOutputs is on" );
+    }
+  for( unsigned int k = 1; k < m_NeighborhoodRadii.size(); ++k )
+    {
+    for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+      {
+      if( m_NeighborhoodRadii[k][d] < m_NeighborhoodRadii[k - 1][d] )
+        {
+        itkExceptionMacro( "NeighborhoodRadii must be nested, but radius " << m_NeighborhoodRadii[k]
+                           << " is smaller than " << m_NeighborhoodRadii[k - 1] );
+        }
+      }
+    }
+  if( !m_CoarserNumbersOfBinsPerAxis.empty()
+      && ( !m_NeighborhoodRadii.empty() || m_PerOffsetFeatures || this->GetSeparateFeatureOutputs() ) )
     {
-    filter->SetConstant1(m_InsidePixelValue);
+    itkExceptionMacro( "CoarserNumbersOfBinsPerAxis cannot be set when NeighborhoodRadii are set or "
+                       "PerOffsetFeatures or SeparateFeatureOutputs is on" );
     }
-  filter->SetInput2(input);
-  filter->SetFunctor(digitalizer);
-  filter->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  for( const unsigned int numberOfBins : m_CoarserNumbersOfBinsPerAxis )
+    {
+    if( numberOfBins == 0 || this->GetNumberOfBinsPerAxis() % numberOfBins != 0 )
+      {
+      itkExceptionMacro( "CoarserNumbersOfBinsPerAxis must divide NumberOfBinsPerAxis "
+                         << this->GetNumberOfBinsPerAxis() << ", but holds " << numberOfBins );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
 
-  filter->Update();
-  m_DigitizedInputImage = filter->GetOutput();
+  this->ComputeNeighborhoodTables();
+}
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeNeighborhoodTables()
+{
   m_Spacing = this->GetInput()->GetSpacing();
+
+  this->ComputeNextNeighborIndices();
+  this->ComputeDistanceBins();
+  this->ComputeUniformRuns();
 }
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::UsesUniformNeighborhoodsTable() const
+{
+  return m_DetectInRangeNeighborhoods || this->UsesUniformNeighborhoods();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::UsesUniformNeighborhoods() const
+{
+  return m_DetectUniformNeighborhoods && m_NeighborhoodRadii.empty() && !m_PerOffsetFeatures
+    && m_CoarserNumbersOfBinsPerAxis.empty();
+}
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
   void
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 ::AfterThreadedGenerateData()
 {
-  // free internal image
-  this->m_DigitizedInputImage = nullptr;
+  Superclass::AfterThreadedGenerateData();
+
+  this->m_NormalizedOffsets.clear();
+  this->m_NextNeighborIndices.clear();
+  this->m_PreviousNeighborIndices.clear();
+  this->m_WindowNeighborIndices.clear();
+  this->m_DistanceBins.clear();
+  this->m_UniformRunCounts.clear();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+double
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::EstimateInsideVoxelCost() const
+{
+  // Runs looked for from each voxel of each window, along each offset, at
+  // each quantization level
+  SizeValueType numberOfWindowVoxels = 0;
+  for( const std::vector< NeighborIndexType > & windowNeighborIndices : m_WindowNeighborIndices )
+    {
+    numberOfWindowVoxels += windowNeighborIndices.size();
+    }
+  return 1.0 + static_cast< double >( numberOfWindowVoxels ) * m_Offsets->size()
+    * ( 1 + m_CoarserNumbersOfBinsPerAxis.size() );
 }
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread )
+::ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output )
 {
-  // Get the inputs/outputs
-  TOutputImage * outputPtr = this->GetOutput();
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output )
+{
+  const auto * narrowDigitizedImage =
+    dynamic_cast< const NarrowDigitizedImageType * >( this->GetDigitizedInputImage() );
+  if( narrowDigitizedImage != nullptr )
+    {
+    this->ThreadedComputeFeatures( regions, output, narrowDigitizedImage );
+    }
+  else
+    {
+    this->ThreadedComputeFeatures( regions, output,
+      static_cast< const WideDigitizedImageType * >( this->GetDigitizedInputImage() ) );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput, typename TDigitizedImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                           const TDigitizedImage * digitizedImage )
+{
+  using DigitizedPixelType = typename TDigitizedImage::PixelType;
+  using NeighborhoodIteratorType = TextureNeighborhoodKernel< TDigitizedImage >;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
+
+  // Digitized value of the voxels outside of the mask
+  const DigitizedPixelType outsideMaskValue = DigitizerFunctorType::GetOutsideMaskValue();
 
   // Creation of the output pixel type
   typename TOutputImage::PixelType outputPixel;
-  NumericTraits<typename TOutputImage::PixelType>::SetLength(outputPixel, outputPtr->GetNumberOfComponentsPerPixel());
-
-  // Creation of a region with the same size as the neighborhood. This region
-  // will be used to check if each voxel has already been visited.
-  InputRegionType      boolRegion;
-  typename InputRegionType::IndexType boolStart;
-  typename InputRegionType::SizeType  boolSize;
-  IndexType            boolCurentInNeighborhoodIndex;
-  using BoolImageType = Image<bool, TInputImage::ImageDimension>;
-  typename BoolImageType::Pointer alreadyVisitedImage = BoolImageType::New();
-  for ( unsigned int i = 0; i < this->m_NeighborhoodRadius.Dimension; ++i )
-    {
-    boolSize[i] = this->m_NeighborhoodRadius[i]*2 + 1;
-    boolStart[i] = 0;
-    boolCurentInNeighborhoodIndex[i] = m_NeighborhoodRadius[i];
-    }
-  boolRegion.SetIndex(boolStart);
-  boolRegion.SetSize(boolSize);
-  alreadyVisitedImage->CopyInformation( this->m_DigitizedInputImage );
-  alreadyVisitedImage->SetRegions( boolRegion );
-  alreadyVisitedImage->Allocate();
-
-  // Separation of the non-boundary region that will be processed in a different way
-  NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< DigitizedImageType > boundaryFacesCalculator;
-  typename NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< DigitizedImageType >::FaceListType
-  faceList = boundaryFacesCalculator( this->m_DigitizedInputImage, outputRegionForThread, m_NeighborhoodRadius );
-  auto fit = faceList.begin();
-
-  // Declaration of the variables useful to iterate over the all image region
-  bool isInImage;
-  typename OffsetVector::ConstIterator offsets;
+  NumericTraits<typename TOutputImage::PixelType>::SetLength(outputPixel, output->GetNumberOfComponentsPerPixel());
 
-  // Declaration of the variables useful to iterate over the all the offsets
-  OffsetType offset;
-  unsigned int totalNumberOfRuns;
+  vnl_matrix<unsigned int> histogram(this->GetNumberOfBinsPerAxis(), this->GetNumberOfBinsPerAxis());
 
-  vnl_matrix<unsigned int> histogram(m_NumberOfBinsPerAxis, m_NumberOfBinsPerAxis);
+  // Features of a single histogram, written to their components of the
+  // output pixel. The output pixels hold GetNumberOfOutputComponents()
+  // components, checked by GenerateOutputInformation(), so a copy of
+  // outputPixel is large enough and is never resized here
+  typename TOutputImage::PixelType featurePixel( outputPixel );
 
+  // Histogram of the offset being processed
+  vnl_matrix<unsigned int> offsetHistogram;
+  if( m_NeighborhoodRadii.empty() && m_PerOffsetFeatures )
+    {
+    offsetHistogram.set_size( this->GetNumberOfBinsPerAxis(), this->GetNumberOfBinsPerAxis() );
+    }
 
-  // Declaration of the variables useful to iterate over the all neighborhood region
-  HistogramIndexType currentInNeighborhoodPixelIntensity;
+  // Histograms of the coarser quantizations
+  std::vector< vnl_matrix<unsigned int> > coarserHistograms;
+  for( const unsigned int numberOfBins : m_CoarserNumbersOfBinsPerAxis )
+    {
+    coarserHistograms.emplace_back( numberOfBins, numberOfBins );
+    }
 
-  // Declaration of the variables useful to iterate over the run
-  HistogramIndexType pixelIntensity( NumericTraits<HistogramIndexType>::ZeroValue() );
-  OffsetType iteratedOffset;
-  OffsetType tempOffset;
-  unsigned int pixelDistance;
-  bool insideNeighborhood;
+  // Features of the last value met in a uniform neighborhood
+  const bool detectUniformNeighborhoods =
+    !this->GetUniformNeighborhoods().IsEmpty() && this->UsesUniformNeighborhoods();
+  const bool detectInRangeNeighborhoods =
+    !this->GetUniformNeighborhoods().IsEmpty() && m_DetectInRangeNeighborhoods;
+  DigitizedPixelType uniformValue = outsideMaskValue;
+  typename TOutputImage::PixelType uniformPixel;
+  NumericTraits<typename TOutputImage::PixelType>::SetLength(uniformPixel, output->GetNumberOfComponentsPerPixel());
 
-  /// ***** Non-boundary Region *****
-  for (; fit != faceList.end(); ++fit )
+  for( const OutputRegionType & region : regions )
     {
-    NeighborhoodIteratorType inputNIt(m_NeighborhoodRadius, this->m_DigitizedInputImage, *fit );
-    using IteratorType = itk::ImageRegionIterator< OutputImageType>;
-    IteratorType outputIt( outputPtr, *fit );
+    // The halo of the digitized image holds all the neighborhoods of the region,
+    // they are read directly from its buffer
+    NeighborhoodIteratorType inputNIt(this->GetLargestNeighborhoodRadius(), digitizedImage, region );
+    using OutputIteratorType = typename TextureFeatureOutputIterator< TOutput >::Type;
+    OutputIteratorType outputIt( output, region );
 
     // Iteration over the all image region
     while( !inputNIt.IsAtEnd() )
       {
       // If the voxel is outside of the mask, don't treat it
-      if( inputNIt.GetCenterPixel() < ( - 5) ) //the pixel is outside of the mask
+      if( inputNIt.GetCenterPixel() == outsideMaskValue ) //the pixel is outside of the mask
         {
         outputPixel.Fill(0);
         outputIt.Set(outputPixel);
@@ -208,100 +382,254 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
         ++outputIt;
         continue;
         }
-      // Initialisation of the histogram
-      for(unsigned int a = 0; a < m_NumberOfBinsPerAxis; ++a)
+
+      if( detectUniformNeighborhoods && this->GetUniformNeighborhoods().IsUniform( inputNIt.GetIndex() ) )
         {
-        for(unsigned int b = 0; b < m_NumberOfBinsPerAxis; ++b)
+        // The histogram only holds the runs of the uniform neighborhood in
+        // the row of its value
+        if( inputNIt.GetCenterPixel() != uniformValue )
           {
-          histogram[a][b] = 0;
+          uniformValue = inputNIt.GetCenterPixel();
+          histogram.fill( 0 );
+          histogram.set_row( uniformValue, m_UniformRunCounts.data() );
+          this->ComputeFeatures( histogram, m_UniformNumberOfRuns, uniformPixel );
           }
+        outputIt.Set(uniformPixel);
+        ++inputNIt;
+        ++outputIt;
+        continue;
         }
-      totalNumberOfRuns = 0;
-      // Iteration over all the offsets
-      for( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); ++offsets )
+
+      // The voxels of a neighborhood in range all belong to a run
+      inputNIt.SetNeighborhoodInRange( detectInRangeNeighborhoods
+                                       && this->GetUniformNeighborhoods().IsInRange( inputNIt.GetIndex() ) );
+
+      // Compute the run length features
+      if( !m_NeighborhoodRadii.empty() )
         {
-        alreadyVisitedImage->FillBuffer( false );
-        offset = offsets.Value();
-        this->NormalizeOffsetDirection(offset);
-        // Iteration over the all neighborhood region
-        for(NeighborIndexType nb = 0; nb<inputNIt.Size(); ++nb)
+        // The features of each window are computed in turn from the same
+        // neighborhood
+        const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+        for( unsigned int window = 0; window < m_WindowNeighborIndices.size(); ++window )
           {
-          currentInNeighborhoodPixelIntensity =  inputNIt.GetPixel(nb);
-          tempOffset = inputNIt.GetOffset(nb);
-          // Checking if the value is out-of-bounds or is outside the mask.
-          if( currentInNeighborhoodPixelIntensity < 0 || // The pixel is outside of the mask or outside of bounds
-            alreadyVisitedImage->GetPixel( boolCurentInNeighborhoodIndex + tempOffset) )
+          this->ComputeVoxelFeatures( inputNIt, histogram, featurePixel, window );
+          for( unsigned int i = 0; i < numberOfFeatures; ++i )
             {
-            continue;
+            outputPixel[window * numberOfFeatures + i] = featurePixel[i];
             }
-          //Initialisation of the variables useful to iterate over the run
-          iteratedOffset = tempOffset + offset;
-          pixelDistance = 0;
-          insideNeighborhood = this->IsInsideNeighborhood(iteratedOffset);
-          // Scan from the iterated pixel at index, following the direction of
-          // offset. Run length is computed as the length of continuous pixel
-          // whose pixel values are in the same bin.
-          while ( insideNeighborhood )
+          }
+        }
+      else if( !coarserHistograms.empty() )
+        {
+        // The runs of each quantization level are looked for in turn in the
+        // same neighborhood
+        const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+        for( unsigned int level = 0; level <= coarserHistograms.size(); ++level )
+          {
+          this->ComputeVoxelFeatures( inputNIt, level == 0 ? histogram : coarserHistograms[level - 1],
+                                      featurePixel, 0, level );
+          for( unsigned int i = 0; i < numberOfFeatures; ++i )
             {
-            //If the voxel reached is outside of the image, stop the iterations
-            if(fit == faceList.begin())
-              {
-              inputNIt.GetPixel(iteratedOffset, isInImage);
-              if(!isInImage)
-                {
-                break;
-                }
-              }
-            pixelIntensity = inputNIt.GetPixel(iteratedOffset);
-            // Special attention paid to boundaries of bins.
-            // For the last bin, it is left close and right close (following the previous
-            // gerrit patch). For all other bins, the bin is left close and right open.
-            if (pixelIntensity == currentInNeighborhoodPixelIntensity )
-              {
-                alreadyVisitedImage->SetPixel( boolCurentInNeighborhoodIndex + iteratedOffset, true );
-                ++pixelDistance;
-                iteratedOffset += offset;
-                insideNeighborhood = this->IsInsideNeighborhood(iteratedOffset);
-              }
-            else
-              {
-              break;
-              }
+            outputPixel[level * numberOfFeatures + i] = featurePixel[i];
             }
-          // Increase the corresponding bin in the histogram
-
-          this->IncreaseHistogram(histogram, totalNumberOfRuns,
-                                  currentInNeighborhoodPixelIntensity,
-                                  offset, pixelDistance);
-
           }
         }
-      // Compute the run length features
-      this->ComputeFeatures( histogram, totalNumberOfRuns, outputPixel);
+      else if( m_PerOffsetFeatures )
+        {
+        this->ComputeVoxelOffsetFeatures( inputNIt, histogram, offsetHistogram, featurePixel, outputPixel );
+        }
+      else
+        {
+        this->ComputeVoxelFeatures( inputNIt, histogram, outputPixel );
+        }
       outputIt.Set(outputPixel);
 
       ++inputNIt;
       ++outputIt;
       }
     }
+}
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeVoxelFeatures( const TNeighborhoodIterator & inputNIt,
+                        vnl_matrix<unsigned int> & histogram,
+                        typename TOutputImage::PixelType & outputPixel,
+                        unsigned int window,
+                        unsigned int level )
+{
+  // Declaration of the variables useful to iterate over the all the offsets
+  const auto numberOfOffsets = static_cast< unsigned int >( m_NormalizedOffsets.size() );
+  unsigned int totalNumberOfRuns;
+
+  // Initialisation of the histogram
+  histogram.fill( 0 );
+  totalNumberOfRuns = 0;
+  // Iteration over all the offsets
+  for( unsigned int o = 0; o < numberOfOffsets; ++o )
+    {
+    this->VisitRuns( inputNIt, window, o, [&]( unsigned int intensity, unsigned int distanceBin )
+      {
+      this->IncreaseHistogram( histogram, totalNumberOfRuns, intensity, distanceBin );
+      }, level );
+    }
+  // Compute the run length features
+  this->ComputeFeatures( histogram, totalNumberOfRuns, outputPixel);
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator>
 void
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
-::GenerateOutputInformation()
+::ComputeVoxelOffsetFeatures( const TNeighborhoodIterator & inputNIt,
+                              vnl_matrix<unsigned int> & histogram,
+                              vnl_matrix<unsigned int> & offsetHistogram,
+                              typename TOutputImage::PixelType & featurePixel,
+                              typename TOutputImage::PixelType & outputPixel )
 {
-  Superclass::GenerateOutputInformation();
+  const unsigned int numberOfFeatures = this->GetNumberOfFeatures();
+  const auto numberOfOffsets = static_cast< unsigned int >( m_NormalizedOffsets.size() );
+  const unsigned int firstOffsetComponent = m_PooledFeatures ? numberOfFeatures : 0;
+
+  // The pooled histogram is the sum of the ones of the offsets, so it is
+  // accumulated from the same runs, looked for once
+  unsigned int totalNumberOfRuns = 0;
+  if( m_PooledFeatures )
+    {
+    histogram.fill( 0 );
+    }
+  for( unsigned int o = 0; o < numberOfOffsets; ++o )
+    {
+    offsetHistogram.fill( 0 );
+    unsigned int offsetNumberOfRuns = 0;
+    this->VisitRuns( inputNIt, 0, o, [&]( unsigned int intensity, unsigned int distanceBin )
+      {
+      this->IncreaseHistogram( offsetHistogram, offsetNumberOfRuns, intensity, distanceBin );
+      if( m_PooledFeatures )
+        {
+        this->IncreaseHistogram( histogram, totalNumberOfRuns, intensity, distanceBin );
+        }
+      } );
 
-  OutputImageType* output = this->GetOutput();
-  // If the output image type is a VectorImage the number of
-  // components will be properly sized if before allocation, if the
-  // output is a fixed width vector and the wrong number of
-  // components, then an exception will be thrown.
-  if ( output->GetNumberOfComponentsPerPixel() != 10 )
+    this->ComputeFeatures( offsetHistogram, offsetNumberOfRuns, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[firstOffsetComponent + o * numberOfFeatures + i] = featurePixel[i];
+      }
+    }
+
+  if( m_PooledFeatures )
     {
-    output->SetNumberOfComponentsPerPixel( 10 );
+    this->ComputeFeatures( histogram, totalNumberOfRuns, featurePixel );
+    for( unsigned int i = 0; i < numberOfFeatures; ++i )
+      {
+      outputPixel[i] = featurePixel[i];
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename TVisitor>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VisitRuns( const TNeighborhoodIterator & inputNIt, unsigned int window, unsigned int o,
+             const TVisitor & visitor, unsigned int level ) const
+{
+  using DigitizedPixelType = typename TNeighborhoodIterator::ImageType::PixelType;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
+
+  const unsigned int * distanceBins =
+    &m_DistanceBins[( level * m_NormalizedOffsets.size() + o ) * m_NumberOfDistanceBinsPerOffset];
+  const auto identity = []( DigitizedPixelType value ) { return value; };
+
+  // The values of a coarser level are derived from the digitized ones, the
+  // values outside of the mask or out of range being kept
+  const unsigned int factor = level == 0 ? 1 : this->GetNumberOfBinsPerAxis() / this->GetLevelNumberOfBins( level );
+  const auto coarsen = [factor]( DigitizedPixelType value ) { return DigitizerFunctorType::Coarsen( value, factor ); };
+
+  // The values of a neighborhood in range are not tested
+  if( inputNIt.IsNeighborhoodInRange() )
+    {
+    if( level == 0 )
+      {
+      this->VisitQuantizedRuns( inputNIt, window, o, distanceBins, identity, visitor, std::false_type() );
+      }
+    else
+      {
+      this->VisitQuantizedRuns( inputNIt, window, o, distanceBins, coarsen, visitor, std::false_type() );
+      }
+    }
+  else if( level == 0 )
+    {
+    this->VisitQuantizedRuns( inputNIt, window, o, distanceBins, identity, visitor, std::true_type() );
+    }
+  else
+    {
+    this->VisitQuantizedRuns( inputNIt, window, o, distanceBins, coarsen, visitor, std::true_type() );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator, typename TQuantizer, typename TVisitor, typename TCheckRange>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VisitQuantizedRuns( const TNeighborhoodIterator & inputNIt, unsigned int window, unsigned int o,
+                      const unsigned int * distanceBins, const TQuantizer & quantize,
+                      const TVisitor & visitor, TCheckRange checkRange ) const
+{
+  using DigitizedPixelType = typename TNeighborhoodIterator::ImageType::PixelType;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
+
+  // Digitized values from this one are outside of the mask or out of range
+  const DigitizedPixelType outOfRangeValue = DigitizerFunctorType::GetOutOfRangeValue();
+
+  // Declaration of the variables useful to iterate over the all neighborhood region
+  DigitizedPixelType currentInNeighborhoodPixelIntensity;
+
+  // Declaration of the variables useful to iterate over the run
+  unsigned int pixelDistance;
+
+  const SizeValueType tableStart = ( window * m_NormalizedOffsets.size() + o ) * m_NeighborhoodSize;
+  const NeighborIndexType * nextNeighborIndices = &m_NextNeighborIndices[tableStart];
+  const NeighborIndexType * previousNeighborIndices = &m_PreviousNeighborIndices[tableStart];
+  // Iteration over the all neighborhood region
+  for( const NeighborIndexType nb : m_WindowNeighborIndices[window] )
+    {
+    currentInNeighborhoodPixelIntensity = quantize( inputNIt.GetPixel(nb) );
+    // Checking if the value is out-of-bounds or is outside the mask.
+    if( checkRange && currentInNeighborhoodPixelIntensity >= outOfRangeValue ) // The pixel is outside of the mask or outside of bounds
+      {
+      continue;
+      }
+    // A run only starts where the previous voxel along the offset is
+    // outside of the neighborhood or in another bin. The previous voxel
+    // has a smaller neighborhood index, so the run it belongs to has
+    // already been counted and includes the current voxel.
+    const NeighborIndexType previous = previousNeighborIndices[nb];
+    if( previous != m_NeighborhoodSize && quantize( inputNIt.GetPixel(previous) ) == currentInNeighborhoodPixelIntensity )
+      {
+      continue;
+      }
+    // Scan from the iterated pixel at index, following the direction of
+    // offset. Run length is computed as the length of continuous pixel
+    // whose pixel values are in the same bin.
+    pixelDistance = 0;
+    for( NeighborIndexType next = nextNeighborIndices[nb]; next != m_NeighborhoodSize;
+         next = nextNeighborIndices[next] )
+      {
+      // Special attention paid to boundaries of bins.
+      // For the last bin, it is left close and right close (following the previous
+      // gerrit patch). For all other bins, the bin is left close and right open.
+      if( quantize( inputNIt.GetPixel(next) ) != currentInNeighborhoodPixelIntensity )
+        {
+        break;
+        }
+      ++pixelDistance;
+      }
+    // Increase the corresponding bin in the histogram
+    visitor( currentInNeighborhoodPixelIntensity, distanceBins[pixelDistance] );
     }
 }
 
@@ -329,15 +657,161 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
   itkDebugMacro("new  offset = " << offset << std::endl);
 }
 
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeNextNeighborIndices()
+{
+  Neighborhood< PixelType, TInputImage::ImageDimension > hood;
+  hood.SetRadius( this->GetLargestNeighborhoodRadius() );
+  m_NeighborhoodSize = hood.Size();
+
+  m_NormalizedOffsets.clear();
+  typename OffsetVector::ConstIterator offsets;
+  for( offsets = m_Offsets->Begin(); offsets != m_Offsets->End(); ++offsets )
+    {
+    OffsetType offset = offsets.Value();
+    this->NormalizeOffsetDirection( offset );
+    m_NormalizedOffsets.push_back( offset );
+    }
+
+  // The windows are indexed in the neighborhood of the largest radius
+  const NeighborhoodRadiusVectorType windowRadii =
+    m_NeighborhoodRadii.empty() ? NeighborhoodRadiusVectorType( 1, m_NeighborhoodRadius ) : m_NeighborhoodRadii;
+  m_WindowNeighborIndices.assign( windowRadii.size(), std::vector< NeighborIndexType >() );
+  m_NextNeighborIndices.assign( windowRadii.size() * m_NormalizedOffsets.size() * m_NeighborhoodSize,
+                                m_NeighborhoodSize );
+  m_PreviousNeighborIndices.assign( m_NextNeighborIndices.size(), m_NeighborhoodSize );
+
+  for( unsigned int window = 0; window < windowRadii.size(); ++window )
+    {
+    const NeighborhoodRadiusType & radius = windowRadii[window];
+    for( NeighborIndexType nb = 0; nb < m_NeighborhoodSize; ++nb )
+      {
+      if( Self::IsInsideNeighborhood( hood.GetOffset( nb ), radius ) )
+        {
+        m_WindowNeighborIndices[window].push_back( nb );
+        }
+      }
+
+    for( unsigned int o = 0; o < m_NormalizedOffsets.size(); ++o )
+      {
+      const SizeValueType tableStart = ( window * m_NormalizedOffsets.size() + o ) * m_NeighborhoodSize;
+      for( const NeighborIndexType nb : m_WindowNeighborIndices[window] )
+        {
+        const OffsetType nextOffset = hood.GetOffset( nb ) + m_NormalizedOffsets[o];
+        if( Self::IsInsideNeighborhood( nextOffset, radius ) )
+          {
+          const NeighborIndexType next = hood.GetNeighborhoodIndex( nextOffset );
+          m_NextNeighborIndices[tableStart + nb] = next;
+          m_PreviousNeighborIndices[tableStart + next] = nb;
+          }
+        }
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeDistanceBins()
+{
+  // A run stays inside of the neighborhood, so it can not extend over more
+  // than the neighborhood diameter
+  SizeValueType maximumPixelDistance = 0;
+  const NeighborhoodRadiusType & radius = this->GetLargestNeighborhoodRadius();
+  for ( unsigned int i = 0; i < radius.Dimension; ++i )
+    {
+    maximumPixelDistance = std::max( maximumPixelDistance, 2 * radius[i] );
+    }
+  m_NumberOfDistanceBinsPerOffset = maximumPixelDistance + 1;
+
+  // The distance axis of each quantization level has its number of bins
+  const unsigned int numberOfLevels = 1 + static_cast< unsigned int >( m_CoarserNumbersOfBinsPerAxis.size() );
+  m_DistanceBins.clear();
+  m_DistanceBins.reserve( numberOfLevels * m_NormalizedOffsets.size() * m_NumberOfDistanceBinsPerOffset );
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+    {
+    const unsigned int numberOfBins = this->GetLevelNumberOfBins( level );
+    for( const OffsetType & offset : m_NormalizedOffsets )
+      {
+      float offsetDistance = 0;
+      for( unsigned int i = 0; i < offset.GetOffsetDimension(); ++i)
+        {
+        offsetDistance += (offset[i]*m_Spacing[i])*(offset[i]*m_Spacing[i]);
+        }
+      offsetDistance = std::sqrt(offsetDistance);
+      for( unsigned int pixelDistance = 0; pixelDistance < m_NumberOfDistanceBinsPerOffset; ++pixelDistance )
+        {
+        auto offsetDistanceBin = static_cast< int>(( offsetDistance*pixelDistance - m_HistogramDistanceMinimum)/
+                ( (m_HistogramDistanceMaximum - m_HistogramDistanceMinimum) / (float)numberOfBins ));
+        if (offsetDistanceBin < static_cast< int >( numberOfBins ) && offsetDistanceBin >= 0)
+          {
+          m_DistanceBins.push_back( static_cast< unsigned int >( offsetDistanceBin ) );
+          }
+        else
+          {
+          m_DistanceBins.push_back( numberOfBins );
+          }
+        }
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeUniformRuns()
+{
+  // In a neighborhood holding a single value, a run starts at each voxel
+  // whose previous voxel along the offset is outside of the neighborhood, and
+  // ends at the last voxel of the neighborhood along the offset
+  m_UniformRunCounts.assign( this->GetNumberOfBinsPerAxis(), 0 );
+  m_UniformNumberOfRuns = 0;
+  for( unsigned int o = 0; o < m_NormalizedOffsets.size(); ++o )
+    {
+    const NeighborIndexType * nextNeighborIndices = &m_NextNeighborIndices[o * m_NeighborhoodSize];
+    const NeighborIndexType * previousNeighborIndices = &m_PreviousNeighborIndices[o * m_NeighborhoodSize];
+    const unsigned int * distanceBins = &m_DistanceBins[o * m_NumberOfDistanceBinsPerOffset];
+    for( const NeighborIndexType nb : m_WindowNeighborIndices[0] )
+      {
+      if( previousNeighborIndices[nb] != m_NeighborhoodSize )
+        {
+        continue;
+        }
+      unsigned int pixelDistance = 0;
+      for( NeighborIndexType next = nextNeighborIndices[nb]; next != m_NeighborhoodSize;
+           next = nextNeighborIndices[next] )
+        {
+        ++pixelDistance;
+        }
+      const unsigned int distanceBin = distanceBins[pixelDistance];
+      if( distanceBin < this->GetNumberOfBinsPerAxis() )
+        {
+        ++m_UniformRunCounts[distanceBin];
+        ++m_UniformNumberOfRuns;
+        }
+      }
+    }
+}
+
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 bool
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 ::IsInsideNeighborhood(const OffsetType &iteratedOffset)
+{
+  return Self::IsInsideNeighborhood( iteratedOffset, this->GetLargestNeighborhoodRadius() );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+bool
+RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
+::IsInsideNeighborhood(const OffsetType &iteratedOffset, const NeighborhoodRadiusType &radius)
 {
   bool insideNeighborhood = true;
-  for ( unsigned int i = 0; i < this->m_NeighborhoodRadius.Dimension; ++i )
+  for ( unsigned int i = 0; i < radius.Dimension; ++i )
     {
-    int boundDistance = m_NeighborhoodRadius[i] - Math::abs(iteratedOffset[i]);
+    int boundDistance = radius[i] - Math::abs(iteratedOffset[i]);
     if(boundDistance < 0)
       {
       insideNeighborhood = false;
@@ -351,18 +825,10 @@ template<typename TInputImage, typename TOutputImage, typename TMaskImage>
 void
 RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 ::IncreaseHistogram(vnl_matrix<unsigned int> &histogram, unsigned int &totalNumberOfRuns,
-                     const HistogramIndexType &currentInNeighborhoodPixelIntensity,
-                     const OffsetType &offset, const unsigned int &pixelDistance)
+                     const unsigned int &currentInNeighborhoodPixelIntensity,
+                     const unsigned int &offsetDistanceBin)
 {
-  float offsetDistance = 0;
-  for( unsigned int i = 0; i < offset.GetOffsetDimension(); ++i)
-    {
-    offsetDistance += (offset[i]*m_Spacing[i])*(offset[i]*m_Spacing[i]);
-    }
-  offsetDistance = std::sqrt(offsetDistance);
-  auto offsetDistanceBin = static_cast< int>(( offsetDistance*pixelDistance - m_HistogramDistanceMinimum)/
-          ( (m_HistogramDistanceMaximum - m_HistogramDistanceMinimum) / (float)m_NumberOfBinsPerAxis ));
-  if (offsetDistanceBin < static_cast< int >( m_NumberOfBinsPerAxis ) && offsetDistanceBin >= 0)
+  if (offsetDistanceBin < histogram.cols())
     {
     ++totalNumberOfRuns;
     ++histogram[currentInNeighborhoodPixelIntensity][offsetDistanceBin];
@@ -386,14 +852,28 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
   OutputRealType longRunLowGreyLevelEmphasis = NumericTraits<OutputRealType>::ZeroValue();
   OutputRealType longRunHighGreyLevelEmphasis = NumericTraits<OutputRealType>::ZeroValue();
 
-  vnl_vector<double> greyLevelNonuniformityVector(
-    m_NumberOfBinsPerAxis, 0.0 );
-  vnl_vector<double> runLengthNonuniformityVector(
-    m_NumberOfBinsPerAxis, 0.0 );
+  // The accumulations of the features that are not selected are skipped
+  const bool computeNonuniformities =
+    ( m_FeatureMask & ( GreyLevelNonuniformityFeature | RunLengthNonuniformityFeature ) ) != 0;
+  const bool computeGreyLevelEmphases =
+    ( m_FeatureMask & ( LowGreyLevelRunEmphasisFeature | HighGreyLevelRunEmphasisFeature ) ) != 0;
+  const bool computeJointEmphases =
+    ( m_FeatureMask & ( ShortRunLowGreyLevelEmphasisFeature | ShortRunHighGreyLevelEmphasisFeature
+                        | LongRunLowGreyLevelEmphasisFeature | LongRunHighGreyLevelEmphasisFeature ) ) != 0;
+
+  vnl_vector<double> greyLevelNonuniformityVector;
+  vnl_vector<double> runLengthNonuniformityVector;
+  if( computeNonuniformities )
+    {
+    greyLevelNonuniformityVector.set_size( histogram.rows() );
+    greyLevelNonuniformityVector.fill( 0.0 );
+    runLengthNonuniformityVector.set_size( histogram.cols() );
+    runLengthNonuniformityVector.fill( 0.0 );
+    }
 
-  for(unsigned int a = 0; a < m_NumberOfBinsPerAxis; ++a)
+  for(unsigned int a = 0; a < histogram.rows(); ++a)
     {
-    for(unsigned int b = 0; b < m_NumberOfBinsPerAxis; ++b)
+    for(unsigned int b = 0; b < histogram.cols(); ++b)
       {
       OutputRealType frequency = histogram[a][b];
       if ( Math::ExactlyEquals(frequency, NumericTraits<OutputRealType>::ZeroValue()) )
@@ -408,51 +888,52 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
       shortRunEmphasis += ( frequency / j2 );
       longRunEmphasis += ( frequency * j2 );
 
-      greyLevelNonuniformityVector[a] += frequency;
-      runLengthNonuniformityVector[b] += frequency;
+      if( computeNonuniformities )
+        {
+        greyLevelNonuniformityVector[a] += frequency;
+        runLengthNonuniformityVector[b] += frequency;
+        }
 
       // Measures from Chu et al.
-      lowGreyLevelRunEmphasis += ( frequency / i2 );
-      highGreyLevelRunEmphasis += ( frequency * i2 );
+      if( computeGreyLevelEmphases )
+        {
+        lowGreyLevelRunEmphasis += ( frequency / i2 );
+        highGreyLevelRunEmphasis += ( frequency * i2 );
+        }
 
       // Measures from Dasarathy and Holder
-      shortRunLowGreyLevelEmphasis += ( frequency / ( i2 * j2 ) );
-      shortRunHighGreyLevelEmphasis += ( frequency * i2 / j2 );
-      longRunLowGreyLevelEmphasis += ( frequency * j2 / i2 );
-      longRunHighGreyLevelEmphasis += ( frequency * i2 * j2 );
+      if( computeJointEmphases )
+        {
+        shortRunLowGreyLevelEmphasis += ( frequency / ( i2 * j2 ) );
+        shortRunHighGreyLevelEmphasis += ( frequency * i2 / j2 );
+        longRunLowGreyLevelEmphasis += ( frequency * j2 / i2 );
+        longRunHighGreyLevelEmphasis += ( frequency * i2 * j2 );
+        }
       }
     }
-  greyLevelNonuniformity =
-          greyLevelNonuniformityVector.squared_magnitude();
-  runLengthNonuniformity =
-          runLengthNonuniformityVector.squared_magnitude();
-
-  // Normalize all measures by the total number of runs
-
-  shortRunEmphasis /= static_cast<double>( totalNumberOfRuns );
-  longRunEmphasis /= static_cast<double>( totalNumberOfRuns );
-  greyLevelNonuniformity /= static_cast<double>( totalNumberOfRuns );
-  runLengthNonuniformity /= static_cast<double>( totalNumberOfRuns );
-
-  lowGreyLevelRunEmphasis /= static_cast<double>( totalNumberOfRuns );
-  highGreyLevelRunEmphasis /= static_cast<double>( totalNumberOfRuns );
-
-  shortRunLowGreyLevelEmphasis /= static_cast<double>( totalNumberOfRuns );
-  shortRunHighGreyLevelEmphasis /= static_cast<double>( totalNumberOfRuns );
-  longRunLowGreyLevelEmphasis /= static_cast<double>( totalNumberOfRuns );
-  longRunHighGreyLevelEmphasis /= static_cast<double>( totalNumberOfRuns );
-
-  outputPixel[0] = shortRunEmphasis;
-  outputPixel[1] = longRunEmphasis;
-  outputPixel[2] = greyLevelNonuniformity;
-  outputPixel[3] = runLengthNonuniformity;
-  outputPixel[4] = lowGreyLevelRunEmphasis;
-  outputPixel[5] = highGreyLevelRunEmphasis;
-  outputPixel[6] = shortRunLowGreyLevelEmphasis;
-  outputPixel[7] = shortRunHighGreyLevelEmphasis;
-  outputPixel[8] = longRunLowGreyLevelEmphasis;
-  outputPixel[9] = longRunHighGreyLevelEmphasis;
+  if( computeNonuniformities )
+    {
+    greyLevelNonuniformity =
+            greyLevelNonuniformityVector.squared_magnitude();
+    runLengthNonuniformity =
+            runLengthNonuniformityVector.squared_magnitude();
+    }
 
+  // Normalize all measures by the total number of runs, and keep the
+  // selected ones
+  const OutputRealType features[10] = { shortRunEmphasis, longRunEmphasis,
+    greyLevelNonuniformity, runLengthNonuniformity,
+    lowGreyLevelRunEmphasis, highGreyLevelRunEmphasis,
+    shortRunLowGreyLevelEmphasis, shortRunHighGreyLevelEmphasis,
+    longRunLowGreyLevelEmphasis, longRunHighGreyLevelEmphasis };
+  unsigned int component = 0;
+  for( unsigned int i = 0; i < 10; ++i )
+    {
+    if( m_FeatureMask & ( 1u << i ) )
+      {
+      outputPixel[component++] = features[i] / static_cast<double>( totalNumberOfRuns );
+      }
+    }
 }
 
 template<typename TInputImage, typename TOutputImage, typename TMaskImage>
@@ -462,15 +943,24 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
 {
   Superclass::PrintSelf( os, indent );
 
-  itkPrintSelfObjectMacro( DigitizedInputImage );
-
   os << indent << "NeighborhoodRadius: "
     << static_cast< typename NumericTraits<
     NeighborhoodRadiusType >::PrintType >( m_NeighborhoodRadius ) << std::endl;
+  os << indent << "NeighborhoodRadii:";
+  for( const NeighborhoodRadiusType & radius : m_NeighborhoodRadii )
+    {
+    os << " " << static_cast< typename NumericTraits< NeighborhoodRadiusType >::PrintType >( radius );
+    }
+  os << std::endl;
 
   itkPrintSelfObjectMacro( Offsets );
 
-  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "CoarserNumbersOfBinsPerAxis:";
+  for( const unsigned int numberOfBins : m_CoarserNumbersOfBinsPerAxis )
+    {
+    os << " " << numberOfBins;
+    }
+  os << std::endl;
   os << indent << "Min: "
     << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramValueMinimum )
     << std::endl;
@@ -483,12 +973,14 @@ RunLengthTextureFeaturesImageFilter<TInputImage, TOutputImage, TMaskImage>
   os << indent << "MaxDistance: "
     << static_cast< typename NumericTraits< RealType >::PrintType >(
     m_HistogramDistanceMaximum ) << std::endl;
-  os << indent << "InsidePixelValue: "
-    << static_cast< typename NumericTraits< PixelType >::PrintType >(
-    m_InsidePixelValue ) << std::endl;
   os << indent << "Spacing: "
     << static_cast< typename NumericTraits<
     typename TInputImage::SpacingType >::PrintType >( m_Spacing ) << std::endl;
+  os << indent << "FeatureMask: " << m_FeatureMask << std::endl;
+  os << indent << "PerOffsetFeatures: " << m_PerOffsetFeatures << std::endl;
+  os << indent << "DetectUniformNeighborhoods: " << m_DetectUniformNeighborhoods << std::endl;
+  os << indent << "DetectInRangeNeighborhoods: " << m_DetectInRangeNeighborhoods << std::endl;
+  os << indent << "PooledFeatures: " << m_PooledFeatures << std::endl;
 }
 } // end of namespace Statistics
 } // end of namespace itk
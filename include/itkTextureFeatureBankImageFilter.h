@@ -0,0 +1,310 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeatureBankImageFilter_h
+#define itkTextureFeatureBankImageFilter_h
+
+#include "itkTextureFeaturesImageFilterBase.h"
+#include "itkVectorImage.h"
+#include "itkCoocurrenceTextureFeaturesImageFilter.h"
+#include "itkRunLengthTextureFeaturesImageFilter.h"
+#include "itkFirstOrderTextureHistogram.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+/** \class TextureFeatureBankImageFilter
+ *  \brief This class computes the co-occurrence, run length and first order
+ *  texture features of each voxel of a given image in a single pass.
+ *
+ * The output image is a N-D image where each voxel contains the selected
+ * features in this order:
+ * -# the co-occurrence features of the CoocurrenceTextureFeaturesImageFilter
+ *    selected by CoocurrenceFeatureMask, all 8 by default,
+ * -# the run length features of the RunLengthTextureFeaturesImageFilter
+ *    selected by RunLengthFeatureMask, all 10 by default,
+ * -# the 8 first order features of the FirstOrderTextureFeaturesImageFilter:
+ *    mean, minimum, maximum, variance, standard deviation, skewness, kurtosis
+ *    and entropy.
+ *
+ * The input is digitized once and each neighborhood is visited once for all
+ * the features, instead of once per filter. The co-occurrence and run length
+ * features are identical to the ones of the individual filters with the same
+ * parameters. The first order features are computed from the input
+ * intensities of the voxels of the neighborhood box that are inside of the
+ * image, as the FirstOrderTextureFeaturesImageFilter does with a box kernel
+ * of the same radius. All the features are 0 outside of the mask.
+ *
+ * Template Parameters:
+ * -# The input image type: a N dimensional image where the pixel type MUST be integer.
+ * -# The output image type: a N dimensional image where the pixel type MUST be a vector of floating points or a VectorImage.
+ *
+ * Inputs and parameters:
+ * -# An image
+ * -# A mask defining the region over which texture features will be
+ *    calculated. (Optional)
+ * -# The image digitized by a DigitizerImageFilter. (Optional, computed from
+ *    the image and the mask by default.)
+ * -# The pixel value that defines the "inside" of the mask. (Optional, defaults
+ *    to 1 if a mask is set.)
+ * -# The number of intensity bins. (Optional, defaults to 256, at most 65534.)
+ * -# The set of directions (offsets) of the co-occurrence and run length
+ *    features. (Optional, defaults to {(-1, 0), (-1, -1), (0, -1), (1, -1)}
+ *    for 2D images and scales analogously for ND images.)
+ * -# The pixel intensity range over which the features will be calculated.
+ *    (Optional, defaults to the full dynamic range of the pixel type.)
+ * -# The run length distance range. (Optional, defaults to the full range.)
+ * -# The size of the neighborhood radius. (Optional, defaults to 2.)
+ * -# The families of features to compute. (Optional, defaults to all.)
+ * -# Whether only the features of the voxels inside of the mask are
+ *    computed, into the compact output instead of the image output.
+ *    (Optional, defaults to false.)
+ *
+ * \sa TextureFeaturesImageFilterBase
+ * \sa CoocurrenceTextureFeaturesImageFilter
+ * \sa RunLengthTextureFeaturesImageFilter
+ * \sa FirstOrderTextureFeaturesImageFilter
+ * \sa DigitizerImageFilter
+ *
+ * \ingroup TextureFeatures
+ **/
+
+template< typename TInputImage,
+          typename TOutputImage,
+          typename TMaskImage = Image< unsigned char, TInputImage::ImageDimension> >
+class ITK_TEMPLATE_EXPORT TextureFeatureBankImageFilter
+  : public TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >
+{
+public:
+  /** Standard type alias */
+  using Self = TextureFeatureBankImageFilter;
+  using Superclass = TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TextureFeatureBankImageFilter, TextureFeaturesImageFilterBase);
+
+  /** standard New() method support */
+  itkNewMacro(Self);
+
+  using InputImageType = typename Superclass::InputImageType;
+  using OutputImageType = typename Superclass::OutputImageType;
+  using MaskImageType = typename Superclass::MaskImageType;
+
+  using PixelType = typename Superclass::PixelType;
+  using MaskPixelType = typename Superclass::MaskPixelType;
+
+  using OffsetType = typename Superclass::OffsetType;
+  using OffsetVector = typename Superclass::OffsetVector;
+  using OffsetVectorPointer = typename Superclass::OffsetVectorPointer;
+
+  using InputRegionType = typename Superclass::InputRegionType;
+  using OutputRegionType = typename Superclass::OutputRegionType;
+
+  using NeighborhoodRadiusType = typename Superclass::NeighborhoodRadiusType;
+
+  using RealType = typename Superclass::RealType;
+
+  using OutputPixelType = typename Superclass::OutputPixelType;
+  using OutputRealType = typename Superclass::OutputRealType;
+
+  /** Method to set/get the Neighborhood radius */
+  itkSetMacro(NeighborhoodRadius, NeighborhoodRadiusType);
+  itkGetConstMacro(NeighborhoodRadius, NeighborhoodRadiusType);
+
+  /**
+   * Set the offsets of the co-occurrence and run length features.
+   * Invoking this function clears the previous offsets.
+   * Note: for each individual offset in the OffsetVector, the rightmost non-zero
+   * offset element must be positive. For example, in the offset list of a 2D image,
+   * (1, 0) means the offset  along x-axis. (1, 0) has to be set instead
+   * of (-1, 0). This is required from the iterating order of pixel iterator.
+   *
+   */
+  itkSetObjectMacro( Offsets, OffsetVector );
+
+  /**
+   * Get the current offset(s).
+   */
+  itkGetModifiableObjectMacro(Offsets, OffsetVector );
+
+  /** Set/Get the min and max pixel values of the intensity bins. */
+  itkGetConstMacro( HistogramMinimum, PixelType );
+  itkSetMacro( HistogramMinimum, PixelType);
+  itkGetConstMacro( HistogramMaximum, PixelType );
+  itkSetMacro( HistogramMaximum, PixelType);
+
+  /** Set/Get the min and max run length distances in physical space of the
+   * run length features. */
+  itkGetConstMacro( HistogramDistanceMinimum, RealType );
+  itkSetMacro( HistogramDistanceMinimum, RealType);
+  itkGetConstMacro( HistogramDistanceMaximum, RealType );
+  itkSetMacro( HistogramDistanceMaximum, RealType);
+
+  /** Set/Get whether the co-occurrence features are computed. On by
+   * default. */
+  itkSetMacro(ComputeCoocurrenceFeatures, bool);
+  itkGetConstMacro(ComputeCoocurrenceFeatures, bool);
+  itkBooleanMacro(ComputeCoocurrenceFeatures);
+
+  /** Set/Get whether the run length features are computed. On by
+   * default. */
+  itkSetMacro(ComputeRunLengthFeatures, bool);
+  itkGetConstMacro(ComputeRunLengthFeatures, bool);
+  itkBooleanMacro(ComputeRunLengthFeatures);
+
+  /** Set/Get whether the 8 first order features are computed. On by
+   * default. */
+  itkSetMacro(ComputeFirstOrderFeatures, bool);
+  itkGetConstMacro(ComputeFirstOrderFeatures, bool);
+  itkBooleanMacro(ComputeFirstOrderFeatures);
+
+  /** Set/Get the co-occurrence features to compute, as a combination of
+   * CoocurrenceTextureFeaturesImageFilter::FeatureBitType. Defaults to all of
+   * them. */
+  itkSetMacro(CoocurrenceFeatureMask, unsigned int);
+  itkGetConstMacro(CoocurrenceFeatureMask, unsigned int);
+
+  /** Set/Get the run length features to compute, as a combination of
+   * RunLengthTextureFeaturesImageFilter::FeatureBitType. Defaults to all of
+   * them. */
+  itkSetMacro(RunLengthFeatureMask, unsigned int);
+  itkGetConstMacro(RunLengthFeatureMask, unsigned int);
+
+  /** Number of components of the output pixels for the selected features. */
+  unsigned int GetNumberOfOutputComponents() const override;
+
+  using CompactFeaturesType = typename Superclass::CompactFeaturesType;
+  using ScalarFeatureImageType = typename Superclass::ScalarFeatureImageType;
+
+protected:
+
+  /** The individual filters compute the features of each voxel, into
+   * variable length pixels. */
+  using FeatureImageType = VectorImage< OutputRealType, TInputImage::ImageDimension >;
+  using FeaturePixelType = typename FeatureImageType::PixelType;
+  using CoocurrenceFilterType = CoocurrenceTextureFeaturesImageFilter< TInputImage, FeatureImageType, TMaskImage >;
+  using RunLengthFilterType = RunLengthTextureFeaturesImageFilter< TInputImage, FeatureImageType, TMaskImage >;
+  using FirstOrderHistogramType = Function::FirstOrderTextureHistogram< PixelType, FeaturePixelType >;
+
+  using NarrowDigitizedImageType = typename Superclass::NarrowDigitizedImageType;
+  using WideDigitizedImageType = typename Superclass::WideDigitizedImageType;
+  using NeighborIndexType = typename Superclass::NeighborIndexType;
+  using RegionVectorType = typename Superclass::RegionVectorType;
+  using FeatureImagesType = typename Superclass::FeatureImagesType;
+
+  /** Number of features when all of them are selected, i.e. of per feature
+   * outputs. */
+  static constexpr unsigned int MaximumNumberOfFeatures = 26;
+
+  TextureFeatureBankImageFilter();
+  ~TextureFeatureBankImageFilter() override {}
+
+  const NeighborhoodRadiusType & GetLargestNeighborhoodRadius() const override
+    {
+    return m_NeighborhoodRadius;
+    }
+
+  /** The intensity range is shared by the co-occurrence and run length
+   * features. */
+  PixelType GetDigitizerMinimum() const override { return m_HistogramMinimum; }
+  PixelType GetDigitizerMaximum() const override { return m_HistogramMaximum; }
+
+  /** Compute the neighborhood indices of the slices leaving and entering the
+   * neighborhood when it moves by one voxel along the first dimension. */
+  void ComputeFirstOrderSlices();
+
+  /** Compute the features of the regions with DispatchRegionsFeatures. */
+  void ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output ) override;
+  void ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output ) override;
+
+  /** Compute the features of the regions into the output, an image, the
+   * compact output or the scalar images of the features, from the narrow or
+   * wide digitized image. */
+  template< typename TOutput >
+  void DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output );
+
+  /** Compute the features of the regions from the digitized image, selecting
+   * the co-occurrence matrix storage. */
+  template< typename TOutput, typename TDigitizedImage >
+  void ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                                const TDigitizedImage * digitizedImage );
+
+  /** Compute the features of the regions from the digitized image with the
+   * given co-occurrence matrix storage. */
+  template< typename TOutput, typename TDigitizedImage, typename THistogram >
+  void ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                                const TDigitizedImage * digitizedImage,
+                                THistogram & hist );
+
+  /** Compute the first order features of the voxel at the center of the
+   * neighborhood kernel over the input image, from the neighbors inside of
+   * imageRegion. When slideFromPreviousVoxel is true, hist must
+   * hold the state left by the call on the previous voxel of the same scan
+   * line and is updated incrementally. */
+  template< typename TNeighborhoodIterator >
+  void ComputeFirstOrderFeatures( const TNeighborhoodIterator & inputNIt,
+                                  const InputRegionType & imageRegion,
+                                  bool slideFromPreviousVoxel,
+                                  FirstOrderHistogramType & hist,
+                                  FeaturePixelType & outputPixel );
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Check that the feature masks select at least one feature. */
+  void VerifyPreconditions() ITKv5_CONST override;
+
+  /** Digitize the input, then compute the neighborhood tables of the
+   * individual filters. */
+  void BeforeThreadedGenerateData() override;
+  void AfterThreadedGenerateData() override;
+
+  double EstimateInsideVoxelCost() const override;
+
+private:
+  NeighborhoodRadiusType                m_NeighborhoodRadius;
+  OffsetVectorPointer                   m_Offsets;
+  PixelType                             m_HistogramMinimum;
+  PixelType                             m_HistogramMaximum;
+  RealType                              m_HistogramDistanceMinimum;
+  RealType                              m_HistogramDistanceMaximum;
+  bool                                  m_ComputeCoocurrenceFeatures;
+  bool                                  m_ComputeRunLengthFeatures;
+  bool                                  m_ComputeFirstOrderFeatures;
+  unsigned int                          m_CoocurrenceFeatureMask;
+  unsigned int                          m_RunLengthFeatureMask;
+
+  typename CoocurrenceFilterType::Pointer m_CoocurrenceFilter;
+  typename RunLengthFilterType::Pointer   m_RunLengthFilter;
+
+  std::vector< OffsetType >             m_NeighborOffsets;
+  std::vector< NeighborIndexType >      m_LeavingIndices;
+  std::vector< NeighborIndexType >      m_EnteringIndices;
+};
+} // end of namespace Statistics
+} // end of namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTextureFeatureBankImageFilter.hxx"
+#endif
+
+#endif
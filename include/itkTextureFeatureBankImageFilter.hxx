@@ -0,0 +1,475 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeatureBankImageFilter_hxx
+#define itkTextureFeatureBankImageFilter_hxx
+
+#include "itkTextureFeatureBankImageFilter.h"
+#include "itkTextureNeighborhoodKernel.h"
+
+#include <bitset>
+
+namespace itk
+{
+namespace Statistics
+{
+template< typename TInputImage, typename TOutputImage, typename TMaskImage>
+TextureFeatureBankImageFilter< TInputImage, TOutputImage, TMaskImage>
+::TextureFeatureBankImageFilter() :
+    Superclass( MaximumNumberOfFeatures ),
+    m_HistogramMinimum( NumericTraits<PixelType>::NonpositiveMin() ),
+    m_HistogramMaximum( NumericTraits<PixelType>::max() ),
+    m_HistogramDistanceMinimum( NumericTraits<RealType>::ZeroValue() ),
+    m_HistogramDistanceMaximum( NumericTraits<RealType>::max() ),
+    m_ComputeCoocurrenceFeatures( true ),
+    m_ComputeRunLengthFeatures( true ),
+    m_ComputeFirstOrderFeatures( true ),
+    m_CoocurrenceFeatureMask( CoocurrenceFilterType::AllFeatures ),
+    m_RunLengthFeatureMask( RunLengthFilterType::AllFeatures )
+{
+  // The individual filters provide the default offsets
+  m_CoocurrenceFilter = CoocurrenceFilterType::New();
+  m_RunLengthFilter = RunLengthFilterType::New();
+  this->SetOffsets( m_CoocurrenceFilter->GetOffsets() );
+  this->m_NeighborhoodRadius = m_CoocurrenceFilter->GetNeighborhoodRadius();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+unsigned int
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::GetNumberOfOutputComponents() const
+{
+  const auto numberOfCoocurrenceFeatures =
+    static_cast< unsigned int >( std::bitset< 8 >( m_CoocurrenceFeatureMask ).count() );
+  const auto numberOfRunLengthFeatures =
+    static_cast< unsigned int >( std::bitset< 10 >( m_RunLengthFeatureMask ).count() );
+  return ( m_ComputeCoocurrenceFeatures ? numberOfCoocurrenceFeatures : 0 )
+    + ( m_ComputeRunLengthFeatures ? numberOfRunLengthFeatures : 0 )
+    + ( m_ComputeFirstOrderFeatures ? 8 : 0 );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::VerifyPreconditions() ITKv5_CONST
+{
+  Superclass::VerifyPreconditions();
+
+  if( this->GetNumberOfOutputComponents() == 0 )
+    {
+    itkExceptionMacro( "At least one family of features must be computed" );
+    }
+  if( m_CoocurrenceFeatureMask == 0
+      || ( m_CoocurrenceFeatureMask & ~static_cast< unsigned int >( CoocurrenceFilterType::AllFeatures ) ) != 0 )
+    {
+    itkExceptionMacro( "CoocurrenceFeatureMask is " << m_CoocurrenceFeatureMask << " but must select at least one "
+                       "of the features of CoocurrenceTextureFeaturesImageFilter::FeatureBitType" );
+    }
+  if( m_RunLengthFeatureMask == 0
+      || ( m_RunLengthFeatureMask & ~static_cast< unsigned int >( RunLengthFilterType::AllFeatures ) ) != 0 )
+    {
+    itkExceptionMacro( "RunLengthFeatureMask is " << m_RunLengthFeatureMask << " but must select at least one "
+                       "of the features of RunLengthTextureFeaturesImageFilter::FeatureBitType" );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  // The individual filters only prepare their neighborhood tables, the
+  // voxels are processed here from the digitized image of the bank
+  if( m_ComputeCoocurrenceFeatures )
+    {
+    m_CoocurrenceFilter->SetInput( this->GetInput() );
+    m_CoocurrenceFilter->SetNeighborhoodRadius( m_NeighborhoodRadius );
+    m_CoocurrenceFilter->SetOffsets( m_Offsets );
+    m_CoocurrenceFilter->SetNumberOfBinsPerAxis( this->GetNumberOfBinsPerAxis() );
+    m_CoocurrenceFilter->SetHistogramMinimum( m_HistogramMinimum );
+    m_CoocurrenceFilter->SetHistogramMaximum( m_HistogramMaximum );
+    m_CoocurrenceFilter->SetInsidePixelValue( this->GetInsidePixelValue() );
+    m_CoocurrenceFilter->SetFeatureMask( m_CoocurrenceFeatureMask );
+    m_CoocurrenceFilter->ComputeNeighborhoodTables();
+    }
+  if( m_ComputeRunLengthFeatures )
+    {
+    m_RunLengthFilter->SetInput( this->GetInput() );
+    m_RunLengthFilter->SetNeighborhoodRadius( m_NeighborhoodRadius );
+    m_RunLengthFilter->SetOffsets( m_Offsets );
+    m_RunLengthFilter->SetNumberOfBinsPerAxis( this->GetNumberOfBinsPerAxis() );
+    m_RunLengthFilter->SetHistogramValueMinimum( m_HistogramMinimum );
+    m_RunLengthFilter->SetHistogramValueMaximum( m_HistogramMaximum );
+    m_RunLengthFilter->SetHistogramDistanceMinimum( m_HistogramDistanceMinimum );
+    m_RunLengthFilter->SetHistogramDistanceMaximum( m_HistogramDistanceMaximum );
+    m_RunLengthFilter->SetInsidePixelValue( this->GetInsidePixelValue() );
+    m_RunLengthFilter->SetFeatureMask( m_RunLengthFeatureMask );
+    m_RunLengthFilter->ComputeNeighborhoodTables();
+    }
+  if( m_ComputeFirstOrderFeatures )
+    {
+    this->ComputeFirstOrderSlices();
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeFirstOrderSlices()
+{
+  m_NeighborOffsets.clear();
+  m_LeavingIndices.clear();
+  m_EnteringIndices.clear();
+
+  Neighborhood< PixelType, TInputImage::ImageDimension > hood;
+  hood.SetRadius( m_NeighborhoodRadius );
+  const auto radius = static_cast< OffsetValueType >( m_NeighborhoodRadius[0] );
+  for( NeighborIndexType nb = 0; nb < hood.Size(); ++nb )
+    {
+    const OffsetType offset = hood.GetOffset( nb );
+    m_NeighborOffsets.push_back( offset );
+    if( offset[0] == -radius )
+      {
+      m_LeavingIndices.push_back( nb );
+      }
+    if( offset[0] == radius )
+      {
+      m_EnteringIndices.push_back( nb );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::AfterThreadedGenerateData()
+{
+  Superclass::AfterThreadedGenerateData();
+
+  // Release the inputs of the individual filters
+  if( m_ComputeCoocurrenceFeatures )
+    {
+    m_CoocurrenceFilter->AfterThreadedGenerateData();
+    m_CoocurrenceFilter->SetInput( nullptr );
+    }
+  if( m_ComputeRunLengthFeatures )
+    {
+    m_RunLengthFilter->AfterThreadedGenerateData();
+    m_RunLengthFilter->SetInput( nullptr );
+    }
+  this->m_NeighborOffsets.clear();
+  this->m_LeavingIndices.clear();
+  this->m_EnteringIndices.clear();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+double
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::EstimateInsideVoxelCost() const
+{
+  double cost = 1.0;
+  if( m_ComputeCoocurrenceFeatures )
+    {
+    cost += m_CoocurrenceFilter->EstimateInsideVoxelCost();
+    }
+  if( m_ComputeRunLengthFeatures )
+    {
+    cost += m_RunLengthFilter->EstimateInsideVoxelCost();
+    }
+  if( m_ComputeFirstOrderFeatures )
+    {
+    cost += m_LeavingIndices.size() + m_EnteringIndices.size();
+    }
+  return cost;
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output )
+{
+  this->DispatchRegionsFeatures( regions, output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::DispatchRegionsFeatures( const RegionVectorType & regions, TOutput * output )
+{
+  const auto * narrowDigitizedImage =
+    dynamic_cast< const NarrowDigitizedImageType * >( this->GetDigitizedInputImage() );
+  if( narrowDigitizedImage != nullptr )
+    {
+    this->ThreadedComputeFeatures( regions, output, narrowDigitizedImage );
+    }
+  else
+    {
+    this->ThreadedComputeFeatures( regions, output,
+      static_cast< const WideDigitizedImageType * >( this->GetDigitizedInputImage() ) );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput, typename TDigitizedImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                           const TDigitizedImage * digitizedImage )
+{
+  if( m_ComputeCoocurrenceFeatures && m_CoocurrenceFilter->m_UseSparseHistogram )
+    {
+    SparseCoocurrenceHistogram hist;
+    hist.Initialize( this->GetNumberOfBinsPerAxis(), m_CoocurrenceFilter->m_NeighborhoodPairs.size() );
+    this->ThreadedComputeFeatures( regions, output, digitizedImage, hist );
+    }
+  else
+    {
+    DenseCoocurrenceHistogram hist;
+    if( m_ComputeCoocurrenceFeatures )
+      {
+      hist.Initialize( this->GetNumberOfBinsPerAxis(), m_CoocurrenceFilter->m_NeighborhoodPairs.size() );
+      }
+    this->ThreadedComputeFeatures( regions, output, digitizedImage, hist );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TOutput, typename TDigitizedImage, typename THistogram>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ThreadedComputeFeatures( const RegionVectorType & regions, TOutput * output,
+                           const TDigitizedImage * digitizedImage,
+                           THistogram & hist )
+{
+  using DigitizedPixelType = typename TDigitizedImage::PixelType;
+  using DigitizedNeighborhoodIteratorType = TextureNeighborhoodKernel< TDigitizedImage >;
+  using InputNeighborhoodIteratorType = TextureNeighborhoodKernel< InputImageType >;
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, DigitizedPixelType >;
+
+  // Digitized value of the voxels outside of the mask
+  const DigitizedPixelType outsideMaskValue = DigitizerFunctorType::GetOutsideMaskValue();
+
+  // The first order features only count the neighbors inside of the image,
+  // which are all in the padded requested region of the input
+  const InputRegionType imageRegion = this->GetInput()->GetLargestPossibleRegion();
+
+  // Creation of the output pixel type
+  OutputPixelType outputPixel;
+  NumericTraits<OutputPixelType>::SetLength(outputPixel, output->GetNumberOfComponentsPerPixel());
+
+  // Features of each family
+  FeaturePixelType coocurrencePixel( m_CoocurrenceFilter->GetNumberOfFeatures() );
+  FeaturePixelType runLengthPixel( m_RunLengthFilter->GetNumberOfFeatures() );
+  FeaturePixelType firstOrderPixel( 8 );
+
+  // Scratch buffers of the co-occurrence features
+  unsigned int totalNumberOfFreq = 0;
+  std::vector< double > marginalSums( this->GetNumberOfBinsPerAxis(), 0.0 );
+
+  // Scratch buffer of the run length features
+  vnl_matrix<unsigned int> runLengthHistogram;
+  if( m_ComputeRunLengthFeatures )
+    {
+    runLengthHistogram.set_size( this->GetNumberOfBinsPerAxis(), this->GetNumberOfBinsPerAxis() );
+    }
+
+  for( const OutputRegionType & region : regions )
+    {
+    // The halo of the digitized image and the padded requested region of
+    // the input image hold all the neighborhoods of the region, inside of the
+    // image for the input, they are read directly from their buffers
+    DigitizedNeighborhoodIteratorType digitizedNIt( m_NeighborhoodRadius, digitizedImage, region );
+    InputNeighborhoodIteratorType inputNIt( m_NeighborhoodRadius, this->GetInput(),
+      m_ComputeFirstOrderFeatures ? region : OutputRegionType() );
+    using OutputIteratorType = typename TextureFeatureOutputIterator< TOutput >::Type;
+    OutputIteratorType outputIt( output, region );
+
+    // The histograms can only be updated incrementally from the ones of the
+    // previous voxel of the same scan line.
+    const IndexValueType lineStart = region.GetIndex( 0 );
+    bool histogramsAreValid = false;
+    FirstOrderHistogramType firstOrderHistogram;
+
+    // Iteration over the all image region
+    while( !digitizedNIt.IsAtEnd() )
+      {
+      // If the voxel is outside of the mask, don't treat it
+      if( digitizedNIt.GetCenterPixel() == outsideMaskValue ) //the pixel is outside of the mask
+        {
+        outputPixel.Fill(0);
+        outputIt.Set(outputPixel);
+        histogramsAreValid = false;
+        ++digitizedNIt;
+        if( m_ComputeFirstOrderFeatures )
+          {
+          ++inputNIt;
+          }
+        ++outputIt;
+        continue;
+        }
+
+      const bool slideFromPreviousVoxel = histogramsAreValid && digitizedNIt.GetIndex()[0] != lineStart;
+      unsigned int component = 0;
+      if( m_ComputeCoocurrenceFeatures )
+        {
+        m_CoocurrenceFilter->ComputeVoxelFeatures( digitizedNIt, slideFromPreviousVoxel, hist,
+                                                   totalNumberOfFreq, marginalSums.data(), coocurrencePixel );
+        for( unsigned int i = 0; i < coocurrencePixel.GetSize(); ++i )
+          {
+          outputPixel[component++] = coocurrencePixel[i];
+          }
+        }
+      if( m_ComputeRunLengthFeatures )
+        {
+        m_RunLengthFilter->ComputeVoxelFeatures( digitizedNIt, runLengthHistogram, runLengthPixel );
+        for( unsigned int i = 0; i < runLengthPixel.GetSize(); ++i )
+          {
+          outputPixel[component++] = runLengthPixel[i];
+          }
+        }
+      if( m_ComputeFirstOrderFeatures )
+        {
+        this->ComputeFirstOrderFeatures( inputNIt, imageRegion, slideFromPreviousVoxel,
+                                         firstOrderHistogram, firstOrderPixel );
+        for( unsigned int i = 0; i < 8; ++i )
+          {
+          outputPixel[component++] = firstOrderPixel[i];
+          }
+        }
+      outputIt.Set(outputPixel);
+      histogramsAreValid = true;
+
+      ++digitizedNIt;
+      if( m_ComputeFirstOrderFeatures )
+        {
+        ++inputNIt;
+        }
+      ++outputIt;
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TNeighborhoodIterator>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::ComputeFirstOrderFeatures( const TNeighborhoodIterator & inputNIt,
+                             const InputRegionType & imageRegion,
+                             bool slideFromPreviousVoxel,
+                             FirstOrderHistogramType & hist,
+                             FeaturePixelType & outputPixel )
+{
+  // The neighbors outside of the image are not buffered and not counted:
+  // they are skipped, which is only tested near the boundary
+  const typename InputImageType::IndexType & index = inputNIt.GetIndex();
+  typename InputRegionType::SizeType hoodSize;
+  hoodSize.Fill( 1 );
+  InputRegionType hoodRegion( index, hoodSize );
+  hoodRegion.PadByRadius( m_NeighborhoodRadius );
+  const bool hoodIsInImage = imageRegion.IsInside( hoodRegion );
+
+  if( slideFromPreviousVoxel )
+    {
+    // Add the slice entering the neighborhood, the leaving one has already
+    // been removed after processing the previous voxel
+    for( const NeighborIndexType nb : m_EnteringIndices )
+      {
+      if( hoodIsInImage || imageRegion.IsInside( index + m_NeighborOffsets[nb] ) )
+        {
+        hist.AddPixel( inputNIt.GetPixel( nb ) );
+        }
+      }
+    }
+  else
+    {
+    hist.Clear();
+    for( NeighborIndexType nb = 0; nb < inputNIt.Size(); ++nb )
+      {
+      if( hoodIsInImage || imageRegion.IsInside( index + m_NeighborOffsets[nb] ) )
+        {
+        hist.AddPixel( inputNIt.GetPixel( nb ) );
+        }
+      }
+    }
+
+  outputPixel = hist.GetValue( inputNIt.GetCenterPixel() );
+
+  // Remove the slice that will leave the neighborhood when moving to the
+  // next voxel
+  for( const NeighborIndexType nb : m_LeavingIndices )
+    {
+    if( hoodIsInImage || imageRegion.IsInside( index + m_NeighborOffsets[nb] ) )
+      {
+      hist.RemovePixel( inputNIt.GetPixel( nb ) );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeatureBankImageFilter<TInputImage, TOutputImage, TMaskImage>
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NeighborhoodRadius: "
+    << static_cast< typename NumericTraits<
+    NeighborhoodRadiusType >::PrintType >( m_NeighborhoodRadius ) << std::endl;
+
+  itkPrintSelfObjectMacro( Offsets );
+
+  os << indent << "Min: "
+    << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMinimum )
+    << std::endl;
+  os << indent << "Max: "
+    << static_cast< typename NumericTraits< PixelType >::PrintType >( m_HistogramMaximum )
+    << std::endl;
+  os << indent << "MinDistance: "
+    << static_cast< typename NumericTraits< RealType >::PrintType >(
+    m_HistogramDistanceMinimum ) << std::endl;
+  os << indent << "MaxDistance: "
+    << static_cast< typename NumericTraits< RealType >::PrintType >(
+    m_HistogramDistanceMaximum ) << std::endl;
+  os << indent << "ComputeCoocurrenceFeatures: " << m_ComputeCoocurrenceFeatures << std::endl;
+  os << indent << "ComputeRunLengthFeatures: " << m_ComputeRunLengthFeatures << std::endl;
+  os << indent << "ComputeFirstOrderFeatures: " << m_ComputeFirstOrderFeatures << std::endl;
+  os << indent << "CoocurrenceFeatureMask: " << m_CoocurrenceFeatureMask << std::endl;
+  os << indent << "RunLengthFeatureMask: " << m_RunLengthFeatureMask << std::endl;
+}
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeatureImages_h
+#define itkTextureFeatureImages_h
+
+#include "itkCompactTextureFeatures.h"
+#include "itkImageRegionIterator.h"
+
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class TextureFeatureImages
+ * \brief Write each texture feature to its own scalar image.
+ *
+ * The images share the same buffered region, so the features of a voxel are
+ * written at the same offset in all the buffers, computed once per voxel.
+ * This lets the texture feature filters write their per feature outputs in
+ * the pass computing the features, instead of a vector image split
+ * afterward.
+ *
+ * \ingroup TextureFeatures
+ */
+template< typename TFeatureImage >
+class TextureFeatureImages
+{
+public:
+  using ImageType = TFeatureImage;
+  using ValueType = typename TFeatureImage::PixelType;
+  using RegionType = typename TFeatureImage::RegionType;
+
+  explicit TextureFeatureImages( const std::vector< TFeatureImage * > & images ) :
+    m_Images( images )
+  {
+    for( TFeatureImage * image : m_Images )
+      {
+      m_Buffers.push_back( image->GetBufferPointer() );
+      }
+  }
+
+  unsigned int GetNumberOfComponentsPerPixel() const { return static_cast< unsigned int >( m_Images.size() ); }
+
+  /** Set the voxels of the region of all the images to value. */
+  void FillRegion( const RegionType & region, const ValueType & value )
+  {
+    for( TFeatureImage * image : m_Images )
+      {
+      for( ImageRegionIterator< TFeatureImage > it( image, region ); !it.IsAtEnd(); ++it )
+        {
+        it.Set( value );
+        }
+      }
+  }
+
+  /** Write the components of the feature pixels of a region to the images. */
+  class Iterator
+  {
+  public:
+    Iterator( TextureFeatureImages * features, const RegionType & region ) :
+      m_PositionIt( features->m_Images[0], region ),
+      m_FirstBuffer( features->m_Buffers[0] ),
+      m_Buffers( features->m_Buffers )
+    {}
+
+    template< typename TPixel >
+    void Set( const TPixel & pixel )
+    {
+      const OffsetValueType offset = &m_PositionIt.Value() - m_FirstBuffer;
+      for( unsigned int i = 0; i < m_Buffers.size(); ++i )
+        {
+        m_Buffers[i][offset] = static_cast< ValueType >( pixel[i] );
+        }
+    }
+
+    Iterator & operator++()
+    {
+      ++m_PositionIt;
+      return *this;
+    }
+
+  private:
+    ImageRegionIterator< TFeatureImage > m_PositionIt;
+    const ValueType *                    m_FirstBuffer;
+    const std::vector< ValueType * > &   m_Buffers;
+  };
+
+private:
+  std::vector< TFeatureImage * > m_Images;
+  std::vector< ValueType * >     m_Buffers;
+};
+
+template< typename TFeatureImage >
+struct TextureFeatureOutputIterator< TextureFeatureImages< TFeatureImage > >
+{
+  using Type = typename TextureFeatureImages< TFeatureImage >::Iterator;
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
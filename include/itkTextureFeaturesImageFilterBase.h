@@ -0,0 +1,314 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeaturesImageFilterBase_h
+#define itkTextureFeaturesImageFilterBase_h
+
+#include "itkImageToImageFilter.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkTextureMaskBlocks.h"
+#include "itkTextureUniformNeighborhoods.h"
+#include "itkCompactTextureFeatures.h"
+#include "itkTextureFeatureImages.h"
+#include "itkDigitizerFunctor.h"
+
+namespace itk
+{
+namespace Statistics
+{
+/** \class TextureFeaturesImageFilterBase
+ *  \brief Base class of the filters computing texture features from the
+ *  neighborhood of each voxel of a digitized image.
+ *
+ * This class holds the plumbing shared by the texture feature filters: it
+ * digitizes the input image and the mask, or takes the image digitized
+ * upstream by a DigitizerImageFilter, pads it with a halo of the
+ * neighborhood radius, locates the voxels inside of the mask, and splits
+ * them in work units of balanced cost. The features are written to the
+ * vector image output, to the compact output when CompactOutput is on, or to
+ * one scalar image per feature when SeparateFeatureOutputs is on.
+ *
+ * The subclasses provide the neighborhood radius, the intensity range, the
+ * number of output components, and compute the features of the regions of
+ * voxels with ComputeRegionsFeatures().
+ *
+ * \sa CoocurrenceTextureFeaturesImageFilter
+ * \sa RunLengthTextureFeaturesImageFilter
+ * \sa TextureFeatureBankImageFilter
+ *
+ * \ingroup TextureFeatures
+ **/
+
+template< typename TInputImage,
+          typename TOutputImage,
+          typename TMaskImage = Image< unsigned char, TInputImage::ImageDimension> >
+class ITK_TEMPLATE_EXPORT TextureFeaturesImageFilterBase
+  : public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  /** Standard type alias */
+  using Self = TextureFeaturesImageFilterBase;
+  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TextureFeaturesImageFilterBase, ImageToImageFilter);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using MaskImageType = TMaskImage;
+
+  using PixelType = typename InputImageType::PixelType;
+  using MaskPixelType = typename MaskImageType::PixelType;
+  using IndexType = typename InputImageType::IndexType;
+  using PointType = typename InputImageType::PointType;
+
+  using OffsetType = typename InputImageType::OffsetType;
+  using OffsetVector = VectorContainer< unsigned char, OffsetType >;
+  using OffsetVectorPointer = typename OffsetVector::Pointer;
+  using OffsetVectorConstPointer = typename OffsetVector::ConstPointer;
+
+  using InputRegionType = typename InputImageType::RegionType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+
+  using NeighborhoodRadiusType = typename itk::ConstNeighborhoodIterator< InputImageType >::RadiusType;
+
+  using MeasurementType = typename NumericTraits<PixelType>::RealType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputRealType = typename NumericTraits< OutputPixelType >::ScalarRealType;
+
+  /** Method to set the mask image */
+  itkSetInputMacro(MaskImage, MaskImageType);
+
+  /** Method to get the mask image */
+  itkGetInputMacro(MaskImage, MaskImageType);
+
+  /** Method to set/get the image digitized by a DigitizerImageFilter, of
+   * uint8_t or uint16_t pixels. When set, the input image and the mask image
+   * are not digitized again: the DigitizerImageFilter must use the same mask,
+   * inside pixel value, intensity range and number of bins as this filter.
+   * The number of bins and the intensity range recorded by the
+   * DigitizerImageFilter in the MetaDataDictionary of the image are checked
+   * against the ones of this filter, and so are whether a mask was used and
+   * its inside pixel value when the MaskImage of this filter is set. Without
+   * MaskImage, the mask settings of this filter are ignored and the voxels
+   * outside of the mask of the DigitizedImage are skipped. The image is copied with the halo of
+   * the neighborhoods unless the HaloRadius of the DigitizerImageFilter is at
+   * least the largest neighborhood radius. */
+  using DigitizedImageBaseType = ImageBase< TInputImage::ImageDimension >;
+  itkSetInputMacro(DigitizedImage, DigitizedImageBaseType);
+  itkGetInputMacro(DigitizedImage, DigitizedImageBaseType);
+
+  /** Specify the default number of bins per axis */
+  static constexpr unsigned int DefaultBinsPerAxis = 256;
+
+  /** Set number of histogram bins along each axis */
+  itkSetMacro( NumberOfBinsPerAxis, unsigned int );
+
+  /** Get number of histogram bins along each axis */
+  itkGetConstMacro( NumberOfBinsPerAxis, unsigned int );
+
+  /**
+   * Set the pixel value of the mask that should be considered "inside" the
+   * object. Defaults to 1.
+   */
+  itkSetMacro( InsidePixelValue, MaskPixelType );
+  itkGetConstMacro( InsidePixelValue, MaskPixelType );
+
+  /** Number of components of the output pixels for the selected features.
+   * An output of fixed length vectors must have exactly as many. */
+  virtual unsigned int GetNumberOfOutputComponents() const = 0;
+
+  /** Features of the voxels inside of the mask only. */
+  using CompactFeaturesType = CompactTextureFeatures< TOutputImage >;
+
+  /** Set/Get whether the features are only computed for the voxels inside
+   * of the mask, into the compact output. The image output is then not
+   * allocated, so the memory footprint depends on the size of the mask
+   * instead of the size of the image. Off by default. */
+  itkSetMacro(CompactOutput, bool);
+  itkGetConstMacro(CompactOutput, bool);
+  itkBooleanMacro(CompactOutput);
+
+  /** Get the compact output, holding the features when CompactOutput is on.
+   * CompactTextureFeatures::ScatterToImage() converts it to an image. */
+  CompactFeaturesType * GetCompactOutput();
+
+  /** Scalar image of a single feature. */
+  using ScalarFeatureImageType = Image< OutputRealType, TInputImage::ImageDimension >;
+
+  /** Set/Get whether each feature is written to its own scalar image,
+   * GetFeatureOutput(), in the pass computing the features. The vector image
+   * output is then not allocated, so the features do not need to be split
+   * out of it afterward. Off by default. */
+  itkSetMacro(SeparateFeatureOutputs, bool);
+  itkGetConstMacro(SeparateFeatureOutputs, bool);
+  itkBooleanMacro(SeparateFeatureOutputs);
+
+  /** Get the scalar image of the selected feature of index feature, in the
+   * order of the components of the vector image output, when
+   * SeparateFeatureOutputs is on. */
+  ScalarFeatureImageType * GetFeatureOutput( unsigned int feature );
+
+  using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer MakeOutput( DataObjectPointerArraySizeType idx ) override;
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  // Begin concept checking
+  itkConceptMacro( OutputPixelTypeCheck,
+                   ( Concept::IsFloatingPoint< OutputRealType > ) );
+  // End concept checking
+#endif
+
+protected:
+
+  /** The input is digitized into the narrowest image type able to hold
+   * NumberOfBinsPerAxis bins plus the reserved values of the Digitizer. */
+  using NarrowDigitizedImageType = itk::Image< uint8_t, TInputImage::ImageDimension >;
+  using WideDigitizedImageType = itk::Image< uint16_t, TInputImage::ImageDimension >;
+  using NeighborIndexType = typename itk::ConstNeighborhoodIterator< NarrowDigitizedImageType >::NeighborIndexType;
+  using MaskBlocksType = TextureMaskBlocks< TInputImage::ImageDimension >;
+  using UniformNeighborhoodsType = TextureUniformNeighborhoods< TInputImage::ImageDimension >;
+  using RegionVectorType = typename MaskBlocksType::RegionVectorType;
+  using FeatureImagesType = TextureFeatureImages< ScalarFeatureImageType >;
+
+  /** The filter has one scalar image output per feature, up to
+   * maximumNumberOfFeatures when all of them are selected. */
+  explicit TextureFeaturesImageFilterBase( unsigned int maximumNumberOfFeatures );
+  ~TextureFeaturesImageFilterBase() override {}
+
+  /** Radius of the neighborhood read around each voxel. */
+  virtual const NeighborhoodRadiusType & GetLargestNeighborhoodRadius() const = 0;
+
+  /** Intensity range of the bins the input is digitized into. */
+  virtual PixelType GetDigitizerMinimum() const = 0;
+  virtual PixelType GetDigitizerMaximum() const = 0;
+
+  /** Whether the voxels whose neighborhood is uniform or in range are
+   * located in BeforeThreadedGenerateData(). Off by default. */
+  virtual bool UsesUniformNeighborhoodsTable() const { return false; }
+
+  /** Estimated cost of a voxel inside of the mask relative to the one of a
+   * voxel outside of it, once the neighborhood tables are computed. */
+  virtual double EstimateInsideVoxelCost() const = 0;
+
+  /** Compute the features of the regions into the output, an image, the
+   * compact output or the scalar images of the features. */
+  virtual void ComputeRegionsFeatures( const RegionVectorType & regions, OutputImageType * output ) = 0;
+  virtual void ComputeRegionsFeatures( const RegionVectorType & regions, CompactFeaturesType * output ) = 0;
+  virtual void ComputeRegionsFeatures( const RegionVectorType & regions, FeatureImagesType * output ) = 0;
+
+  /** The digitized image padded with a halo of the neighborhood radius, of
+   * type NarrowDigitizedImageType or WideDigitizedImageType, between
+   * BeforeThreadedGenerateData() and AfterThreadedGenerateData(). */
+  const DigitizedImageBaseType * GetDigitizedInputImage() const
+    {
+    return m_DigitizedInputImage.GetPointer();
+    }
+
+  /** The voxels whose neighborhood is uniform or in range, when
+   * UsesUniformNeighborhoodsTable() is true. */
+  const UniformNeighborhoodsType & GetUniformNeighborhoods() const
+    {
+    return m_UniformNeighborhoods;
+    }
+
+  /** Check that the number of bins, the intensity range and, when the
+   * MaskImage is set, the mask settings recorded in the MetaDataDictionary of
+   * the DigitizedImage, if any, are the ones of this filter. */
+  void VerifyDigitizedImageMetaData() const;
+
+  /** Digitize the input image and the mask into m_DigitizedInputImage,
+   * allocated with the halo of the largest neighborhood radius around the
+   * output requested region, where the voxels at the boundary of the image
+   * are replicated. */
+  template< typename TDigitizedImage >
+  void DigitizeInput();
+
+  /** Copy the DigitizedImage in an image also holding the halo of the
+   * largest neighborhood radius around the output requested region, unless
+   * it already does, e.g. when it was computed with this HaloRadius. */
+  template< typename TDigitizedImage >
+  typename TDigitizedImage::ConstPointer PadDigitizedImage() const;
+
+  /** Find the voxels of the output requested region inside of the mask in
+   * m_DigitizedInputImage: the runs of the compact output when CompactOutput
+   * is on, the occupied blocks otherwise. Then find the voxels whose
+   * neighborhood is uniform or in range when they are used. */
+  template< typename TDigitizedImage >
+  void LocateMaskVoxels();
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Check that the options of the filter are compatible. */
+  void VerifyPreconditions() ITKv5_CONST override;
+
+  /** Digitize and pad the input, and locate the voxels inside of the mask. */
+  void BeforeThreadedGenerateData() override;
+
+  /** Free the digitized image. */
+  void AfterThreadedGenerateData() override;
+
+  /** Compute the features of the occupied blocks of the mask in the region,
+   * and fill the rest of the region with zeros. */
+  void DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread ) override;
+
+  /** Set the number of components of the output pixels. Throw an exception
+   * when the output pixels have a fixed length that differs from
+   * GetNumberOfOutputComponents(). */
+  void GenerateOutputInformation() override;
+
+  /** The features of a voxel depend on its whole neighborhood, so the
+   * requested region of each input image is padded by the neighborhood
+   * radius. */
+  void GenerateInputRequestedRegion() override;
+
+  /** The compact output has no region: it holds the voxels of the
+   * requested region of the image output, the largest possible region
+   * when none is requested. */
+  void GenerateOutputRequestedRegion( DataObject * output ) override;
+
+  /** Allocate the vector image output, or the scalar images of the selected
+   * features when SeparateFeatureOutputs is on. */
+  void AllocateOutputs() override;
+
+  /** Split the output requested region in work units of balanced cost,
+   * according to the number of voxels inside of the mask in each slice, and
+   * process them with DynamicThreadedGenerateData. */
+  void GenerateData() override;
+
+private:
+  typename DigitizedImageBaseType::ConstPointer m_DigitizedInputImage;
+  MaskBlocksType                                m_MaskBlocks;
+  UniformNeighborhoodsType                      m_UniformNeighborhoods;
+  unsigned int                                  m_NumberOfBinsPerAxis;
+  MaskPixelType                                 m_InsidePixelValue;
+  bool                                          m_CompactOutput;
+  bool                                          m_SeparateFeatureOutputs;
+};
+} // end of namespace Statistics
+} // end of namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTextureFeaturesImageFilterBase.hxx"
+#endif
+
+#endif
@@ -0,0 +1,539 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeaturesImageFilterBase_hxx
+#define itkTextureFeaturesImageFilterBase_hxx
+
+#include "itkTextureFeaturesImageFilterBase.h"
+#include "itkZeroFluxNeumannPadImageFilter.h"
+#include "itkDigitizerImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMetaDataObject.h"
+
+namespace itk
+{
+namespace Statistics
+{
+template< typename TInputImage, typename TOutputImage, typename TMaskImage>
+TextureFeaturesImageFilterBase< TInputImage, TOutputImage, TMaskImage>
+::TextureFeaturesImageFilterBase( unsigned int maximumNumberOfFeatures ) :
+    m_NumberOfBinsPerAxis( itkGetStaticConstMacro( DefaultBinsPerAxis ) ),
+    m_InsidePixelValue( NumericTraits<MaskPixelType>::OneValue() ),
+    m_CompactOutput( false ),
+    m_SeparateFeatureOutputs( false )
+{
+  this->SetNumberOfRequiredInputs( 1 );
+  this->SetNumberOfRequiredOutputs( 2 );
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+  for( unsigned int feature = 0; feature < maximumNumberOfFeatures; ++feature )
+    {
+    this->SetNthOutput( 2 + feature, this->MakeOutput( 2 + feature ) );
+    }
+
+  // Mark the "MaskImage" as an optional named input. First it has to
+  // be added to the list of named inputs then removed from the
+  // required list.
+  Self::AddRequiredInputName("MaskImage");
+  Self::RemoveRequiredInputName("MaskImage");
+  Self::AddRequiredInputName("DigitizedImage");
+  Self::RemoveRequiredInputName("DigitizedImage");
+
+  this->DynamicMultiThreadingOn();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::VerifyPreconditions() ITKv5_CONST
+{
+  Superclass::VerifyPreconditions();
+
+  using WideDigitizerType = Digitizer< PixelType, PixelType, typename WideDigitizedImageType::PixelType >;
+  if( m_NumberOfBinsPerAxis > WideDigitizerType::GetMaximumNumberOfBins() )
+    {
+    itkExceptionMacro( "NumberOfBinsPerAxis is " << m_NumberOfBinsPerAxis << " but must be at most "
+                       << WideDigitizerType::GetMaximumNumberOfBins() );
+    }
+  if( m_CompactOutput && m_SeparateFeatureOutputs )
+    {
+    itkExceptionMacro( "CompactOutput and SeparateFeatureOutputs cannot be both on" );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  using NarrowDigitizerType = Digitizer< PixelType, PixelType, typename NarrowDigitizedImageType::PixelType >;
+
+  if( this->GetDigitizedImage() != nullptr )
+    {
+    // The input has been digitized upstream
+    if( dynamic_cast< const NarrowDigitizedImageType * >( this->GetDigitizedImage() ) == nullptr
+        && dynamic_cast< const WideDigitizedImageType * >( this->GetDigitizedImage() ) == nullptr )
+      {
+      itkExceptionMacro( "The pixel type of the DigitizedImage must be uint8_t or uint16_t" );
+      }
+    this->VerifyDigitizedImageMetaData();
+    m_DigitizedInputImage = this->GetDigitizedImage();
+
+    // The digitized image may have been computed without the halo of the
+    // neighborhoods
+    if( dynamic_cast< const NarrowDigitizedImageType * >( m_DigitizedInputImage.GetPointer() ) != nullptr )
+      {
+      m_DigitizedInputImage = this->template PadDigitizedImage< NarrowDigitizedImageType >();
+      }
+    else
+      {
+      m_DigitizedInputImage = this->template PadDigitizedImage< WideDigitizedImageType >();
+      }
+    }
+  else if( m_NumberOfBinsPerAxis <= NarrowDigitizerType::GetMaximumNumberOfBins() )
+    {
+    this->template DigitizeInput< NarrowDigitizedImageType >();
+    }
+  else
+    {
+    this->template DigitizeInput< WideDigitizedImageType >();
+    }
+
+  if( dynamic_cast< const NarrowDigitizedImageType * >( m_DigitizedInputImage.GetPointer() ) != nullptr )
+    {
+    this->template LocateMaskVoxels< NarrowDigitizedImageType >();
+    }
+  else
+    {
+    this->template LocateMaskVoxels< WideDigitizedImageType >();
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::VerifyDigitizedImageMetaData() const
+{
+  // An image not produced by a DigitizerImageFilter, e.g. read from a file,
+  // may not record its parameters
+  const MetaDataDictionary & dictionary = this->GetDigitizedImage()->GetMetaDataDictionary();
+
+  unsigned int numberOfBinsPerAxis = 0;
+  if( ExposeMetaData< unsigned int >( dictionary, "NumberOfBinsPerAxis", numberOfBinsPerAxis )
+      && numberOfBinsPerAxis != m_NumberOfBinsPerAxis )
+    {
+    itkExceptionMacro( "The DigitizedImage has " << numberOfBinsPerAxis << " bins but NumberOfBinsPerAxis is "
+                       << m_NumberOfBinsPerAxis );
+    }
+
+  double histogramMinimum = 0.0;
+  double histogramMaximum = 0.0;
+  if( ExposeMetaData< double >( dictionary, "HistogramMinimum", histogramMinimum )
+      && ExposeMetaData< double >( dictionary, "HistogramMaximum", histogramMaximum )
+      && ( histogramMinimum != static_cast< double >( this->GetDigitizerMinimum() )
+           || histogramMaximum != static_cast< double >( this->GetDigitizerMaximum() ) ) )
+    {
+    itkExceptionMacro( "The DigitizedImage has the intensity range [" << histogramMinimum << ", "
+                       << histogramMaximum << "] but the range of this filter is ["
+                       << static_cast< typename NumericTraits< PixelType >::PrintType >( this->GetDigitizerMinimum() )
+                       << ", "
+                       << static_cast< typename NumericTraits< PixelType >::PrintType >( this->GetDigitizerMaximum() )
+                       << "]" );
+    }
+
+  // Without a mask, this filter takes the voxels outside of the mask of the
+  // DigitizedImage as they are
+  bool usesMask = false;
+  if( this->GetMaskImage() != nullptr && ExposeMetaData< bool >( dictionary, "UsesMask", usesMask ) )
+    {
+    if( !usesMask )
+      {
+      itkExceptionMacro( "The DigitizedImage was computed without mask but the MaskImage is set" );
+      }
+    double insidePixelValue = 0.0;
+    if( ExposeMetaData< double >( dictionary, "InsidePixelValue", insidePixelValue )
+        && insidePixelValue != static_cast< double >( m_InsidePixelValue ) )
+      {
+      itkExceptionMacro( "The mask of the DigitizedImage has the inside pixel value " << insidePixelValue
+                         << " but InsidePixelValue is "
+                         << static_cast< typename NumericTraits< MaskPixelType >::PrintType >( m_InsidePixelValue ) );
+      }
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TDigitizedImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::DigitizeInput()
+{
+  using DigitizerType = DigitizerImageFilter< TInputImage, TMaskImage, TDigitizedImage >;
+  typename DigitizerType::Pointer digitizer = DigitizerType::New();
+
+  typename TInputImage::Pointer input = InputImageType::New();
+  input->Graft(const_cast<TInputImage *>(this->GetInput()));
+  digitizer->SetInput(input);
+  if (this->GetMaskImage() != nullptr)
+    {
+    typename TMaskImage::Pointer mask = MaskImageType::New();
+    mask->Graft(const_cast<TMaskImage *>(this->GetMaskImage()));
+    digitizer->SetMaskImage(mask);
+    }
+  digitizer->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  digitizer->SetHistogramMinimum(this->GetDigitizerMinimum());
+  digitizer->SetHistogramMaximum(this->GetDigitizerMaximum());
+  digitizer->SetInsidePixelValue(m_InsidePixelValue);
+  digitizer->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+
+  // Only digitize the output requested region and the halo of its
+  // neighborhoods, where the digitized voxels at the boundary of the image
+  // are replicated, so that all the neighborhoods of the output lie in the
+  // buffer of the digitized image and are processed without boundary
+  // condition
+  digitizer->SetHaloRadius(this->GetLargestNeighborhoodRadius());
+  OutputRegionType haloRegion = this->GetOutput()->GetRequestedRegion();
+  haloRegion.PadByRadius(this->GetLargestNeighborhoodRadius());
+  digitizer->GetOutput()->SetRequestedRegion(haloRegion);
+  digitizer->Update();
+  m_DigitizedInputImage = digitizer->GetOutput();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TDigitizedImage>
+typename TDigitizedImage::ConstPointer
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::PadDigitizedImage() const
+{
+  const auto * digitizedImage = static_cast< const TDigitizedImage * >( m_DigitizedInputImage.GetPointer() );
+
+  typename TDigitizedImage::RegionType haloRegion = this->GetOutput()->GetRequestedRegion();
+  haloRegion.PadByRadius( this->GetLargestNeighborhoodRadius() );
+  if( digitizedImage->GetBufferedRegion().IsInside( haloRegion ) )
+    {
+    return digitizedImage;
+    }
+
+  typename TDigitizedImage::Pointer digitized = TDigitizedImage::New();
+  digitized->Graft( const_cast< TDigitizedImage * >( digitizedImage ) );
+
+  using PadFilterType = ZeroFluxNeumannPadImageFilter< TDigitizedImage, TDigitizedImage >;
+  typename PadFilterType::Pointer padFilter = PadFilterType::New();
+  padFilter->SetInput( digitized );
+  padFilter->SetPadBound( this->GetLargestNeighborhoodRadius() );
+  padFilter->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+
+  padFilter->GetOutput()->SetRequestedRegion( haloRegion );
+  padFilter->Update();
+  return padFilter->GetOutput();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+template<typename TDigitizedImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::LocateMaskVoxels()
+{
+  using DigitizerFunctorType = Digitizer< PixelType, PixelType, typename TDigitizedImage::PixelType >;
+  const auto * digitizedImage = static_cast< const TDigitizedImage * >( m_DigitizedInputImage.GetPointer() );
+  const OutputRegionType & region = this->GetOutput()->GetRequestedRegion();
+
+  m_UniformNeighborhoods.Clear();
+  if( this->UsesUniformNeighborhoodsTable() )
+    {
+    m_UniformNeighborhoods.Compute( digitizedImage, region, this->GetLargestNeighborhoodRadius(),
+                                    DigitizerFunctorType::GetOutOfRangeValue() );
+    }
+
+  if( m_CompactOutput )
+    {
+    CompactFeaturesType * compactOutput = this->GetCompactOutput();
+    compactOutput->CopyImageInformation( this->GetOutput() );
+    compactOutput->Allocate( digitizedImage, DigitizerFunctorType::GetOutsideMaskValue(),
+                             this->GetOutput()->GetNumberOfComponentsPerPixel() );
+    return;
+    }
+
+  if( this->GetMaskImage() == nullptr && this->GetDigitizedImage() == nullptr )
+    {
+    // All the voxels are inside of the mask
+    m_MaskBlocks.SetAllOccupied( region );
+    return;
+    }
+
+  m_MaskBlocks.Compute( digitizedImage, region, DigitizerFunctorType::GetOutsideMaskValue() );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::AfterThreadedGenerateData()
+{
+  // Free internal image
+  this->m_DigitizedInputImage = nullptr;
+  this->m_UniformNeighborhoods.Clear();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GenerateData()
+{
+  // Empty the outputs not written by this update, so that none of them
+  // holds the features of a previous update with other options
+  if( m_CompactOutput || m_SeparateFeatureOutputs )
+    {
+    this->GetOutput()->Initialize();
+    }
+  const unsigned int numberOfFeatureOutputs =
+    m_SeparateFeatureOutputs ? this->GetOutput()->GetNumberOfComponentsPerPixel() : 0;
+  for( unsigned int feature = numberOfFeatureOutputs; 2 + feature < this->GetNumberOfIndexedOutputs(); ++feature )
+    {
+    this->GetFeatureOutput( feature )->Initialize();
+    }
+
+  CompactFeaturesType * compactOutput = this->GetCompactOutput();
+  compactOutput->Initialize();
+  if( m_CompactOutput )
+    {
+    // The image output is not allocated, the features of the runs of voxels
+    // inside of the mask are written to the rows of the compact output
+    this->BeforeThreadedGenerateData();
+
+    const std::vector< SizeValueType > runBounds = compactOutput->SplitRuns( this->GetNumberOfWorkUnits() );
+    this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+    this->GetMultiThreader()->ParallelizeArray( 0, runBounds.size() - 1,
+      [this, compactOutput, &runBounds]( SizeValueType i )
+        {
+        RegionVectorType runRegions;
+        for( SizeValueType r = runBounds[i]; r < runBounds[i + 1]; ++r )
+          {
+          runRegions.push_back( compactOutput->GetRunRegion( compactOutput->GetRuns()[r] ) );
+          }
+        this->ComputeRegionsFeatures( runRegions, compactOutput );
+        },
+      this );
+
+    this->AfterThreadedGenerateData();
+    return;
+    }
+
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  // The geometric split of the multi-threader gives most of the voxels of a
+  // sparse mask to a few work units, so the slabs are balanced by cost
+  const RegionVectorType workUnitRegions =
+    m_MaskBlocks.SplitRegion( this->GetNumberOfWorkUnits(), this->EstimateInsideVoxelCost() );
+  this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+  this->GetMultiThreader()->ParallelizeArray( 0, workUnitRegions.size(),
+    [this, &workUnitRegions]( SizeValueType i ) { this->DynamicThreadedGenerateData( workUnitRegions[i] ); },
+    this );
+
+  this->AfterThreadedGenerateData();
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::DynamicThreadedGenerateData( const OutputRegionType & outputRegionForThread )
+{
+  // Only the occupied blocks of the mask are visited, the rest of the
+  // output is filled with zeros
+  const RegionVectorType occupiedRegions = m_MaskBlocks.GetOccupiedRegions( outputRegionForThread );
+  const bool fillWithZeros = occupiedRegions.size() != 1 || occupiedRegions[0] != outputRegionForThread;
+
+  if( m_SeparateFeatureOutputs )
+    {
+    std::vector< ScalarFeatureImageType * > featureImages;
+    for( unsigned int feature = 0; feature < this->GetOutput()->GetNumberOfComponentsPerPixel(); ++feature )
+      {
+      featureImages.push_back( this->GetFeatureOutput( feature ) );
+      }
+    FeatureImagesType separateOutput( featureImages );
+    if( fillWithZeros )
+      {
+      separateOutput.FillRegion( outputRegionForThread, NumericTraits< OutputRealType >::ZeroValue() );
+      }
+    this->ComputeRegionsFeatures( occupiedRegions, &separateOutput );
+    return;
+    }
+
+  OutputImageType * outputPtr = this->GetOutput();
+  if( fillWithZeros )
+    {
+    OutputPixelType zeroPixel;
+    NumericTraits<OutputPixelType>::SetLength(zeroPixel, outputPtr->GetNumberOfComponentsPerPixel());
+    zeroPixel.Fill(0);
+    for( ImageRegionIterator< OutputImageType > zeroIt( outputPtr, outputRegionForThread ); !zeroIt.IsAtEnd(); ++zeroIt )
+      {
+      zeroIt.Set(zeroPixel);
+      }
+    }
+
+  this->ComputeRegionsFeatures( occupiedRegions, outputPtr );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GenerateInputRequestedRegion()
+{
+  // Call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  // The features of a voxel depend on its whole neighborhood, so the
+  // requested region of each input image is padded by the neighborhood
+  // radius. Only this region is digitized, which allows streaming.
+  for( const auto & input : this->GetInputs() )
+    {
+    auto * image = dynamic_cast< DigitizedImageBaseType * >( input.GetPointer() );
+    if( image == nullptr )
+      {
+      continue;
+      }
+    typename DigitizedImageBaseType::RegionType requestedRegion = image->GetRequestedRegion();
+    requestedRegion.PadByRadius( this->GetLargestNeighborhoodRadius() );
+    if( !requestedRegion.Crop( image->GetLargestPossibleRegion() ) )
+      {
+      // Store what we tried to request (prior to trying to crop)
+      image->SetRequestedRegion( requestedRegion );
+
+      InvalidRequestedRegionError e( __FILE__, __LINE__ );
+      e.SetLocation( ITK_LOCATION );
+      e.SetDescription( "Requested region is (at least partially) outside the largest possible region." );
+      e.SetDataObject( image );
+      throw e;
+      }
+    image->SetRequestedRegion( requestedRegion );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+typename TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>::CompactFeaturesType *
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GetCompactOutput()
+{
+  return itkDynamicCastInDebugMode< CompactFeaturesType * >( this->ProcessObject::GetOutput( 1 ) );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+typename TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>::ScalarFeatureImageType *
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GetFeatureOutput( unsigned int feature )
+{
+  return itkDynamicCastInDebugMode< ScalarFeatureImageType * >( this->ProcessObject::GetOutput( 2 + feature ) );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::AllocateOutputs()
+{
+  OutputImageType * outputPtr = this->GetOutput();
+  if( !m_SeparateFeatureOutputs )
+    {
+    outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
+    outputPtr->Allocate();
+    return;
+    }
+
+  for( unsigned int feature = 0; feature < outputPtr->GetNumberOfComponentsPerPixel(); ++feature )
+    {
+    ScalarFeatureImageType * featureOutput = this->GetFeatureOutput( feature );
+    featureOutput->SetBufferedRegion( outputPtr->GetRequestedRegion() );
+    featureOutput->Allocate();
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+DataObject::Pointer
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::MakeOutput( DataObjectPointerArraySizeType idx )
+{
+  if( idx == 1 )
+    {
+    return CompactFeaturesType::New().GetPointer();
+    }
+  if( idx >= 2 )
+    {
+    return ScalarFeatureImageType::New().GetPointer();
+    }
+  return Superclass::MakeOutput( idx );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GenerateOutputRequestedRegion( DataObject * output )
+{
+  if( dynamic_cast< CompactFeaturesType * >( output ) != nullptr )
+    {
+    OutputImageType * outputImage = this->GetOutput();
+    if( outputImage->GetRequestedRegion().GetNumberOfPixels() == 0 )
+      {
+      outputImage->SetRequestedRegionToLargestPossibleRegion();
+      }
+    return;
+    }
+  Superclass::GenerateOutputRequestedRegion( output );
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::GenerateOutputInformation()
+{
+  // Call superclass's version
+  Superclass::GenerateOutputInformation();
+
+  OutputImageType* output = this->GetOutput();
+  // If the output image type is a VectorImage the number of
+  // components will be properly sized if before allocation, if the
+  // output is a fixed width vector and the wrong number of
+  // components, then an exception is thrown before the work units
+  // write past the end of its pixels.
+  if ( output->GetNumberOfComponentsPerPixel() != this->GetNumberOfOutputComponents() )
+    {
+    output->SetNumberOfComponentsPerPixel( this->GetNumberOfOutputComponents() );
+    }
+  if ( output->GetNumberOfComponentsPerPixel() != this->GetNumberOfOutputComponents() )
+    {
+    itkExceptionMacro( "The output pixels have " << output->GetNumberOfComponentsPerPixel()
+                       << " components but the selected features need " << this->GetNumberOfOutputComponents()
+                       << ", the output must be a VectorImage" );
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+TextureFeaturesImageFilterBase<TInputImage, TOutputImage, TMaskImage>
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  itkPrintSelfObjectMacro( DigitizedInputImage );
+
+  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "InsidePixelValue: "
+    << static_cast< typename NumericTraits< MaskPixelType >::PrintType >(
+    m_InsidePixelValue ) << std::endl;
+  os << indent << "CompactOutput: " << m_CompactOutput << std::endl;
+  os << indent << "SeparateFeatureOutputs: " << m_SeparateFeatureOutputs << std::endl;
+}
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
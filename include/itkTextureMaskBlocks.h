@@ -0,0 +1,327 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureMaskBlocks_h
+#define itkTextureMaskBlocks_h
+
+#include "itkImageRegion.h"
+#include "itkImageScanlineConstIterator.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class TextureMaskBlocks
+ * \brief Bounding box and coarse occupancy map of the voxels inside of the
+ * mask in a digitized image.
+ *
+ * The region is divided in blocks of BlockSize voxels along each dimension,
+ * and a block is occupied when it holds at least one voxel inside of the
+ * mask. The texture feature filters only visit the occupied blocks, cropped
+ * to the bounding box of the mask, and fill the rest of their output with
+ * zeros.
+ *
+ * The number of voxels inside of the mask is also counted for each slice
+ * along the last dimension, to split the region in work units of balanced
+ * cost. When the region has fewer slices than work units, as a single 2D
+ * slice, the slices are also cut along the dimension before the last one.
+ *
+ * \ingroup TextureFeatures
+ */
+template< unsigned int VDimension >
+class TextureMaskBlocks
+{
+public:
+  using RegionType = ImageRegion< VDimension >;
+  using IndexType = typename RegionType::IndexType;
+  using RegionVectorType = std::vector< RegionType >;
+
+  static constexpr IndexValueType BlockSize = 8;
+
+  /** Consider all the voxels of the region inside of the mask. */
+  void SetAllOccupied( const RegionType & region )
+  {
+    m_Region = region;
+    m_BoundingBox = region;
+    m_AllOccupied = true;
+    m_Occupied.clear();
+    const SizeValueType numberOfSlices = region.GetSize( VDimension - 1 );
+    m_SliceCounts.assign( numberOfSlices, numberOfSlices > 0 ? region.GetNumberOfPixels() / numberOfSlices : 0 );
+  }
+
+  /** Find the blocks of the region holding voxels of the digitized image
+   * different from outsideMaskValue. */
+  template< typename TImage >
+  void Compute( const TImage * image, const RegionType & region, const typename TImage::PixelType & outsideMaskValue )
+  {
+    m_Region = region;
+    m_AllOccupied = false;
+    SizeValueType numberOfBlocks = 1;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      m_GridStrides[d] = numberOfBlocks;
+      numberOfBlocks *= ( region.GetSize( d ) + BlockSize - 1 ) / BlockSize;
+      }
+    m_Occupied.assign( numberOfBlocks, false );
+    m_SliceCounts.assign( region.GetSize( VDimension - 1 ), 0 );
+
+    IndexType lower = region.GetUpperIndex();
+    IndexType upper = region.GetIndex();
+    bool isEmpty = true;
+
+    ImageScanlineConstIterator< TImage > it( image, region );
+    while( !it.IsAtEnd() )
+      {
+      const IndexType lineIndex = it.GetIndex();
+      const SizeValueType lineBlock = this->GetBlock( lineIndex );
+      IndexValueType first = -1;
+      IndexValueType last = -1;
+      SizeValueType count = 0;
+      for( IndexValueType x = 0; !it.IsAtEndOfLine(); ++it, ++x )
+        {
+        if( it.Get() != outsideMaskValue )
+          {
+          m_Occupied[lineBlock + x / BlockSize] = true;
+          first = first < 0 ? x : first;
+          last = x;
+          ++count;
+          }
+        }
+      if( first >= 0 )
+        {
+        isEmpty = false;
+        m_SliceCounts[lineIndex[VDimension - 1] - region.GetIndex( VDimension - 1 )] += count;
+        lower[0] = std::min( lower[0], lineIndex[0] + first );
+        upper[0] = std::max( upper[0], lineIndex[0] + last );
+        for( unsigned int d = 1; d < VDimension; ++d )
+          {
+          lower[d] = std::min( lower[d], lineIndex[d] );
+          upper[d] = std::max( upper[d], lineIndex[d] );
+          }
+        }
+      it.NextLine();
+      }
+
+    m_BoundingBox = RegionType();
+    if( !isEmpty )
+      {
+      m_BoundingBox.SetIndex( lower );
+      m_BoundingBox.SetUpperIndex( upper );
+      }
+  }
+
+  const RegionType & GetBoundingBox() const { return m_BoundingBox; }
+
+  /** Split the part of region in the bounding box into regions covering its
+   * occupied blocks. Consecutive occupied blocks along the first dimension
+   * are merged, so that the scan lines are only cut by unoccupied blocks. */
+  RegionVectorType GetOccupiedRegions( const RegionType & region ) const
+  {
+    RegionVectorType occupiedRegions;
+    RegionType cropped = region;
+    if( m_BoundingBox.GetNumberOfPixels() == 0 || !cropped.Crop( m_BoundingBox ) )
+      {
+      return occupiedRegions;
+      }
+    if( m_AllOccupied )
+      {
+      occupiedRegions.push_back( cropped );
+      return occupiedRegions;
+      }
+
+    // Blocks overlapping the cropped region
+    IndexType firstBlock;
+    IndexType lastBlock;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      firstBlock[d] = ( cropped.GetIndex( d ) - m_Region.GetIndex( d ) ) / BlockSize;
+      lastBlock[d] = ( cropped.GetUpperIndex()[d] - m_Region.GetIndex( d ) ) / BlockSize;
+      }
+
+    IndexType block = firstBlock;
+    while( true )
+      {
+      // Maximal runs of occupied blocks along the first dimension
+      for( IndexValueType b = firstBlock[0]; b <= lastBlock[0]; ++b )
+        {
+        block[0] = b;
+        if( !m_Occupied[this->GetBlockOffset( block )] )
+          {
+          continue;
+          }
+        IndexValueType runEnd = b;
+        block[0] = runEnd + 1;
+        while( runEnd < lastBlock[0] && m_Occupied[this->GetBlockOffset( block )] )
+          {
+          block[0] = ++runEnd + 1;
+          }
+
+        IndexType lower;
+        IndexType upper;
+        lower[0] = m_Region.GetIndex( 0 ) + b * BlockSize;
+        upper[0] = m_Region.GetIndex( 0 ) + ( runEnd + 1 ) * BlockSize - 1;
+        for( unsigned int d = 1; d < VDimension; ++d )
+          {
+          lower[d] = m_Region.GetIndex( d ) + block[d] * BlockSize;
+          upper[d] = lower[d] + BlockSize - 1;
+          }
+        RegionType occupiedRegion;
+        occupiedRegion.SetIndex( lower );
+        occupiedRegion.SetUpperIndex( upper );
+        occupiedRegion.Crop( cropped );
+        occupiedRegions.push_back( occupiedRegion );
+        b = runEnd;
+        }
+
+      // Next row of blocks
+      unsigned int d = 1;
+      for(; d < VDimension; ++d )
+        {
+        if( ++block[d] <= lastBlock[d] )
+          {
+          break;
+          }
+        block[d] = firstBlock[d];
+        }
+      if( d == VDimension )
+        {
+        break;
+        }
+      }
+    return occupiedRegions;
+  }
+
+  /** Split the region along its last dimension in at most numberOfPieces
+   * slabs of about the same cost, insideVoxelCost being the cost of a voxel
+   * inside of the mask relative to the one of a voxel outside of it. When
+   * there are fewer slices than pieces, each slice is cut in rows instead. */
+  RegionVectorType SplitRegion( unsigned int numberOfPieces, double insideVoxelCost ) const
+  {
+    RegionVectorType pieces;
+    const SizeValueType numberOfSlices = m_SliceCounts.size();
+    if( m_Region.GetNumberOfPixels() == 0 || numberOfPieces == 0 )
+      {
+      return pieces;
+      }
+    const double sliceSize = static_cast< double >( m_Region.GetNumberOfPixels() / numberOfSlices );
+
+    double totalCost = 0.0;
+    for( const SizeValueType count : m_SliceCounts )
+      {
+      totalCost += sliceSize + insideVoxelCost * count;
+      }
+
+    if( VDimension > 1 && numberOfSlices < numberOfPieces )
+      {
+      return this->SplitSlices( numberOfPieces, insideVoxelCost, totalCost );
+      }
+
+    // Cut after the slice where the cumulated cost reaches the next multiple
+    // of the cost of a piece
+    const double pieceCost = totalCost / numberOfPieces;
+    double cost = 0.0;
+    double nextCut = pieceCost;
+    SizeValueType pieceStart = 0;
+    for( SizeValueType slice = 0; slice < numberOfSlices; ++slice )
+      {
+      cost += sliceSize + insideVoxelCost * m_SliceCounts[slice];
+      if( cost >= nextCut || slice + 1 == numberOfSlices )
+        {
+        RegionType piece = m_Region;
+        piece.SetIndex( VDimension - 1, m_Region.GetIndex( VDimension - 1 ) + static_cast< IndexValueType >( pieceStart ) );
+        piece.SetSize( VDimension - 1, slice + 1 - pieceStart );
+        pieces.push_back( piece );
+        pieceStart = slice + 1;
+        while( nextCut <= cost )
+          {
+          nextCut += pieceCost;
+          }
+        }
+      }
+    return pieces;
+  }
+
+private:
+  /** Cut each slice along the dimension before the last one in rows, the
+   * number of pieces of a slice being proportional to its cost. The voxels
+   * inside of the mask are considered evenly spread in the slice. */
+  RegionVectorType SplitSlices( unsigned int numberOfPieces, double insideVoxelCost, double totalCost ) const
+  {
+    constexpr unsigned int RowDimension = VDimension > 1 ? VDimension - 2 : 0;
+    const SizeValueType numberOfSlices = m_SliceCounts.size();
+    const SizeValueType numberOfRows = m_Region.GetSize( RowDimension );
+    const double sliceSize = static_cast< double >( m_Region.GetNumberOfPixels() / numberOfSlices );
+
+    // Each slice has at least one piece, the others are shared by cost
+    const SizeValueType numberOfSharedPieces = numberOfPieces - numberOfSlices;
+    RegionVectorType pieces;
+    for( SizeValueType slice = 0; slice < numberOfSlices; ++slice )
+      {
+      const double sliceCost = sliceSize + insideVoxelCost * m_SliceCounts[slice];
+      const SizeValueType numberOfSlicePieces = std::min( numberOfRows,
+        1 + static_cast< SizeValueType >( numberOfSharedPieces * sliceCost / totalCost ) );
+      for( SizeValueType p = 0; p < numberOfSlicePieces; ++p )
+        {
+        const SizeValueType rowStart = p * numberOfRows / numberOfSlicePieces;
+        const SizeValueType rowEnd = ( p + 1 ) * numberOfRows / numberOfSlicePieces;
+        RegionType piece = m_Region;
+        piece.SetIndex( VDimension - 1, m_Region.GetIndex( VDimension - 1 ) + static_cast< IndexValueType >( slice ) );
+        piece.SetSize( VDimension - 1, 1 );
+        piece.SetIndex( RowDimension, m_Region.GetIndex( RowDimension ) + static_cast< IndexValueType >( rowStart ) );
+        piece.SetSize( RowDimension, rowEnd - rowStart );
+        pieces.push_back( piece );
+        }
+      }
+    return pieces;
+  }
+
+  SizeValueType GetBlock( const IndexType & index ) const
+  {
+    IndexType block;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      block[d] = ( index[d] - m_Region.GetIndex( d ) ) / BlockSize;
+      }
+    return this->GetBlockOffset( block );
+  }
+
+  SizeValueType GetBlockOffset( const IndexType & block ) const
+  {
+    SizeValueType offset = 0;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      offset += static_cast< SizeValueType >( block[d] ) * m_GridStrides[d];
+      }
+    return offset;
+  }
+
+  RegionType                   m_Region;
+  RegionType                   m_BoundingBox;
+  bool                         m_AllOccupied{ true };
+  SizeValueType                m_GridStrides[VDimension];
+  std::vector< bool >          m_Occupied;
+  std::vector< SizeValueType > m_SliceCounts;
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
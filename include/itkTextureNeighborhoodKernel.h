@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureNeighborhoodKernel_h
+#define itkTextureNeighborhoodKernel_h
+
+#include "itkNeighborhood.h"
+#include "itkMacro.h"
+
+#include <type_traits>
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class TextureNeighborhoodKernel
+ * \brief Walk a region of a digitized image and give access to the
+ * neighborhood of the current voxel through raw buffer offsets.
+ *
+ * This is the subset of the ConstNeighborhoodIterator interface used by the
+ * texture feature filters. The part of the neighborhood of each voxel of the
+ * region inside of the largest possible region of the image must lie in its
+ * buffered region, so there is no boundary condition: GetPixel( nb ) reads
+ * the buffer at the center pointer plus the linear offset of the neighbor,
+ * precomputed from the strides of the buffer. The digitized image is
+ * allocated with a halo replicating its boundary, so its neighborhoods are
+ * whole. The input image of the first order features only holds its padded
+ * requested region, and the caller must not read the neighbors outside of
+ * the image.
+ *
+ * Moving to the next voxel increments the center pointer, the jumps between
+ * the scan lines being specialized at compile time for 2D and 3D images.
+ *
+ * The caller can also tell that all the voxels of the current neighborhood
+ * are inside of the mask and in range, so that they are read without testing
+ * their value. This only holds for the current voxel.
+ *
+ * \ingroup TextureFeatures
+ */
+template< typename TImage >
+class TextureNeighborhoodKernel
+{
+public:
+  using ImageType = TImage;
+  using PixelType = typename TImage::PixelType;
+  using RegionType = typename TImage::RegionType;
+  using IndexType = typename TImage::IndexType;
+  using SizeType = typename TImage::SizeType;
+  using RadiusType = typename Neighborhood< PixelType, TImage::ImageDimension >::RadiusType;
+  using NeighborIndexType = typename Neighborhood< PixelType, TImage::ImageDimension >::NeighborIndexType;
+
+  static constexpr unsigned int ImageDimension = TImage::ImageDimension;
+
+  TextureNeighborhoodKernel( const RadiusType & radius, const TImage * image, const RegionType & region ) :
+    m_Image( image ),
+    m_Region( region ),
+    m_Index( region.GetIndex() ),
+    m_IsAtEnd( region.GetNumberOfPixels() == 0 ),
+    m_NeighborhoodInRange( false )
+  {
+    RegionType haloRegion = region;
+    haloRegion.PadByRadius( radius );
+    itkAssertOrThrowMacro( m_IsAtEnd || ( haloRegion.Crop( image->GetLargestPossibleRegion() )
+                                          && image->GetBufferedRegion().IsInside( haloRegion ) ),
+                           "The neighborhoods of the region must be buffered" );
+
+    const OffsetValueType * offsetTable = image->GetOffsetTable();
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      m_Strides[d] = offsetTable[d];
+      }
+
+    Neighborhood< PixelType, ImageDimension > hood;
+    hood.SetRadius( radius );
+    m_Offsets.resize( hood.Size() );
+    for( NeighborIndexType nb = 0; nb < hood.Size(); ++nb )
+      {
+      const typename Neighborhood< PixelType, ImageDimension >::OffsetType offset = hood.GetOffset( nb );
+      m_Offsets[nb] = 0;
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        m_Offsets[nb] += offset[d] * m_Strides[d];
+        }
+      }
+
+    m_Center = m_IsAtEnd ? nullptr : image->GetBufferPointer() + image->ComputeOffset( m_Index );
+  }
+
+  bool IsAtEnd() const { return m_IsAtEnd; }
+
+  const IndexType & GetIndex() const { return m_Index; }
+
+  NeighborIndexType Size() const { return static_cast< NeighborIndexType >( m_Offsets.size() ); }
+
+  const PixelType & GetCenterPixel() const { return *m_Center; }
+
+  const PixelType & GetPixel( NeighborIndexType nb ) const { return m_Center[m_Offsets[nb]]; }
+
+  /** Set/Get whether the voxels of the neighborhood of the current voxel are
+   * all inside of the mask and in range. Reset when moving to the next
+   * voxel. */
+  void SetNeighborhoodInRange( bool inRange ) { m_NeighborhoodInRange = inRange; }
+  bool IsNeighborhoodInRange() const { return m_NeighborhoodInRange; }
+
+  TextureNeighborhoodKernel & operator++()
+  {
+    m_NeighborhoodInRange = false;
+    ++m_Center;
+    if( ++m_Index[0] == m_Region.GetIndex( 0 ) + static_cast< IndexValueType >( m_Region.GetSize( 0 ) ) )
+      {
+      this->NextLine( std::integral_constant< unsigned int, ImageDimension >() );
+      }
+    return *this;
+  }
+
+private:
+  /** Move m_Center and m_Index from the end of a scan line to the start of
+   * the next one. */
+  void NextLine( std::integral_constant< unsigned int, 2 > )
+  {
+    m_Index[0] = m_Region.GetIndex( 0 );
+    m_IsAtEnd = ++m_Index[1] == m_Region.GetIndex( 1 ) + static_cast< IndexValueType >( m_Region.GetSize( 1 ) );
+    m_Center += m_Strides[1] - static_cast< OffsetValueType >( m_Region.GetSize( 0 ) );
+  }
+
+  void NextLine( std::integral_constant< unsigned int, 3 > )
+  {
+    m_Index[0] = m_Region.GetIndex( 0 );
+    m_Center += m_Strides[1] - static_cast< OffsetValueType >( m_Region.GetSize( 0 ) );
+    if( ++m_Index[1] == m_Region.GetIndex( 1 ) + static_cast< IndexValueType >( m_Region.GetSize( 1 ) ) )
+      {
+      m_Index[1] = m_Region.GetIndex( 1 );
+      m_IsAtEnd = ++m_Index[2] == m_Region.GetIndex( 2 ) + static_cast< IndexValueType >( m_Region.GetSize( 2 ) );
+      m_Center += m_Strides[2] - static_cast< OffsetValueType >( m_Region.GetSize( 1 ) ) * m_Strides[1];
+      }
+  }
+
+  template< unsigned int VDimension >
+  void NextLine( std::integral_constant< unsigned int, VDimension > )
+  {
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+      {
+      m_Index[d - 1] = m_Region.GetIndex( d - 1 );
+      if( ++m_Index[d] < m_Region.GetIndex( d ) + static_cast< IndexValueType >( m_Region.GetSize( d ) ) )
+        {
+        m_Center = m_Image->GetBufferPointer() + m_Image->ComputeOffset( m_Index );
+        return;
+        }
+      }
+    m_IsAtEnd = true;
+  }
+
+  const TImage *                 m_Image;
+  RegionType                     m_Region;
+  IndexType                      m_Index;
+  bool                           m_IsAtEnd;
+  bool                           m_NeighborhoodInRange;
+  const PixelType *              m_Center;
+  OffsetValueType                m_Strides[ImageDimension];
+  std::vector< OffsetValueType > m_Offsets;
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureUniformNeighborhoods_h
+#define itkTextureUniformNeighborhoods_h
+
+#include "itkImageRegion.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+namespace Statistics
+{
+
+/** \class TextureUniformNeighborhoods
+ * \brief Map of the voxels whose neighborhood holds a single digitized value,
+ * and of the ones whose neighborhood only holds bin indices.
+ *
+ * The minimum and the maximum of the digitized image over the neighborhood
+ * of each voxel are computed with separable moving windows, one dimension
+ * after the other, so the cost per voxel is linear in the radius instead of
+ * the neighborhood size. A neighborhood is in range when its maximum is a
+ * bin index, i.e. all its voxels are inside of the mask and in range. It is
+ * uniform when its minimum is also equal to its maximum, which is then the
+ * value of the center voxel.
+ *
+ * The texture of a uniform neighborhood is known from its value alone, so
+ * the texture feature filters compute it once per value instead of from the
+ * voxels of each neighborhood. The voxels of a neighborhood in range are
+ * read without testing their value, which is only needed near the border of
+ * the mask or of the intensity range.
+ *
+ * \ingroup TextureFeatures
+ */
+template< unsigned int VDimension >
+class TextureUniformNeighborhoods
+{
+public:
+  using RegionType = ImageRegion< VDimension >;
+  using IndexType = typename RegionType::IndexType;
+  using SizeType = typename RegionType::SizeType;
+
+  /** Find the voxels of the region whose neighborhood of the given radius in
+   * the digitized image only holds values smaller than outOfRangeValue, and
+   * the ones where these values are all the same. The neighborhoods of the
+   * region must be buffered in the image. */
+  template< typename TImage >
+  void Compute( const TImage * image, const RegionType & region, const SizeType & radius,
+                const typename TImage::PixelType & outOfRangeValue )
+  {
+    using PixelType = typename TImage::PixelType;
+
+    m_Region = region;
+    SizeValueType stride = 1;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      m_Strides[d] = stride;
+      stride *= region.GetSize( d );
+      }
+
+    RegionType currentRegion = region;
+    currentRegion.PadByRadius( radius );
+    std::vector< PixelType > minimum;
+    minimum.reserve( currentRegion.GetNumberOfPixels() );
+    for( ImageRegionConstIterator< TImage > it( image, currentRegion ); !it.IsAtEnd(); ++it )
+      {
+      minimum.push_back( it.Get() );
+      }
+    std::vector< PixelType > maximum = minimum;
+
+    // Shrink the padded region to the region along one dimension after the
+    // other, each voxel taking the extrema of the window of the previous pass
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      SizeValueType currentStrides[VDimension];
+      stride = 1;
+      for( unsigned int k = 0; k < VDimension; ++k )
+        {
+        currentStrides[k] = stride;
+        stride *= currentRegion.GetSize( k );
+        }
+      RegionType nextRegion = currentRegion;
+      nextRegion.SetIndex( d, region.GetIndex( d ) );
+      nextRegion.SetSize( d, region.GetSize( d ) );
+
+      const SizeValueType windowLength = 2 * radius[d] + 1;
+      std::vector< PixelType > nextMinimum( nextRegion.GetNumberOfPixels() );
+      std::vector< PixelType > nextMaximum( nextRegion.GetNumberOfPixels() );
+      SizeValueType counter[VDimension] = {};
+      SizeValueType position = 0;
+      for( SizeValueType n = 0; n < nextMinimum.size(); ++n )
+        {
+        // The window of the voxel starts at the same position in the
+        // previous region, which is larger by twice the radius along d
+        PixelType lower = minimum[position];
+        PixelType upper = maximum[position];
+        for( SizeValueType w = 1; w < windowLength; ++w )
+          {
+          lower = std::min( lower, minimum[position + w * currentStrides[d]] );
+          upper = std::max( upper, maximum[position + w * currentStrides[d]] );
+          }
+        nextMinimum[n] = lower;
+        nextMaximum[n] = upper;
+
+        for( unsigned int k = 0; k < VDimension; ++k )
+          {
+          position += currentStrides[k];
+          if( ++counter[k] < nextRegion.GetSize( k ) )
+            {
+            break;
+            }
+          position -= counter[k] * currentStrides[k];
+          counter[k] = 0;
+          }
+        }
+      minimum.swap( nextMinimum );
+      maximum.swap( nextMaximum );
+      currentRegion = nextRegion;
+      }
+
+    m_InRange.resize( minimum.size() );
+    m_Uniform.resize( minimum.size() );
+    for( SizeValueType n = 0; n < minimum.size(); ++n )
+      {
+      m_InRange[n] = maximum[n] < outOfRangeValue;
+      m_Uniform[n] = m_InRange[n] && minimum[n] == maximum[n];
+      }
+  }
+
+  void Clear()
+  {
+    m_Region = RegionType();
+    m_InRange.clear();
+    m_Uniform.clear();
+  }
+
+  bool IsEmpty() const { return m_Uniform.empty(); }
+
+  /** Whether the neighborhood of the voxel at index, in the region, is
+   * uniform. */
+  bool IsUniform( const IndexType & index ) const
+  {
+    return m_Uniform[this->GetOffset( index )];
+  }
+
+  /** Whether the neighborhood of the voxel at index, in the region, is in
+   * range. */
+  bool IsInRange( const IndexType & index ) const
+  {
+    return m_InRange[this->GetOffset( index )];
+  }
+
+private:
+  SizeValueType GetOffset( const IndexType & index ) const
+  {
+    SizeValueType offset = 0;
+    for( unsigned int d = 0; d < VDimension; ++d )
+      {
+      offset += static_cast< SizeValueType >( index[d] - m_Region.GetIndex( d ) ) * m_Strides[d];
+      }
+    return offset;
+  }
+
+  RegionType          m_Region;
+  SizeValueType       m_Strides[VDimension];
+  std::vector< bool > m_InRange;
+  std::vector< bool > m_Uniform;
+};
+
+} // end of namespace Statistics
+} // end of namespace itk
+
+#endif
@@ -20,6 +20,7 @@ itk_module(TextureFeatures
     ITKCommon
     ITKStatistics
     ITKImageGrid
+    ITKImageFilterBase
     ITKMathematicalMorphology
   TEST_DEPENDS
     ITKTestKernel
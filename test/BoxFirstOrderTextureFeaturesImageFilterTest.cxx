@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBoxFirstOrderTextureFeaturesImageFilter.h"
+#include "itkFirstOrderTextureFeaturesImageFilter.h"
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkFlatStructuringElement.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+
+namespace
+{
+
+// Compare the first numberOfComponents components of the features computed
+// with the box engine to the ones computed with the moving histogram.
+template< typename TFeatureImage >
+unsigned int
+CompareFeatures( const TFeatureImage * box, const TFeatureImage * features, unsigned int numberOfComponents )
+{
+  itk::ImageRegionConstIterator< TFeatureImage > boxIt( box, box->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TFeatureImage > featuresIt( features, box->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  for(; !boxIt.IsAtEnd(); ++boxIt, ++featuresIt )
+    {
+    for( unsigned int i = 0; i < numberOfComponents; ++i )
+      {
+      const double expected = featuresIt.Get()[i];
+      const double value = boxIt.Get()[i];
+      if( std::abs( value - expected ) > 1e-4 * ( 1.0 + std::abs( expected ) ) )
+        {
+        if( numberOfDifferences++ < 10 )
+          {
+          std::cerr << "Component " << i << " at " << boxIt.GetIndex()
+            << " is " << value << " but " << expected << " was expected" << std::endl;
+          }
+        }
+      }
+    }
+  return numberOfDifferences;
+}
+
+}
+
+int BoxFirstOrderTextureFeaturesImageFilterTest( int argc, char *argv[] )
+{
+  if( argc < 3 )
+    {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << argv[0]
+      << " inputImageFile"
+      << " neighborhoodRadius" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  constexpr unsigned int ImageDimension = 3;
+
+  // Declare types
+  using InputPixelType = float;
+  using OutputPixelComponentType = float;
+
+  using InputImageType = itk::Image< InputPixelType, ImageDimension >;
+  using OutputImageType = itk::VectorImage< OutputPixelComponentType, ImageDimension >;
+  using ReaderType = itk::ImageFileReader< InputImageType >;
+  using KernelType = itk::FlatStructuringElement< ImageDimension >;
+
+  // Create and set up a reader
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  KernelType::RadiusType radius;
+  radius.Fill( std::stoi( argv[2] ) );
+
+  // Create the filter
+  using FilterType = itk::BoxFirstOrderTextureFeaturesImageFilter< InputImageType, OutputImageType >;
+  FilterType::Pointer filter = FilterType::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( filter, BoxFirstOrderTextureFeaturesImageFilter,
+    BoxImageFilter );
+
+  filter->SetInput( reader->GetOutput() );
+  filter->SetRadius( radius );
+  TEST_SET_GET_VALUE( radius, filter->GetRadius() );
+
+  bool computeEntropy = true;
+  TEST_SET_GET_BOOLEAN( filter, ComputeEntropy, computeEntropy );
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_EQUAL( filter->GetOutput()->GetNumberOfComponentsPerPixel(), 8u );
+
+  // Compute the features with the moving histogram
+  using FirstOrderFilterType = itk::FirstOrderTextureFeaturesImageFilter<
+    InputImageType, OutputImageType, KernelType >;
+  FirstOrderFilterType::Pointer firstOrderFilter = FirstOrderFilterType::New();
+  firstOrderFilter->SetInput( reader->GetOutput() );
+  firstOrderFilter->SetKernel( KernelType::Box( radius ) );
+
+  TRY_EXPECT_NO_EXCEPTION( firstOrderFilter->Update() );
+
+  TEST_EXPECT_EQUAL( CompareFeatures( filter->GetOutput(), firstOrderFilter->GetOutput(), 8 ), 0u );
+
+  // Without the entropy
+  filter->ComputeEntropyOff();
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_EQUAL( CompareFeatures( filter->GetOutput(), firstOrderFilter->GetOutput(), 7 ), 0u );
+
+  itk::ImageRegionConstIterator< OutputImageType > outputIt( filter->GetOutput(),
+    filter->GetOutput()->GetBufferedRegion() );
+  unsigned int numberOfNonZeroEntropies = 0;
+  for(; !outputIt.IsAtEnd(); ++outputIt )
+    {
+    if( outputIt.Get()[7] != 0.0f )
+      {
+      ++numberOfNonZeroEntropies;
+      }
+    }
+  TEST_EXPECT_EQUAL( numberOfNonZeroEntropies, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
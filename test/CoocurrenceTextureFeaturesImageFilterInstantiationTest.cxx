@@ -66,7 +66,7 @@ int CoocurrenceTextureFeaturesImageFilterInstantiationTest( int argc, char *argv
   FilterType::Pointer filter = FilterType::New();
 
   EXERCISE_BASIC_OBJECT_METHODS( filter,
-      CoocurrenceTextureFeaturesImageFilter, ImageToImageFilter );
+      CoocurrenceTextureFeaturesImageFilter, TextureFeaturesImageFilterBase );
 
 
   filter->SetInput( reader->GetOutput() );
@@ -105,7 +105,25 @@ int CoocurrenceTextureFeaturesImageFilterInstantiationTest( int argc, char *argv
   filter->SetOffsets( offsetVector );
   TEST_SET_GET_VALUE( offsetVector, filter->GetOffsets() );
 
+  bool useSlidingWindow = true;
+  TEST_SET_GET_BOOLEAN( filter, UseSlidingWindow, useSlidingWindow );
 
+  FilterType::HistogramRepresentationType histogramRepresentation = FilterType::SparseHistogram;
+  filter->SetHistogramRepresentation( histogramRepresentation );
+  TEST_SET_GET_VALUE( histogramRepresentation, filter->GetHistogramRepresentation() );
+
+  bool useFusedFeatureEvaluation = true;
+  TEST_SET_GET_BOOLEAN( filter, UseFusedFeatureEvaluation, useFusedFeatureEvaluation );
+
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+
+  // Too many bins to be digitized in 16 bits
+  filter->SetNumberOfBinsPerAxis( 65535 );
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+
+  // Digitized in 16 bits
+  filter->SetNumberOfBinsPerAxis( 300 );
   TRY_EXPECT_NO_EXCEPTION( filter->Update() );
 
 
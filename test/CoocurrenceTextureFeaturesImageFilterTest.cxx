@@ -81,6 +81,25 @@ int CoocurrenceTextureFeaturesImageFilterTest( int argc, char *argv[] )
     filter->SetNeighborhoodRadius( hood.GetRadius() );
     }
 
+  if( argc >= 9 )
+    {
+    bool useSlidingWindow = std::stoi( argv[8] );
+    filter->SetUseSlidingWindow( useSlidingWindow );
+    }
+
+  if( argc >= 10 )
+    {
+    auto histogramRepresentation =
+      static_cast< FilterType::HistogramRepresentationType >( std::stoi( argv[9] ) );
+    filter->SetHistogramRepresentation( histogramRepresentation );
+    }
+
+  if( argc >= 11 )
+    {
+    bool useFusedFeatureEvaluation = std::stoi( argv[10] );
+    filter->SetUseFusedFeatureEvaluation( useFusedFeatureEvaluation );
+    }
+
   TRY_EXPECT_NO_EXCEPTION( filter->Update() );
 
   // Create and set up a writer
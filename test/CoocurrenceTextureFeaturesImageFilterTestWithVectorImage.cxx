@@ -66,7 +66,7 @@ int CoocurrenceTextureFeaturesImageFilterTestWithVectorImage( int argc, char *ar
   FilterType::Pointer filter = FilterType::New();
 
   EXERCISE_BASIC_OBJECT_METHODS( filter, CoocurrenceTextureFeaturesImageFilter,
-    ImageToImageFilter );
+    TextureFeaturesImageFilterBase );
 
 
   filter->SetInput( reader->GetOutput() );
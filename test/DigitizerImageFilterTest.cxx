@@ -0,0 +1,220 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkDigitizerImageFilter.h"
+#include "itkCoocurrenceTextureFeaturesImageFilter.h"
+#include "itkRunLengthTextureFeaturesImageFilter.h"
+
+#include "itkImage.h"
+#include "itkVector.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkNeighborhood.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+
+int DigitizerImageFilterTest( int argc, char *argv[] )
+{
+  if( argc < 12 )
+    {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << argv[0]
+      << " inputImageFile"
+      << " maskImageFile"
+      << " coocurrenceOutputImageFile"
+      << " runLengthOutputImageFile"
+      << " numberOfBinsPerAxis"
+      << " pixelValueMin"
+      << " pixelValueMax"
+      << " coocurrenceNeighborhoodRadius"
+      << " minDistance"
+      << " maxDistance"
+      << " runLengthNeighborhoodRadius" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  constexpr unsigned int ImageDimension = 3;
+
+  // Declare types
+  using InputPixelType = float;
+  using DigitizedPixelType = uint8_t;
+  using OutputPixelComponentType = float;
+  using CoocurrenceOutputPixelType = itk::Vector< OutputPixelComponentType, 8 >;
+  using RunLengthOutputPixelType = itk::Vector< OutputPixelComponentType, 10 >;
+
+  using InputImageType = itk::Image< InputPixelType, ImageDimension >;
+  using DigitizedImageType = itk::Image< DigitizedPixelType, ImageDimension >;
+  using CoocurrenceOutputImageType = itk::Image< CoocurrenceOutputPixelType, ImageDimension >;
+  using RunLengthOutputImageType = itk::Image< RunLengthOutputPixelType, ImageDimension >;
+  using ReaderType = itk::ImageFileReader< InputImageType >;
+  using NeighborhoodType = itk::Neighborhood< InputImageType::PixelType,
+    InputImageType::ImageDimension >;
+
+  // Create and set up a reader
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  // Create and set up a maskReader
+  ReaderType::Pointer maskReader = ReaderType::New();
+  maskReader->SetFileName( argv[2] );
+
+  unsigned int numberOfBinsPerAxis = std::stoi( argv[5] );
+  InputPixelType pixelValueMin = std::stod( argv[6] );
+  InputPixelType pixelValueMax = std::stod( argv[7] );
+
+  // Create the digitizer shared by the texture feature filters
+  using DigitizerType = itk::Statistics::DigitizerImageFilter<
+    InputImageType, InputImageType, DigitizedImageType >;
+  DigitizerType::Pointer digitizer = DigitizerType::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( digitizer, DigitizerImageFilter,
+    ImageToImageFilter );
+
+  // The largest intensity below the maximum is in the last bin, even when its
+  // quotient by the bin width rounds up to the number of bins
+  const DigitizerType::DigitizerFunctorType lastBinDigitizer( 3, 1, 0, 100 );
+  TEST_EXPECT_EQUAL( static_cast< unsigned int >( lastBinDigitizer( 1, std::nextafter( 100.0f, 0.0f ) ) ), 2u );
+
+  digitizer->SetInput( reader->GetOutput() );
+  digitizer->SetMaskImage( maskReader->GetOutput() );
+  TEST_SET_GET_VALUE( maskReader->GetOutput(), digitizer->GetMaskImage() );
+
+  digitizer->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  TEST_SET_GET_VALUE( numberOfBinsPerAxis, digitizer->GetNumberOfBinsPerAxis() );
+
+  digitizer->SetHistogramMinimum( pixelValueMin );
+  digitizer->SetHistogramMaximum( pixelValueMax );
+  TEST_SET_GET_VALUE( pixelValueMin, digitizer->GetHistogramMinimum() );
+  TEST_SET_GET_VALUE( pixelValueMax, digitizer->GetHistogramMaximum() );
+
+  // Create the co-occurrence filter
+  using CoocurrenceFilterType = itk::Statistics::CoocurrenceTextureFeaturesImageFilter<
+    InputImageType, CoocurrenceOutputImageType, InputImageType >;
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CoocurrenceFilterType::New();
+
+  coocurrenceFilter->SetInput( reader->GetOutput() );
+  coocurrenceFilter->SetDigitizedImage( digitizer->GetOutput() );
+  TEST_SET_GET_VALUE( digitizer->GetOutput(), coocurrenceFilter->GetDigitizedImage() );
+  coocurrenceFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  coocurrenceFilter->SetHistogramMinimum( pixelValueMin );
+  coocurrenceFilter->SetHistogramMaximum( pixelValueMax );
+
+  NeighborhoodType::SizeValueType neighborhoodRadius = std::stoi( argv[8] );
+  NeighborhoodType hood;
+  hood.SetRadius( neighborhoodRadius );
+  coocurrenceFilter->SetNeighborhoodRadius( hood.GetRadius() );
+
+  // Create the run length filter
+  using RunLengthFilterType = itk::Statistics::RunLengthTextureFeaturesImageFilter<
+    InputImageType, RunLengthOutputImageType, InputImageType >;
+  RunLengthFilterType::Pointer runLengthFilter = RunLengthFilterType::New();
+
+  runLengthFilter->SetInput( reader->GetOutput() );
+  runLengthFilter->SetDigitizedImage( digitizer->GetOutput() );
+  runLengthFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  runLengthFilter->SetHistogramValueMinimum( pixelValueMin );
+  runLengthFilter->SetHistogramValueMaximum( pixelValueMax );
+
+  RunLengthFilterType::RealType minDistance = std::stod( argv[9] );
+  RunLengthFilterType::RealType maxDistance = std::stod( argv[10] );
+  runLengthFilter->SetHistogramDistanceMinimum( minDistance );
+  runLengthFilter->SetHistogramDistanceMaximum( maxDistance );
+
+  neighborhoodRadius = std::stoi( argv[11] );
+  hood.SetRadius( neighborhoodRadius );
+  runLengthFilter->SetNeighborhoodRadius( hood.GetRadius() );
+
+  TRY_EXPECT_NO_EXCEPTION( coocurrenceFilter->Update() );
+  TRY_EXPECT_NO_EXCEPTION( runLengthFilter->Update() );
+
+  // Create and set up the writers
+  using CoocurrenceWriterType = itk::ImageFileWriter< CoocurrenceOutputImageType >;
+  CoocurrenceWriterType::Pointer coocurrenceWriter = CoocurrenceWriterType::New();
+  coocurrenceWriter->SetFileName( argv[3] );
+  coocurrenceWriter->SetInput( coocurrenceFilter->GetOutput() );
+
+  TRY_EXPECT_NO_EXCEPTION( coocurrenceWriter->Update() );
+
+  using RunLengthWriterType = itk::ImageFileWriter< RunLengthOutputImageType >;
+  RunLengthWriterType::Pointer runLengthWriter = RunLengthWriterType::New();
+  runLengthWriter->SetFileName( argv[4] );
+  runLengthWriter->SetInput( runLengthFilter->GetOutput() );
+
+  TRY_EXPECT_NO_EXCEPTION( runLengthWriter->Update() );
+
+  // The digitized image records its number of bins and intensity range
+  unsigned int digitizedNumberOfBins = 0;
+  TEST_EXPECT_TRUE( itk::ExposeMetaData< unsigned int >( digitizer->GetOutput()->GetMetaDataDictionary(),
+    "NumberOfBinsPerAxis", digitizedNumberOfBins ) );
+  TEST_EXPECT_EQUAL( digitizedNumberOfBins, numberOfBinsPerAxis );
+
+  // A digitized image of other parameters is rejected
+  coocurrenceFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis + 1 );
+  TRY_EXPECT_EXCEPTION( coocurrenceFilter->Update() );
+  coocurrenceFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+
+  runLengthFilter->SetHistogramValueMaximum( pixelValueMax + 1 );
+  TRY_EXPECT_EXCEPTION( runLengthFilter->Update() );
+  runLengthFilter->SetHistogramValueMaximum( pixelValueMax );
+  TRY_EXPECT_NO_EXCEPTION( runLengthFilter->Update() );
+
+  // So is a digitized image of another mask convention, when the mask is
+  // also given to the texture filter
+  bool digitizedUsesMask = false;
+  TEST_EXPECT_TRUE( itk::ExposeMetaData< bool >( digitizer->GetOutput()->GetMetaDataDictionary(),
+    "UsesMask", digitizedUsesMask ) );
+  TEST_EXPECT_TRUE( digitizedUsesMask );
+
+  runLengthFilter->SetMaskImage( maskReader->GetOutput() );
+  runLengthFilter->SetInsidePixelValue( digitizer->GetInsidePixelValue() + 1 );
+  TRY_EXPECT_EXCEPTION( runLengthFilter->Update() );
+  runLengthFilter->SetInsidePixelValue( digitizer->GetInsidePixelValue() );
+  TRY_EXPECT_NO_EXCEPTION( runLengthFilter->Update() );
+
+  // A digitized image holding the halo of the neighborhoods gives the same
+  // features
+  CoocurrenceOutputImageType::Pointer coocurrenceFeatures = coocurrenceFilter->GetOutput();
+  coocurrenceFeatures->DisconnectPipeline();
+
+  digitizer->SetHaloRadius( coocurrenceFilter->GetNeighborhoodRadius() );
+  TEST_SET_GET_VALUE( coocurrenceFilter->GetNeighborhoodRadius(), digitizer->GetHaloRadius() );
+  TRY_EXPECT_NO_EXCEPTION( coocurrenceFilter->Update() );
+
+  InputImageType::RegionType haloRegion = reader->GetOutput()->GetLargestPossibleRegion();
+  haloRegion.PadByRadius( coocurrenceFilter->GetNeighborhoodRadius() );
+  TEST_EXPECT_EQUAL( digitizer->GetOutput()->GetLargestPossibleRegion(), haloRegion );
+
+  unsigned int numberOfDifferences = 0;
+  itk::ImageRegionConstIterator< CoocurrenceOutputImageType > featuresIt( coocurrenceFilter->GetOutput(),
+    coocurrenceFeatures->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< CoocurrenceOutputImageType > expectedIt( coocurrenceFeatures,
+    coocurrenceFeatures->GetBufferedRegion() );
+  for(; !featuresIt.IsAtEnd(); ++featuresIt, ++expectedIt )
+    {
+    if( featuresIt.Get() != expectedIt.Get() )
+      {
+      ++numberOfDifferences;
+      }
+    }
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
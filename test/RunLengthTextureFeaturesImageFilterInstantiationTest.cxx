@@ -66,7 +66,7 @@ int RunLengthTextureFeaturesImageFilterInstantiationTest( int argc, char *argv[]
   FilterType::Pointer filter = FilterType::New();
 
   EXERCISE_BASIC_OBJECT_METHODS( filter,
-    RunLengthTextureFeaturesImageFilter, ImageToImageFilter );
+    RunLengthTextureFeaturesImageFilter, TextureFeaturesImageFilterBase );
 
 
   filter->SetInput( reader->GetOutput() );
@@ -114,6 +114,14 @@ int RunLengthTextureFeaturesImageFilterInstantiationTest( int argc, char *argv[]
 
   TRY_EXPECT_NO_EXCEPTION( filter->Update() );
 
+  // Too many bins to be digitized in 16 bits
+  filter->SetNumberOfBinsPerAxis( 65535 );
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+
+  // Digitized in 16 bits
+  filter->SetNumberOfBinsPerAxis( 300 );
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+
 
   std::cout << "Test finished." << std::endl;
   return EXIT_SUCCESS;
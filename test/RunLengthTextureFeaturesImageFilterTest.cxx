@@ -71,7 +71,7 @@ int RunLengthTextureFeaturesImageFilterTest( int argc, char *argv[] )
   FilterType::Pointer filter = FilterType::New();
 
   EXERCISE_BASIC_OBJECT_METHODS( filter, RunLengthTextureFeaturesImageFilter,
-    ImageToImageFilter );
+    TextureFeaturesImageFilterBase );
 
 
   filter->SetInput( reader->GetOutput() );
@@ -68,7 +68,7 @@ int RunLengthTextureFeaturesImageFilterTestWithVectorImage( int argc, char *argv
   FilterType::Pointer filter = FilterType::New();
 
   EXERCISE_BASIC_OBJECT_METHODS( filter, RunLengthTextureFeaturesImageFilter,
-    ImageToImageFilter );
+    TextureFeaturesImageFilterBase );
 
 
   filter->SetInput( reader->GetOutput() );
@@ -0,0 +1,271 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeatureBankImageFilter.h"
+#include "itkCoocurrenceTextureFeaturesImageFilter.h"
+#include "itkRunLengthTextureFeaturesImageFilter.h"
+#include "itkFirstOrderTextureFeaturesImageFilter.h"
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkFlatStructuringElement.h"
+#include "itkNeighborhood.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+
+namespace
+{
+
+// Compare the components of the features computed by an individual filter
+// selected by featureMask to the ones starting at firstComponent in the output
+// of the bank, inside of the mask.
+template< typename TFeatureImage, typename TMaskImage >
+unsigned int
+CompareFeatures( const TFeatureImage * bank, unsigned int firstComponent,
+                 const TFeatureImage * features, const TMaskImage * mask,
+                 unsigned int featureMask = ~0u )
+{
+  itk::ImageRegionConstIterator< TFeatureImage > bankIt( bank, bank->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TFeatureImage > featuresIt( features, bank->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TMaskImage > maskIt( mask, bank->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  for(; !bankIt.IsAtEnd(); ++bankIt, ++featuresIt, ++maskIt )
+    {
+    if( maskIt.Get() != 1 )
+      {
+      continue;
+      }
+    unsigned int component = firstComponent;
+    for( unsigned int i = 0; i < features->GetNumberOfComponentsPerPixel(); ++i )
+      {
+      if( !( featureMask & ( 1u << i ) ) )
+        {
+        continue;
+        }
+      const double expected = featuresIt.Get()[i];
+      const double value = bankIt.Get()[component++];
+      if( std::isnan( expected ) && std::isnan( value ) )
+        {
+        continue;
+        }
+      if( std::abs( value - expected ) > 1e-5 * ( 1.0 + std::abs( expected ) ) )
+        {
+        if( numberOfDifferences++ < 10 )
+          {
+          std::cerr << "Component " << component - 1 << " at " << bankIt.GetIndex()
+            << " is " << value << " but " << expected << " was expected" << std::endl;
+          }
+        }
+      }
+    }
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeatureBankImageFilterTest( int argc, char *argv[] )
+{
+  if( argc < 9 )
+    {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << argv[0]
+      << " inputImageFile"
+      << " maskImageFile"
+      << " numberOfBinsPerAxis"
+      << " pixelValueMin"
+      << " pixelValueMax"
+      << " minDistance"
+      << " maxDistance"
+      << " neighborhoodRadius" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  constexpr unsigned int ImageDimension = 3;
+
+  // Declare types
+  using InputPixelType = float;
+  using OutputPixelComponentType = float;
+
+  using InputImageType = itk::Image< InputPixelType, ImageDimension >;
+  using OutputImageType = itk::VectorImage< OutputPixelComponentType, ImageDimension >;
+  using ReaderType = itk::ImageFileReader< InputImageType >;
+  using NeighborhoodType = itk::Neighborhood< InputImageType::PixelType,
+    InputImageType::ImageDimension >;
+
+  // Create and set up a reader
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  // Create and set up a maskReader
+  ReaderType::Pointer maskReader = ReaderType::New();
+  maskReader->SetFileName( argv[2] );
+
+  TRY_EXPECT_NO_EXCEPTION( maskReader->Update() );
+
+  unsigned int numberOfBinsPerAxis = std::stoi( argv[3] );
+  InputPixelType pixelValueMin = std::stod( argv[4] );
+  InputPixelType pixelValueMax = std::stod( argv[5] );
+  double minDistance = std::stod( argv[6] );
+  double maxDistance = std::stod( argv[7] );
+  NeighborhoodType::SizeValueType neighborhoodRadius = std::stoi( argv[8] );
+  NeighborhoodType hood;
+  hood.SetRadius( neighborhoodRadius );
+
+  // Create the filter
+  using FilterType = itk::Statistics::TextureFeatureBankImageFilter<
+    InputImageType, OutputImageType, InputImageType >;
+  FilterType::Pointer filter = FilterType::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( filter, TextureFeatureBankImageFilter,
+    TextureFeaturesImageFilterBase );
+
+  filter->SetInput( reader->GetOutput() );
+  filter->SetMaskImage( maskReader->GetOutput() );
+  TEST_SET_GET_VALUE( maskReader->GetOutput(), filter->GetMaskImage() );
+
+  filter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  TEST_SET_GET_VALUE( numberOfBinsPerAxis, filter->GetNumberOfBinsPerAxis() );
+
+  filter->SetHistogramMinimum( pixelValueMin );
+  filter->SetHistogramMaximum( pixelValueMax );
+  TEST_SET_GET_VALUE( pixelValueMin, filter->GetHistogramMinimum() );
+  TEST_SET_GET_VALUE( pixelValueMax, filter->GetHistogramMaximum() );
+
+  filter->SetHistogramDistanceMinimum( minDistance );
+  filter->SetHistogramDistanceMaximum( maxDistance );
+  TEST_SET_GET_VALUE( minDistance, filter->GetHistogramDistanceMinimum() );
+  TEST_SET_GET_VALUE( maxDistance, filter->GetHistogramDistanceMaximum() );
+
+  filter->SetNeighborhoodRadius( hood.GetRadius() );
+  TEST_SET_GET_VALUE( hood.GetRadius(), filter->GetNeighborhoodRadius() );
+
+  bool computeCoocurrenceFeatures = true;
+  TEST_SET_GET_BOOLEAN( filter, ComputeCoocurrenceFeatures, computeCoocurrenceFeatures );
+  bool computeRunLengthFeatures = true;
+  TEST_SET_GET_BOOLEAN( filter, ComputeRunLengthFeatures, computeRunLengthFeatures );
+  bool computeFirstOrderFeatures = true;
+  TEST_SET_GET_BOOLEAN( filter, ComputeFirstOrderFeatures, computeFirstOrderFeatures );
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_EQUAL( filter->GetOutput()->GetNumberOfComponentsPerPixel(), 26u );
+
+  // Compute the features with the individual filters
+  using CoocurrenceFilterType = itk::Statistics::CoocurrenceTextureFeaturesImageFilter<
+    InputImageType, OutputImageType, InputImageType >;
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CoocurrenceFilterType::New();
+  coocurrenceFilter->SetInput( reader->GetOutput() );
+  coocurrenceFilter->SetMaskImage( maskReader->GetOutput() );
+  coocurrenceFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  coocurrenceFilter->SetHistogramMinimum( pixelValueMin );
+  coocurrenceFilter->SetHistogramMaximum( pixelValueMax );
+  coocurrenceFilter->SetNeighborhoodRadius( hood.GetRadius() );
+
+  TRY_EXPECT_NO_EXCEPTION( coocurrenceFilter->Update() );
+
+  using RunLengthFilterType = itk::Statistics::RunLengthTextureFeaturesImageFilter<
+    InputImageType, OutputImageType, InputImageType >;
+  RunLengthFilterType::Pointer runLengthFilter = RunLengthFilterType::New();
+  runLengthFilter->SetInput( reader->GetOutput() );
+  runLengthFilter->SetMaskImage( maskReader->GetOutput() );
+  runLengthFilter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+  runLengthFilter->SetHistogramValueMinimum( pixelValueMin );
+  runLengthFilter->SetHistogramValueMaximum( pixelValueMax );
+  runLengthFilter->SetHistogramDistanceMinimum( minDistance );
+  runLengthFilter->SetHistogramDistanceMaximum( maxDistance );
+  runLengthFilter->SetNeighborhoodRadius( hood.GetRadius() );
+
+  TRY_EXPECT_NO_EXCEPTION( runLengthFilter->Update() );
+
+  using KernelType = itk::FlatStructuringElement< ImageDimension >;
+  using FirstOrderFilterType = itk::FirstOrderTextureFeaturesImageFilter<
+    InputImageType, OutputImageType, KernelType >;
+  FirstOrderFilterType::Pointer firstOrderFilter = FirstOrderFilterType::New();
+  firstOrderFilter->SetInput( reader->GetOutput() );
+  firstOrderFilter->SetKernel( KernelType::Box( hood.GetRadius() ) );
+
+  TRY_EXPECT_NO_EXCEPTION( firstOrderFilter->Update() );
+
+  unsigned int numberOfDifferences = 0;
+  numberOfDifferences += CompareFeatures( filter->GetOutput(), 0,
+    coocurrenceFilter->GetOutput(), maskReader->GetOutput() );
+  numberOfDifferences += CompareFeatures( filter->GetOutput(), 8,
+    runLengthFilter->GetOutput(), maskReader->GetOutput() );
+  numberOfDifferences += CompareFeatures( filter->GetOutput(), 18,
+    firstOrderFilter->GetOutput(), maskReader->GetOutput() );
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+  // A subset of the features
+  filter->ComputeCoocurrenceFeaturesOff();
+  filter->ComputeFirstOrderFeaturesOff();
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_EQUAL( filter->GetOutput()->GetNumberOfComponentsPerPixel(), 10u );
+  TEST_EXPECT_EQUAL( CompareFeatures( filter->GetOutput(), 0,
+    runLengthFilter->GetOutput(), maskReader->GetOutput() ), 0u );
+
+  // A subset of the co-occurrence and run length features
+  filter->ComputeCoocurrenceFeaturesOn();
+  const unsigned int coocurrenceFeatureMask = CoocurrenceFilterType::EntropyFeature
+    | CoocurrenceFilterType::ClusterShadeFeature | CoocurrenceFilterType::HaralickCorrelationFeature;
+  filter->SetCoocurrenceFeatureMask( coocurrenceFeatureMask );
+  TEST_SET_GET_VALUE( coocurrenceFeatureMask, filter->GetCoocurrenceFeatureMask() );
+  const unsigned int runLengthFeatureMask = RunLengthFilterType::LongRunEmphasisFeature
+    | RunLengthFilterType::GreyLevelNonuniformityFeature;
+  filter->SetRunLengthFeatureMask( runLengthFeatureMask );
+  TEST_SET_GET_VALUE( runLengthFeatureMask, filter->GetRunLengthFeatureMask() );
+
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_EQUAL( filter->GetOutput()->GetNumberOfComponentsPerPixel(), 5u );
+  numberOfDifferences = CompareFeatures( filter->GetOutput(), 0,
+    coocurrenceFilter->GetOutput(), maskReader->GetOutput(), coocurrenceFeatureMask );
+  numberOfDifferences += CompareFeatures( filter->GetOutput(), 3,
+    runLengthFilter->GetOutput(), maskReader->GetOutput(), runLengthFeatureMask );
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+  // The same subsets computed by the individual filters
+  coocurrenceFilter->SetFeatureMask( coocurrenceFeatureMask );
+  TEST_SET_GET_VALUE( coocurrenceFeatureMask, coocurrenceFilter->GetFeatureMask() );
+  TRY_EXPECT_NO_EXCEPTION( coocurrenceFilter->Update() );
+  TEST_EXPECT_EQUAL( coocurrenceFilter->GetOutput()->GetNumberOfComponentsPerPixel(), 3u );
+
+  runLengthFilter->SetFeatureMask( runLengthFeatureMask );
+  TEST_SET_GET_VALUE( runLengthFeatureMask, runLengthFilter->GetFeatureMask() );
+  TRY_EXPECT_NO_EXCEPTION( runLengthFilter->Update() );
+  TEST_EXPECT_EQUAL( runLengthFilter->GetOutput()->GetNumberOfComponentsPerPixel(), 2u );
+
+  numberOfDifferences = CompareFeatures( filter->GetOutput(), 0,
+    coocurrenceFilter->GetOutput(), maskReader->GetOutput() );
+  numberOfDifferences += CompareFeatures( filter->GetOutput(), 3,
+    runLengthFilter->GetOutput(), maskReader->GetOutput() );
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+  coocurrenceFilter->SetFeatureMask( 0 );
+  TRY_EXPECT_EXCEPTION( coocurrenceFilter->Update() );
+
+  // No feature
+  filter->ComputeCoocurrenceFeaturesOff();
+  filter->ComputeRunLengthFeaturesOff();
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
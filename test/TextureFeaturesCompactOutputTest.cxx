@@ -0,0 +1,81 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the compact output of the filter, scattered to an image, to its
+// image output.
+template< typename TFilter >
+unsigned int
+CompareCompactFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  filter->CompactOutputOff();
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  filter->CompactOutputOn();
+  filter->GetCompactOutput()->Update();
+  typename FeatureImageType::Pointer scattered = filter->GetCompactOutput()->ScatterToImage();
+
+  if( scattered->GetBufferedRegion() != features->GetBufferedRegion() )
+    {
+    std::cerr << filter->GetNameOfClass() << " compact output region is " << scattered->GetBufferedRegion()
+      << " but " << features->GetBufferedRegion() << " was expected" << std::endl;
+    return 1;
+    }
+
+  return CompareComponents( filter->GetNameOfClass(), scattered.GetPointer(),
+    0, features.GetPointer(), RoundingTolerance );
+}
+
+}
+
+int TextureFeaturesCompactOutputTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCompactFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCompactFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  BankFilterType::Pointer bankFilter = CreateBankFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCompactFeatures(
+    bankFilter.GetPointer() ) );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
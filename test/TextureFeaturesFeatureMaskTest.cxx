@@ -0,0 +1,165 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+#include <vector>
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the features of the filter selected by featureMask to the matching
+// components of allFeatures, computed with all the features selected.
+template< typename TFilter >
+unsigned int
+CompareSelectedFeatures( TFilter * filter, unsigned int featureMask,
+                         const typename TFilter::OutputImageType * allFeatures )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  filter->SetFeatureMask( featureMask );
+  filter->Update();
+  const FeatureImageType * features = filter->GetOutput();
+
+  std::vector< unsigned int > selectedComponents;
+  for( unsigned int bit = 0; ( 1u << bit ) <= static_cast< unsigned int >( TFilter::AllFeatures ); ++bit )
+    {
+    if( featureMask & ( 1u << bit ) )
+      {
+      selectedComponents.push_back( bit );
+      }
+    }
+  if( features->GetNumberOfComponentsPerPixel() != selectedComponents.size()
+      || filter->GetNumberOfFeatures() != selectedComponents.size() )
+    {
+    std::cerr << filter->GetNameOfClass() << " output of feature mask " << featureMask << " has "
+      << features->GetNumberOfComponentsPerPixel() << " components but " << selectedComponents.size()
+      << " were expected" << std::endl;
+    return 1;
+    }
+
+  itk::ImageRegionConstIterator< FeatureImageType > featuresIt( features, features->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< FeatureImageType > expectedIt( allFeatures, features->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  for(; !featuresIt.IsAtEnd(); ++featuresIt, ++expectedIt )
+    {
+    for( unsigned int i = 0; i < selectedComponents.size(); ++i )
+      {
+      const double expected = expectedIt.Get()[selectedComponents[i]];
+      const double value = featuresIt.Get()[i];
+      if( IsSameFeatureValue( value, expected, RoundingTolerance ) )
+        {
+        continue;
+        }
+      if( numberOfDifferences++ < 10 )
+        {
+        std::cerr << filter->GetNameOfClass() << " feature " << selectedComponents[i] << " of feature mask "
+          << featureMask << " at " << featuresIt.GetIndex() << " is " << value << " but " << expected
+          << " was expected" << std::endl;
+        }
+      }
+    }
+  return numberOfDifferences;
+}
+
+// Compare the features of the filter for each feature alone and for subsets
+// of them to the features computed with all of them.
+template< typename TFilter >
+unsigned int
+CompareFeatureMasks( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+  const auto allFeaturesMask = static_cast< unsigned int >( TFilter::AllFeatures );
+
+  filter->SetFeatureMask( allFeaturesMask );
+  typename FeatureImageType::Pointer allFeatures = UpdateAndDisconnect( filter );
+
+  unsigned int numberOfDifferences = 0;
+  for( unsigned int bit = 1; bit <= allFeaturesMask; bit <<= 1 )
+    {
+    numberOfDifferences += CompareSelectedFeatures( filter, bit, allFeatures.GetPointer() );
+    }
+  numberOfDifferences += CompareSelectedFeatures( filter, allFeaturesMask & 0x155u, allFeatures.GetPointer() );
+  numberOfDifferences += CompareSelectedFeatures( filter, allFeaturesMask & 0x2AAu, allFeatures.GetPointer() );
+  numberOfDifferences += CompareSelectedFeatures( filter, allFeaturesMask & ~1u, allFeatures.GetPointer() );
+
+  // At least one feature must be selected, among the ones of the filter
+  filter->SetFeatureMask( 0 );
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+  filter->SetFeatureMask( allFeaturesMask + 1 );
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+  filter->SetFeatureMask( allFeaturesMask );
+
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeaturesFeatureMaskTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TEST_SET_GET_VALUE( static_cast< unsigned int >( CoocurrenceFilterType::AllFeatures ),
+                      coocurrenceFilter->GetFeatureMask() );
+
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareFeatureMasks(
+    coocurrenceFilter.GetPointer() ) );
+
+  // The features are also selected when evaluated in separate passes
+  coocurrenceFilter->UseFusedFeatureEvaluationOff();
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareFeatureMasks(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TEST_SET_GET_VALUE( static_cast< unsigned int >( RunLengthFilterType::AllFeatures ),
+                      runLengthFilter->GetFeatureMask() );
+
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareFeatureMasks(
+    runLengthFilter.GetPointer() ) );
+
+  // Fixed length vectors of all the features cannot hold a subset of them
+  FixedCoocurrenceFilterType::Pointer fixedCoocurrenceFilter =
+    CreateCoocurrenceFilter< FixedCoocurrenceFilterType >( arguments );
+  TRY_EXPECT_NO_EXCEPTION( fixedCoocurrenceFilter->Update() );
+  fixedCoocurrenceFilter->SetFeatureMask( FixedCoocurrenceFilterType::EnergyFeature
+                                          | FixedCoocurrenceFilterType::EntropyFeature );
+  TRY_EXPECT_EXCEPTION( fixedCoocurrenceFilter->Update() );
+
+  FixedRunLengthFilterType::Pointer fixedRunLengthFilter =
+    CreateRunLengthFilter< FixedRunLengthFilterType >( arguments );
+  TRY_EXPECT_NO_EXCEPTION( fixedRunLengthFilter->Update() );
+  fixedRunLengthFilter->SetFeatureMask( FixedRunLengthFilterType::ShortRunEmphasisFeature
+                                        | FixedRunLengthFilterType::LongRunEmphasisFeature );
+  TRY_EXPECT_EXCEPTION( fixedRunLengthFilter->Update() );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
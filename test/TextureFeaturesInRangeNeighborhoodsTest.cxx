@@ -0,0 +1,87 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the features of the filter computed with and without detection of
+// the neighborhoods in range, which must be identical.
+template< typename TFilter >
+unsigned int
+CompareInRangeNeighborhoodsFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  filter->DetectInRangeNeighborhoodsOn();
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  filter->DetectInRangeNeighborhoodsOff();
+  filter->Update();
+  return CompareComponents( filter->GetNameOfClass(), features.GetPointer(), 0, filter->GetOutput(), 0.0 );
+}
+
+}
+
+int TextureFeaturesInRangeNeighborhoodsTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TEST_SET_GET_BOOLEAN( coocurrenceFilter, DetectInRangeNeighborhoods, true );
+
+  // Also count the pairs of the uniform neighborhoods
+  coocurrenceFilter->DetectUniformNeighborhoodsOff();
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareInRangeNeighborhoodsFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  // The pairs entering and leaving the sliding windows of the per offset
+  // matrices are also visited without test
+  coocurrenceFilter->PerOffsetFeaturesOn();
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareInRangeNeighborhoodsFeatures(
+    coocurrenceFilter.GetPointer() ) );
+  coocurrenceFilter->PerOffsetFeaturesOff();
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TEST_SET_GET_BOOLEAN( runLengthFilter, DetectInRangeNeighborhoods, true );
+
+  // Also look for the runs of the uniform neighborhoods
+  runLengthFilter->DetectUniformNeighborhoodsOff();
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareInRangeNeighborhoodsFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  // The runs of the coarser quantizations are also looked for without test
+  runLengthFilter->SetCoarserNumbersOfBinsPerAxis( RunLengthFilterType::NumberOfBinsVectorType( 1, 2 ) );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareInRangeNeighborhoodsFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
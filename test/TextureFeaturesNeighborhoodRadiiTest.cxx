@@ -0,0 +1,112 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the features of the filter for nested neighborhood radii to the
+// features computed with each radius alone.
+template< typename TFilter >
+unsigned int
+CompareNeighborhoodRadiiFeatures( TFilter * filter, unsigned int largestRadius )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+  using NeighborhoodRadiusType = typename TFilter::NeighborhoodRadiusType;
+
+  typename TFilter::NeighborhoodRadiusVectorType radii;
+  for( unsigned int r = 1; r <= largestRadius; ++r )
+    {
+    NeighborhoodRadiusType radius;
+    radius.Fill( r );
+    radii.push_back( radius );
+    }
+  const unsigned int numberOfFeatures = filter->GetNumberOfFeatures();
+
+  filter->SetNeighborhoodRadii( radii );
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  if( features->GetNumberOfComponentsPerPixel() != numberOfFeatures * radii.size() )
+    {
+    std::cerr << filter->GetNameOfClass() << " multi radius output has " << features->GetNumberOfComponentsPerPixel()
+      << " components but " << numberOfFeatures * radii.size() << " were expected" << std::endl;
+    return 1;
+    }
+
+  unsigned int numberOfDifferences = 0;
+  filter->SetNeighborhoodRadii( typename TFilter::NeighborhoodRadiusVectorType() );
+  for( unsigned int k = 0; k < radii.size(); ++k )
+    {
+    filter->SetNeighborhoodRadius( radii[k] );
+    filter->Update();
+    numberOfDifferences += CompareComponents( filter->GetNameOfClass(), features.GetPointer(),
+      k * numberOfFeatures, filter->GetOutput(), RoundingTolerance );
+    }
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeaturesNeighborhoodRadiiTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments, "largestNeighborhoodRadius" ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareNeighborhoodRadiiFeatures(
+    coocurrenceFilter.GetPointer(), arguments.neighborhoodRadius ) );
+
+  // The shells are accumulated in a single co-occurrence matrix without
+  // sliding window
+  coocurrenceFilter->UseSlidingWindowOff();
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareNeighborhoodRadiiFeatures(
+    coocurrenceFilter.GetPointer(), arguments.neighborhoodRadius ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareNeighborhoodRadiiFeatures(
+    runLengthFilter.GetPointer(), arguments.neighborhoodRadius ) );
+
+  // The features of several radii do not fit in fixed length vectors of
+  // the features of one radius
+  NeighborhoodRadiusType largerRadius;
+  largerRadius.Fill( arguments.neighborhoodRadius + 1 );
+
+  FixedCoocurrenceFilterType::Pointer fixedCoocurrenceFilter =
+    CreateCoocurrenceFilter< FixedCoocurrenceFilterType >( arguments );
+  fixedCoocurrenceFilter->SetNeighborhoodRadii( { arguments.GetNeighborhoodRadius(), largerRadius } );
+  TRY_EXPECT_EXCEPTION( fixedCoocurrenceFilter->Update() );
+
+  FixedRunLengthFilterType::Pointer fixedRunLengthFilter =
+    CreateRunLengthFilter< FixedRunLengthFilterType >( arguments );
+  fixedRunLengthFilter->SetNeighborhoodRadii( { arguments.GetNeighborhoodRadius(), largerRadius } );
+  TRY_EXPECT_EXCEPTION( fixedRunLengthFilter->Update() );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
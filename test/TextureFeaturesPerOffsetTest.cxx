@@ -0,0 +1,122 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the per offset features of the filter to the features computed
+// with each offset alone, and its pooled features to the default ones.
+template< typename TFilter >
+unsigned int
+ComparePerOffsetFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+  using OffsetVector = typename TFilter::OffsetVector;
+
+  typename OffsetVector::Pointer offsets = OffsetVector::New();
+  for( auto it = filter->GetOffsets()->Begin(); it != filter->GetOffsets()->End(); ++it )
+    {
+    offsets->push_back( it.Value() );
+    }
+  const unsigned int numberOfFeatures = filter->GetNumberOfFeatures();
+
+  filter->PerOffsetFeaturesOff();
+  filter->Update();
+  typename FeatureImageType::Pointer pooled = filter->GetOutput();
+  pooled->DisconnectPipeline();
+
+  filter->PerOffsetFeaturesOn();
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  if( features->GetNumberOfComponentsPerPixel() != numberOfFeatures * ( offsets->Size() + 1 ) )
+    {
+    std::cerr << filter->GetNameOfClass() << " per offset output has " << features->GetNumberOfComponentsPerPixel()
+      << " components but " << numberOfFeatures * ( offsets->Size() + 1 ) << " were expected" << std::endl;
+    return 1;
+    }
+
+  unsigned int numberOfDifferences = CompareComponents( filter->GetNameOfClass(), features.GetPointer(),
+    0, pooled.GetPointer(), RoundingTolerance );
+
+  filter->PerOffsetFeaturesOff();
+  for( unsigned int o = 0; o < offsets->Size(); ++o )
+    {
+    filter->SetOffset( offsets->ElementAt( o ) );
+    filter->Update();
+    numberOfDifferences += CompareComponents( filter->GetNameOfClass(), features.GetPointer(),
+      ( o + 1 ) * numberOfFeatures, filter->GetOutput(), RoundingTolerance );
+    }
+
+  // Without the pooled features, the ones of the offsets come first
+  filter->SetOffsets( offsets );
+  filter->PerOffsetFeaturesOn();
+  filter->PooledFeaturesOff();
+  filter->Update();
+  if( filter->GetOutput()->GetNumberOfComponentsPerPixel() != numberOfFeatures * offsets->Size() )
+    {
+    std::cerr << filter->GetNameOfClass() << " per offset output without the pooled features has "
+      << filter->GetOutput()->GetNumberOfComponentsPerPixel() << " components but "
+      << numberOfFeatures * offsets->Size() << " were expected" << std::endl;
+    ++numberOfDifferences;
+    }
+
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeaturesPerOffsetTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += ComparePerOffsetFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += ComparePerOffsetFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  // The features of several offsets do not fit in fixed length vectors of
+  // the features of one of them
+  FixedCoocurrenceFilterType::Pointer fixedCoocurrenceFilter =
+    CreateCoocurrenceFilter< FixedCoocurrenceFilterType >( arguments );
+  fixedCoocurrenceFilter->PerOffsetFeaturesOn();
+  TRY_EXPECT_EXCEPTION( fixedCoocurrenceFilter->Update() );
+
+  FixedRunLengthFilterType::Pointer fixedRunLengthFilter =
+    CreateRunLengthFilter< FixedRunLengthFilterType >( arguments );
+  fixedRunLengthFilter->PerOffsetFeaturesOn();
+  TRY_EXPECT_EXCEPTION( fixedRunLengthFilter->Update() );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
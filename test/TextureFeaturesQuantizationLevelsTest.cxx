@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the features of the filter for coarser numbers of bins to the
+// features computed with each number of bins alone.
+template< typename TFilter >
+unsigned int
+CompareCoarserQuantizationFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  // All the numbers of bins dividing the finest one
+  const unsigned int numberOfBinsPerAxis = filter->GetNumberOfBinsPerAxis();
+  typename TFilter::NumberOfBinsVectorType coarserNumbersOfBins;
+  for( unsigned int numberOfBins = numberOfBinsPerAxis - 1; numberOfBins > 1; --numberOfBins )
+    {
+    if( numberOfBinsPerAxis % numberOfBins == 0 )
+      {
+      coarserNumbersOfBins.push_back( numberOfBins );
+      }
+    }
+  const unsigned int numberOfFeatures = filter->GetNumberOfFeatures();
+
+  filter->SetCoarserNumbersOfBinsPerAxis( coarserNumbersOfBins );
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  const unsigned int numberOfComponents = numberOfFeatures * ( 1 + coarserNumbersOfBins.size() );
+  if( features->GetNumberOfComponentsPerPixel() != numberOfComponents )
+    {
+    std::cerr << filter->GetNameOfClass() << " multi quantization output has "
+      << features->GetNumberOfComponentsPerPixel() << " components but " << numberOfComponents
+      << " were expected" << std::endl;
+    return 1;
+    }
+
+  filter->SetCoarserNumbersOfBinsPerAxis( typename TFilter::NumberOfBinsVectorType() );
+  filter->Update();
+  unsigned int numberOfDifferences = CompareComponents( filter->GetNameOfClass(), features.GetPointer(),
+    0, filter->GetOutput(), RoundingTolerance );
+  for( unsigned int l = 0; l < coarserNumbersOfBins.size(); ++l )
+    {
+    filter->SetNumberOfBinsPerAxis( coarserNumbersOfBins[l] );
+    filter->Update();
+    numberOfDifferences += CompareComponents( filter->GetNameOfClass(), features.GetPointer(),
+      ( l + 1 ) * numberOfFeatures, filter->GetOutput(), RoundingTolerance );
+    }
+  filter->SetNumberOfBinsPerAxis( numberOfBinsPerAxis );
+
+  // The coarser numbers of bins must divide the finest one
+  filter->SetCoarserNumbersOfBinsPerAxis( typename TFilter::NumberOfBinsVectorType( 1, numberOfBinsPerAxis + 1 ) );
+  TRY_EXPECT_EXCEPTION( filter->Update() );
+  filter->SetCoarserNumbersOfBinsPerAxis( typename TFilter::NumberOfBinsVectorType() );
+
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeaturesQuantizationLevelsTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCoarserQuantizationFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  // The coarser matrices are also folded from the sparse one
+  coocurrenceFilter->SetHistogramRepresentation( CoocurrenceFilterType::SparseHistogram );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCoarserQuantizationFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareCoarserQuantizationFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  // The features of several quantizations do not fit in fixed length
+  // vectors of the features of one of them
+  const unsigned int coarserNumberOfBins = arguments.numberOfBinsPerAxis / 2;
+
+  FixedCoocurrenceFilterType::Pointer fixedCoocurrenceFilter =
+    CreateCoocurrenceFilter< FixedCoocurrenceFilterType >( arguments );
+  fixedCoocurrenceFilter->SetCoarserNumbersOfBinsPerAxis( { coarserNumberOfBins } );
+  TRY_EXPECT_EXCEPTION( fixedCoocurrenceFilter->Update() );
+
+  FixedRunLengthFilterType::Pointer fixedRunLengthFilter =
+    CreateRunLengthFilter< FixedRunLengthFilterType >( arguments );
+  fixedRunLengthFilter->SetCoarserNumbersOfBinsPerAxis( { coarserNumberOfBins } );
+  TRY_EXPECT_EXCEPTION( fixedRunLengthFilter->Update() );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
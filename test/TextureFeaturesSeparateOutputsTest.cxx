@@ -0,0 +1,125 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the per feature outputs of the filter to the components of its
+// image output.
+template< typename TFilter >
+unsigned int
+CompareSeparateFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+  using ScalarFeatureImageType = typename TFilter::ScalarFeatureImageType;
+
+  filter->SeparateFeatureOutputsOff();
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  filter->SeparateFeatureOutputsOn();
+  filter->Update();
+
+  unsigned int numberOfDifferences = 0;
+  for( unsigned int i = 0; i < features->GetNumberOfComponentsPerPixel(); ++i )
+    {
+    const ScalarFeatureImageType * feature = filter->GetFeatureOutput( i );
+    if( feature->GetBufferedRegion() != features->GetBufferedRegion() )
+      {
+      std::cerr << filter->GetNameOfClass() << " feature output " << i << " region is "
+        << feature->GetBufferedRegion() << " but " << features->GetBufferedRegion() << " was expected" << std::endl;
+      ++numberOfDifferences;
+      continue;
+      }
+
+    itk::ImageRegionConstIterator< ScalarFeatureImageType > featureIt( feature, features->GetBufferedRegion() );
+    itk::ImageRegionConstIterator< FeatureImageType > featuresIt( features, features->GetBufferedRegion() );
+    for(; !featuresIt.IsAtEnd(); ++featureIt, ++featuresIt )
+      {
+      const double expected = featuresIt.Get()[i];
+      const double value = featureIt.Get();
+      if( IsSameFeatureValue( value, expected, 0.0 ) )
+        {
+        continue;
+        }
+      if( numberOfDifferences++ < 10 )
+        {
+        std::cerr << filter->GetNameOfClass() << " feature output " << i << " at " << featuresIt.GetIndex()
+          << " is " << value << " but " << expected << " was expected" << std::endl;
+        }
+      }
+    }
+
+  // The feature outputs of the previous update are emptied
+  filter->SeparateFeatureOutputsOff();
+  filter->Update();
+  for( unsigned int i = 0; i < features->GetNumberOfComponentsPerPixel(); ++i )
+    {
+    if( filter->GetFeatureOutput( i )->GetBufferedRegion().GetNumberOfPixels() != 0 )
+      {
+      std::cerr << filter->GetNameOfClass() << " feature output " << i << " still holds "
+        << filter->GetFeatureOutput( i )->GetBufferedRegion() << " with SeparateFeatureOutputs off" << std::endl;
+      ++numberOfDifferences;
+      }
+    }
+
+  // The image output is emptied when the feature outputs are written
+  filter->SeparateFeatureOutputsOn();
+  filter->Update();
+  if( filter->GetOutput()->GetBufferedRegion().GetNumberOfPixels() != 0 )
+    {
+    std::cerr << filter->GetNameOfClass() << " image output still holds "
+      << filter->GetOutput()->GetBufferedRegion() << " with SeparateFeatureOutputs on" << std::endl;
+    ++numberOfDifferences;
+    }
+  return numberOfDifferences;
+}
+
+}
+
+int TextureFeaturesSeparateOutputsTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareSeparateFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareSeparateFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  BankFilterType::Pointer bankFilter = CreateBankFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareSeparateFeatures(
+    bankFilter.GetPointer() ) );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkStreamingImageFilter.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the output of the filter computed at once to the one computed in
+// numberOfStreamDivisions pieces.
+template< typename TFilter >
+unsigned int
+CompareStreamedFeatures( TFilter * filter, unsigned int numberOfStreamDivisions )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  using StreamingFilterType = itk::StreamingImageFilter< FeatureImageType, FeatureImageType >;
+  typename StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( filter->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+  streamer->Update();
+
+  return CompareComponents( filter->GetNameOfClass(), streamer->GetOutput(),
+    0, features.GetPointer(), RoundingTolerance );
+}
+
+}
+
+int TextureFeaturesStreamingTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments, "neighborhoodRadius", { "numberOfStreamDivisions" } ) )
+    {
+    return EXIT_FAILURE;
+    }
+  unsigned int numberOfStreamDivisions = std::stoi( argv[7] );
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareStreamedFeatures(
+    coocurrenceFilter.GetPointer(), numberOfStreamDivisions ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareStreamedFeatures(
+    runLengthFilter.GetPointer(), numberOfStreamDivisions ) );
+
+  BankFilterType::Pointer bankFilter = CreateBankFilter( arguments );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareStreamedFeatures(
+    bankFilter.GetPointer(), numberOfStreamDivisions ) );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
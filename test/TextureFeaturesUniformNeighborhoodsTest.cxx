@@ -0,0 +1,77 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureFeaturesTestHelpers.h"
+#include "itkTestingMacros.h"
+
+using namespace TextureFeaturesTesting;
+
+namespace
+{
+
+// Compare the features of the filter computed with and without detection of
+// the uniform neighborhoods, which must be identical.
+template< typename TFilter >
+unsigned int
+CompareUniformNeighborhoodsFeatures( TFilter * filter )
+{
+  using FeatureImageType = typename TFilter::OutputImageType;
+
+  filter->DetectUniformNeighborhoodsOn();
+  typename FeatureImageType::Pointer features = UpdateAndDisconnect( filter );
+
+  filter->DetectUniformNeighborhoodsOff();
+  filter->Update();
+  return CompareComponents( filter->GetNameOfClass(), features.GetPointer(), 0, filter->GetOutput(), 0.0 );
+}
+
+}
+
+int TextureFeaturesUniformNeighborhoodsTest( int argc, char *argv[] )
+{
+  TestArguments arguments;
+  if( !ParseTestArguments( argc, argv, arguments ) )
+    {
+    return EXIT_FAILURE;
+    }
+
+  unsigned int numberOfDifferences = 0;
+
+  CoocurrenceFilterType::Pointer coocurrenceFilter = CreateCoocurrenceFilter( arguments );
+  TEST_SET_GET_BOOLEAN( coocurrenceFilter, DetectUniformNeighborhoods, true );
+
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareUniformNeighborhoodsFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  // The uniform neighborhoods also interrupt the sliding window of the
+  // sparse matrix
+  coocurrenceFilter->SetHistogramRepresentation( CoocurrenceFilterType::SparseHistogram );
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareUniformNeighborhoodsFeatures(
+    coocurrenceFilter.GetPointer() ) );
+
+  RunLengthFilterType::Pointer runLengthFilter = CreateRunLengthFilter( arguments );
+  TEST_SET_GET_BOOLEAN( runLengthFilter, DetectUniformNeighborhoods, true );
+
+  TRY_EXPECT_NO_EXCEPTION( numberOfDifferences += CompareUniformNeighborhoodsFeatures(
+    runLengthFilter.GetPointer() ) );
+
+  TEST_EXPECT_EQUAL( numberOfDifferences, 0u );
+
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -178,3 +178,116 @@ TEST(TextureFeatures, FirstOrder_Test2)
   EXPECT_NEAR(13.3, p[7], .2) << "entropy";
   }
 }
+
+
+TEST(TextureFeatures, FirstOrder_VectorHistogram)
+{
+  using PixelType = short;
+  using FeatureType = itk::FixedArray<double,8>;
+  using MapHistogramType = itk::Function::FirstOrderTextureHistogram<PixelType, FeatureType, false>;
+  using VectorHistogramType = itk::Function::FirstOrderTextureHistogram<PixelType, FeatureType>;
+
+  // Slide a window of pixels over a sequence mixing negative and
+  // positive values, and compare the histogram implementations at
+  // each step.
+  std::vector<PixelType> values;
+  unsigned int state = 124;
+  for ( unsigned int i = 0; i < 500; ++i )
+    {
+    state = state * 1103515245u + 12345u;
+    values.push_back( static_cast<PixelType>( static_cast<int>( ( state >> 16 ) % 2001 ) - 1000 ) );
+    }
+
+  const unsigned int windowSize = 25;
+  MapHistogramType mapHistogram;
+  VectorHistogramType vectorHistogram;
+  for ( unsigned int i = 0; i < values.size(); ++i )
+    {
+    mapHistogram.AddPixel( values[i] );
+    vectorHistogram.AddPixel( values[i] );
+    if ( i >= windowSize )
+      {
+      mapHistogram.RemovePixel( values[i - windowSize] );
+      vectorHistogram.RemovePixel( values[i - windowSize] );
+      }
+    if ( i < 1 )
+      {
+      continue;
+      }
+
+    const FeatureType expected = mapHistogram.GetValue( values[i] );
+    const FeatureType p = vectorHistogram.GetValue( values[i] );
+    for ( unsigned int j = 0; j < 8; ++j )
+      {
+      EXPECT_DOUBLE_EQ( expected[j], p[j] ) << "feature " << j << " at " << i;
+      }
+    }
+}
+
+
+TEST(TextureFeatures, FirstOrder_IncrementalMoments)
+{
+  using PixelType = float;
+  using FeatureType = itk::FixedArray<double,8>;
+  using HistogramType = itk::Function::FirstOrderTextureHistogram<PixelType, FeatureType>;
+
+  // Slide a window over a long sequence of mostly distinct values,
+  // spread little around a large mean, and compare the features to the
+  // ones computed from the window content.
+  std::vector<PixelType> values;
+  unsigned int state = 124;
+  for ( unsigned int i = 0; i < 20000; ++i )
+    {
+    state = state * 1103515245u + 12345u;
+    values.push_back( 100000.0f + static_cast<PixelType>( ( state >> 16 ) % 4200 ) * 0.0625f + 0.25f * ( i % 3 ) );
+    }
+
+  const unsigned int windowSize = 125;
+  HistogramType histogram;
+  for ( unsigned int i = 0; i < values.size(); ++i )
+    {
+    histogram.AddPixel( values[i] );
+    if ( i >= windowSize )
+      {
+      histogram.RemovePixel( values[i - windowSize] );
+      }
+    if ( i + 1 < windowSize || i % 1000 != 0 )
+      {
+      continue;
+      }
+
+    std::map<PixelType, size_t> window;
+    double sum = 0.0;
+    for ( unsigned int j = i + 1 - windowSize; j <= i; ++j )
+      {
+      ++window[values[j]];
+      sum += values[j];
+      }
+    const double mean = sum / windowSize;
+    double sum2 = 0.0;
+    double sum3 = 0.0;
+    double sum4 = 0.0;
+    double entropy = 0.0;
+    for ( const auto & v : window )
+      {
+      const double x = v.first - mean;
+      sum2 += v.second * x * x;
+      sum3 += v.second * x * x * x;
+      sum4 += v.second * x * x * x * x;
+      const double p_x = double( v.second ) / windowSize;
+      entropy -= p_x * std::log( p_x ) / itk::Math::ln2;
+      }
+    const double variance = sum2 / ( windowSize - 1 );
+    const double skewness = ( sum3 / windowSize ) / ( variance * std::sqrt( variance ) );
+    const double kurtosis = ( sum4 / windowSize ) / ( variance * variance ) - 3.0;
+
+    const FeatureType p = histogram.GetValue( values[i] );
+    EXPECT_NEAR( mean, p[0], 1e-9 * mean ) << "mean at " << i;
+    EXPECT_EQ( window.begin()->first, p[1] ) << "minimum at " << i;
+    EXPECT_EQ( window.rbegin()->first, p[2] ) << "maximum at " << i;
+    EXPECT_NEAR( variance, p[3], 1e-9 * variance ) << "variance at " << i;
+    EXPECT_NEAR( skewness, p[5], 1e-6 ) << "skewness at " << i;
+    EXPECT_NEAR( kurtosis, p[6], 1e-6 ) << "kurtosis at " << i;
+    EXPECT_NEAR( entropy, p[7], 1e-9 ) << "entropy at " << i;
+    }
+}
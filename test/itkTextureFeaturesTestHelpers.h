@@ -0,0 +1,235 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTextureFeaturesTestHelpers_h
+#define itkTextureFeaturesTestHelpers_h
+
+#include "itkCoocurrenceTextureFeaturesImageFilter.h"
+#include "itkRunLengthTextureFeaturesImageFilter.h"
+#include "itkTextureFeatureBankImageFilter.h"
+
+#include "itkImage.h"
+#include "itkVectorImage.h"
+#include "itkVector.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+/** Setup and comparisons shared by the TextureFeatures*Test tests, which
+ * compare the features computed by the co-occurrence, run length and bank
+ * filters with two sets of options on the same input image and mask. */
+namespace TextureFeaturesTesting
+{
+
+constexpr unsigned int ImageDimension = 3;
+
+using InputPixelType = float;
+using OutputPixelComponentType = float;
+
+using InputImageType = itk::Image< InputPixelType, ImageDimension >;
+using OutputImageType = itk::VectorImage< OutputPixelComponentType, ImageDimension >;
+using ReaderType = itk::ImageFileReader< InputImageType >;
+
+using CoocurrenceFilterType = itk::Statistics::CoocurrenceTextureFeaturesImageFilter<
+  InputImageType, OutputImageType, InputImageType >;
+using RunLengthFilterType = itk::Statistics::RunLengthTextureFeaturesImageFilter<
+  InputImageType, OutputImageType, InputImageType >;
+using BankFilterType = itk::Statistics::TextureFeatureBankImageFilter<
+  InputImageType, OutputImageType, InputImageType >;
+
+/** Filters writing fixed length vectors of as many components as all the
+ * co-occurrence or run length features, which are rejected when the options
+ * need another number of components. */
+using FixedCoocurrenceImageType = itk::Image< itk::Vector< OutputPixelComponentType, 8 >, ImageDimension >;
+using FixedRunLengthImageType = itk::Image< itk::Vector< OutputPixelComponentType, 10 >, ImageDimension >;
+using FixedCoocurrenceFilterType = itk::Statistics::CoocurrenceTextureFeaturesImageFilter<
+  InputImageType, FixedCoocurrenceImageType, InputImageType >;
+using FixedRunLengthFilterType = itk::Statistics::RunLengthTextureFeaturesImageFilter<
+  InputImageType, FixedRunLengthImageType, InputImageType >;
+
+using NeighborhoodRadiusType = CoocurrenceFilterType::NeighborhoodRadiusType;
+
+/** Relative tolerance of the features computed along different code paths,
+ * which only differ by floating point rounding. */
+constexpr double RoundingTolerance = 1e-5;
+
+/** The arguments common to the tests: the input image and mask, the
+ * parameters of the digitization and the neighborhood radius. */
+struct TestArguments
+{
+  ReaderType::Pointer    reader;
+  ReaderType::Pointer    maskReader;
+  unsigned int           numberOfBinsPerAxis;
+  InputPixelType         pixelValueMin;
+  InputPixelType         pixelValueMax;
+  unsigned int           neighborhoodRadius;
+
+  NeighborhoodRadiusType GetNeighborhoodRadius() const
+    {
+    NeighborhoodRadiusType radius;
+    radius.Fill( neighborhoodRadius );
+    return radius;
+    }
+};
+
+/** Parse inputImageFile maskImageFile numberOfBinsPerAxis pixelValueMin
+ * pixelValueMax and the radius, followed by the extra arguments of the test,
+ * which are left in argv. Print the usage and return false when some are
+ * missing. */
+inline bool
+ParseTestArguments( int argc, char * argv[], TestArguments & arguments,
+                    const char * radiusArgument = "neighborhoodRadius",
+                    std::initializer_list< const char * > extraArguments = {} )
+{
+  if( argc < 7 + static_cast< int >( extraArguments.size() ) )
+    {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << argv[0]
+      << " inputImageFile"
+      << " maskImageFile"
+      << " numberOfBinsPerAxis"
+      << " pixelValueMin"
+      << " pixelValueMax"
+      << " " << radiusArgument;
+    for( const char * extraArgument : extraArguments )
+      {
+      std::cerr << " " << extraArgument;
+      }
+    std::cerr << std::endl;
+    return false;
+    }
+
+  arguments.reader = ReaderType::New();
+  arguments.reader->SetFileName( argv[1] );
+  arguments.maskReader = ReaderType::New();
+  arguments.maskReader->SetFileName( argv[2] );
+  arguments.numberOfBinsPerAxis = std::stoi( argv[3] );
+  arguments.pixelValueMin = std::stod( argv[4] );
+  arguments.pixelValueMax = std::stod( argv[5] );
+  arguments.neighborhoodRadius = std::stoi( argv[6] );
+  return true;
+}
+
+/** Filters of the tested family set up with the arguments. The run length
+ * distances range from 0 to 1.25. */
+template< typename TFilter = CoocurrenceFilterType >
+typename TFilter::Pointer
+CreateCoocurrenceFilter( const TestArguments & arguments )
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput( arguments.reader->GetOutput() );
+  filter->SetMaskImage( arguments.maskReader->GetOutput() );
+  filter->SetNumberOfBinsPerAxis( arguments.numberOfBinsPerAxis );
+  filter->SetHistogramMinimum( arguments.pixelValueMin );
+  filter->SetHistogramMaximum( arguments.pixelValueMax );
+  filter->SetNeighborhoodRadius( arguments.GetNeighborhoodRadius() );
+  return filter;
+}
+
+template< typename TFilter = RunLengthFilterType >
+typename TFilter::Pointer
+CreateRunLengthFilter( const TestArguments & arguments )
+{
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput( arguments.reader->GetOutput() );
+  filter->SetMaskImage( arguments.maskReader->GetOutput() );
+  filter->SetNumberOfBinsPerAxis( arguments.numberOfBinsPerAxis );
+  filter->SetHistogramValueMinimum( arguments.pixelValueMin );
+  filter->SetHistogramValueMaximum( arguments.pixelValueMax );
+  filter->SetHistogramDistanceMinimum( 0 );
+  filter->SetHistogramDistanceMaximum( 1.25 );
+  filter->SetNeighborhoodRadius( arguments.GetNeighborhoodRadius() );
+  return filter;
+}
+
+inline BankFilterType::Pointer
+CreateBankFilter( const TestArguments & arguments )
+{
+  BankFilterType::Pointer filter = BankFilterType::New();
+  filter->SetInput( arguments.reader->GetOutput() );
+  filter->SetMaskImage( arguments.maskReader->GetOutput() );
+  filter->SetNumberOfBinsPerAxis( arguments.numberOfBinsPerAxis );
+  filter->SetHistogramMinimum( arguments.pixelValueMin );
+  filter->SetHistogramMaximum( arguments.pixelValueMax );
+  filter->SetHistogramDistanceMinimum( 0 );
+  filter->SetHistogramDistanceMaximum( 1.25 );
+  filter->SetNeighborhoodRadius( arguments.GetNeighborhoodRadius() );
+  return filter;
+}
+
+/** Whether a feature value matches the expected one up to the relative
+ * tolerance, exactly when it is 0. A NaN feature matches a NaN. */
+inline bool
+IsSameFeatureValue( double value, double expected, double tolerance )
+{
+  if( value == expected || ( std::isnan( expected ) && std::isnan( value ) ) )
+    {
+    return true;
+    }
+  return std::abs( value - expected ) <= tolerance * ( 1.0 + std::abs( expected ) );
+}
+
+/** Count the differences between the components of expected and the ones
+ * of features from firstComponent on, reporting the first ones. */
+template< typename TFeatureImage >
+unsigned int
+CompareComponents( const char * name, const TFeatureImage * features, unsigned int firstComponent,
+                   const TFeatureImage * expected, double tolerance )
+{
+  itk::ImageRegionConstIterator< TFeatureImage > featuresIt( features, features->GetBufferedRegion() );
+  itk::ImageRegionConstIterator< TFeatureImage > expectedIt( expected, features->GetBufferedRegion() );
+
+  unsigned int numberOfDifferences = 0;
+  for(; !featuresIt.IsAtEnd(); ++featuresIt, ++expectedIt )
+    {
+    for( unsigned int i = 0; i < expected->GetNumberOfComponentsPerPixel(); ++i )
+      {
+      const double expectedValue = expectedIt.Get()[i];
+      const double value = featuresIt.Get()[firstComponent + i];
+      if( IsSameFeatureValue( value, expectedValue, tolerance ) )
+        {
+        continue;
+        }
+      if( numberOfDifferences++ < 10 )
+        {
+        std::cerr << name << " component " << firstComponent + i << " at " << featuresIt.GetIndex()
+          << " is " << value << " but " << expectedValue << " was expected" << std::endl;
+        }
+      }
+    }
+  return numberOfDifferences;
+}
+
+/** Update the filter and return its image output, disconnected from the
+ * pipeline so that it is kept when the filter is updated again. */
+template< typename TFilter >
+typename TFilter::OutputImageType::Pointer
+UpdateAndDisconnect( TFilter * filter )
+{
+  filter->Update();
+  typename TFilter::OutputImageType::Pointer features = filter->GetOutput();
+  features->DisconnectPipeline();
+  return features;
+}
+
+} // end namespace TextureFeaturesTesting
+
+#endif
@@ -0,0 +1,191 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureMaskBlocks.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "gtest/gtest.h"
+
+TEST(TextureFeatures, MaskBlocks_OccupiedRegions)
+{
+  constexpr unsigned int ImageDimension = 3;
+  using ImageType = itk::Image< uint8_t, ImageDimension >;
+  using MaskBlocksType = itk::Statistics::TextureMaskBlocks< ImageDimension >;
+  constexpr uint8_t outsideMaskValue = 255;
+
+  ImageType::IndexType bufferIndex = {{ -2, 0, 3 }};
+  ImageType::SizeType bufferSize = {{ 40, 30, 20 }};
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( ImageType::RegionType( bufferIndex, bufferSize ) );
+  image->Allocate();
+  image->FillBuffer( outsideMaskValue );
+
+  // Two small blobs far apart, and an isolated voxel
+  const ImageType::IndexType insideIndices[] = { {{ 3, 4, 5 }}, {{ 4, 4, 5 }}, {{ 4, 5, 6 }},
+                                                 {{ 30, 22, 17 }}, {{ 31, 22, 17 }}, {{ 12, 25, 9 }} };
+  for( const ImageType::IndexType & index : insideIndices )
+    {
+    image->SetPixel( index, 7 );
+    }
+
+  ImageType::RegionType region = image->GetBufferedRegion();
+  region.ShrinkByRadius( 1 );
+
+  MaskBlocksType maskBlocks;
+  maskBlocks.Compute( image.GetPointer(), region, outsideMaskValue );
+
+  ImageType::IndexType lower = {{ 3, 4, 5 }};
+  ImageType::IndexType upper = {{ 31, 25, 17 }};
+  EXPECT_EQ( maskBlocks.GetBoundingBox().GetIndex(), lower );
+  EXPECT_EQ( maskBlocks.GetBoundingBox().GetUpperIndex(), upper );
+
+  // The occupied regions of a work unit are disjoint, inside of it, and
+  // cover all of its voxels inside of the mask
+  ImageType::RegionType workUnitRegion = region;
+  workUnitRegion.SetIndex( 2, 6 );
+  workUnitRegion.SetSize( 2, 14 );
+  const MaskBlocksType::RegionVectorType occupiedRegions = maskBlocks.GetOccupiedRegions( workUnitRegion );
+
+  ImageType::Pointer coverage = ImageType::New();
+  coverage->SetRegions( image->GetBufferedRegion() );
+  coverage->Allocate();
+  coverage->FillBuffer( 0 );
+  itk::SizeValueType numberOfCoveredVoxels = 0;
+  for( const ImageType::RegionType & occupiedRegion : occupiedRegions )
+    {
+    EXPECT_TRUE( workUnitRegion.IsInside( occupiedRegion ) );
+    for( itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, occupiedRegion ); !it.IsAtEnd(); ++it )
+      {
+      coverage->SetPixel( it.GetIndex(), coverage->GetPixel( it.GetIndex() ) + 1 );
+      ++numberOfCoveredVoxels;
+      }
+    }
+  EXPECT_LT( numberOfCoveredVoxels, workUnitRegion.GetNumberOfPixels() / 10 );
+
+  for( itk::ImageRegionConstIteratorWithIndex< ImageType > it( image, workUnitRegion ); !it.IsAtEnd(); ++it )
+    {
+    EXPECT_LE( coverage->GetPixel( it.GetIndex() ), 1 );
+    if( it.Get() != outsideMaskValue )
+      {
+      EXPECT_EQ( coverage->GetPixel( it.GetIndex() ), 1 ) << it.GetIndex();
+      }
+    }
+
+  // Without mask, the work unit is visited at once
+  maskBlocks.SetAllOccupied( region );
+  const MaskBlocksType::RegionVectorType allRegions = maskBlocks.GetOccupiedRegions( workUnitRegion );
+  ASSERT_EQ( allRegions.size(), 1u );
+  EXPECT_EQ( allRegions[0], workUnitRegion );
+
+  // Empty mask
+  image->FillBuffer( outsideMaskValue );
+  maskBlocks.Compute( image.GetPointer(), region, outsideMaskValue );
+  EXPECT_TRUE( maskBlocks.GetOccupiedRegions( workUnitRegion ).empty() );
+}
+
+TEST(TextureFeatures, MaskBlocks_SplitRegion)
+{
+  constexpr unsigned int ImageDimension = 3;
+  using ImageType = itk::Image< uint8_t, ImageDimension >;
+  using MaskBlocksType = itk::Statistics::TextureMaskBlocks< ImageDimension >;
+  constexpr uint8_t outsideMaskValue = 255;
+
+  ImageType::SizeType size = {{ 20, 20, 64 }};
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  image->FillBuffer( outsideMaskValue );
+
+  // The mask only covers 4 slices
+  ImageType::IndexType maskIndex = {{ 0, 0, 30 }};
+  ImageType::SizeType maskSize = {{ 20, 20, 4 }};
+  for( itk::ImageRegionIteratorWithIndex< ImageType > it( image, ImageType::RegionType( maskIndex, maskSize ) );
+       !it.IsAtEnd(); ++it )
+    {
+    it.Set( 0 );
+    }
+
+  MaskBlocksType maskBlocks;
+  maskBlocks.Compute( image.GetPointer(), image->GetBufferedRegion(), outsideMaskValue );
+
+  // The slabs tile the region, and the ones holding the mask are thin
+  const MaskBlocksType::RegionVectorType pieces = maskBlocks.SplitRegion( 8, 100.0 );
+  ASSERT_FALSE( pieces.empty() );
+  EXPECT_LE( pieces.size(), 8u );
+  itk::IndexValueType nextSlice = 0;
+  for( const ImageType::RegionType & piece : pieces )
+    {
+    EXPECT_EQ( piece.GetIndex( 2 ), nextSlice );
+    EXPECT_EQ( piece.GetSize( 0 ), size[0] );
+    EXPECT_EQ( piece.GetSize( 1 ), size[1] );
+    nextSlice += piece.GetSize( 2 );
+    if( piece.GetIndex( 2 ) >= 30 && piece.GetIndex( 2 ) < 34 )
+      {
+      EXPECT_LE( piece.GetSize( 2 ), 2u );
+      }
+    }
+  EXPECT_EQ( nextSlice, static_cast< itk::IndexValueType >( size[2] ) );
+
+  // Without mask, the slabs have about the same thickness
+  maskBlocks.SetAllOccupied( image->GetBufferedRegion() );
+  const MaskBlocksType::RegionVectorType uniformPieces = maskBlocks.SplitRegion( 8, 100.0 );
+  ASSERT_EQ( uniformPieces.size(), 8u );
+  for( const ImageType::RegionType & piece : uniformPieces )
+    {
+    EXPECT_EQ( piece.GetSize( 2 ), 8u );
+    }
+}
+
+TEST(TextureFeatures, MaskBlocks_SplitSingleSlice)
+{
+  constexpr unsigned int ImageDimension = 3;
+  using ImageType = itk::Image< uint8_t, ImageDimension >;
+  using MaskBlocksType = itk::Statistics::TextureMaskBlocks< ImageDimension >;
+  constexpr uint8_t outsideMaskValue = 255;
+
+  ImageType::IndexType index = {{ 0, 5, 2 }};
+  ImageType::SizeType size = {{ 32, 64, 1 }};
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( ImageType::RegionType( index, size ) );
+  image->Allocate();
+  image->FillBuffer( 0 );
+
+  // A single slice is cut in rows, so that all the work units get some
+  MaskBlocksType maskBlocks;
+  maskBlocks.Compute( image.GetPointer(), image->GetBufferedRegion(), outsideMaskValue );
+  const MaskBlocksType::RegionVectorType pieces = maskBlocks.SplitRegion( 8, 100.0 );
+  ASSERT_EQ( pieces.size(), 8u );
+  itk::IndexValueType nextRow = index[1];
+  for( const ImageType::RegionType & piece : pieces )
+    {
+    EXPECT_EQ( piece.GetIndex( 0 ), index[0] );
+    EXPECT_EQ( piece.GetSize( 0 ), size[0] );
+    EXPECT_EQ( piece.GetIndex( 1 ), nextRow );
+    EXPECT_EQ( piece.GetSize( 1 ), 8u );
+    EXPECT_EQ( piece.GetIndex( 2 ), index[2] );
+    EXPECT_EQ( piece.GetSize( 2 ), 1u );
+    nextRow += piece.GetSize( 1 );
+    }
+  EXPECT_EQ( nextRow, index[1] + static_cast< itk::IndexValueType >( size[1] ) );
+
+  // Never more pieces than rows
+  ImageType::RegionType fewRows = image->GetBufferedRegion();
+  fewRows.SetSize( 1, 3 );
+  maskBlocks.SetAllOccupied( fewRows );
+  EXPECT_EQ( maskBlocks.SplitRegion( 8, 100.0 ).size(), 3u );
+}
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureNeighborhoodKernel.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImage.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+
+// Walk a region strictly inside of the buffer of an image whose voxels all
+// have different values, and compare the kernel to the neighborhood iterator.
+// The neighborhood in range flag only holds for the current voxel.
+template< unsigned int VDimension >
+void CompareToNeighborhoodIterator()
+{
+  using ImageType = itk::Image< unsigned int, VDimension >;
+  using KernelType = itk::Statistics::TextureNeighborhoodKernel< ImageType >;
+  using IteratorType = itk::ConstNeighborhoodIterator< ImageType >;
+
+  typename ImageType::IndexType bufferIndex;
+  typename ImageType::SizeType bufferSize;
+  typename ImageType::IndexType regionIndex;
+  typename ImageType::SizeType regionSize;
+  typename KernelType::RadiusType radius;
+  for( unsigned int d = 0; d < VDimension; ++d )
+    {
+    bufferIndex[d] = -3 + static_cast< itk::IndexValueType >( d );
+    bufferSize[d] = 11 + d;
+    regionIndex[d] = bufferIndex[d] + 2 + d;
+    regionSize[d] = 4 + d;
+    radius[d] = 2;
+    }
+
+  typename ImageType::Pointer image = ImageType::New();
+  image->SetRegions( typename ImageType::RegionType( bufferIndex, bufferSize ) );
+  image->Allocate();
+  unsigned int * buffer = image->GetBufferPointer();
+  for( itk::SizeValueType i = 0; i < image->GetBufferedRegion().GetNumberOfPixels(); ++i )
+    {
+    buffer[i] = static_cast< unsigned int >( i );
+    }
+
+  const typename ImageType::RegionType region( regionIndex, regionSize );
+  KernelType kernel( radius, image.GetPointer(), region );
+  IteratorType it( radius, image.GetPointer(), region );
+  ASSERT_EQ( kernel.Size(), it.Size() );
+
+  itk::SizeValueType numberOfVoxels = 0;
+  for(; !it.IsAtEnd(); ++it, ++kernel, ++numberOfVoxels )
+    {
+    ASSERT_FALSE( kernel.IsAtEnd() );
+    EXPECT_FALSE( kernel.IsNeighborhoodInRange() );
+    kernel.SetNeighborhoodInRange( true );
+    EXPECT_TRUE( kernel.IsNeighborhoodInRange() );
+    EXPECT_EQ( kernel.GetIndex(), it.GetIndex() );
+    EXPECT_EQ( kernel.GetCenterPixel(), it.GetCenterPixel() );
+    for( typename KernelType::NeighborIndexType nb = 0; nb < it.Size(); ++nb )
+      {
+      EXPECT_EQ( kernel.GetPixel( nb ), it.GetPixel( nb ) );
+      }
+    }
+  EXPECT_TRUE( kernel.IsAtEnd() );
+  EXPECT_EQ( numberOfVoxels, region.GetNumberOfPixels() );
+}
+
+}
+
+TEST(TextureFeatures, NeighborhoodKernel_2D)
+{
+  CompareToNeighborhoodIterator< 2 >();
+}
+
+TEST(TextureFeatures, NeighborhoodKernel_3D)
+{
+  CompareToNeighborhoodIterator< 3 >();
+}
+
+TEST(TextureFeatures, NeighborhoodKernel_4D)
+{
+  CompareToNeighborhoodIterator< 4 >();
+}
+
+// At the boundary of the image, only the neighbors inside of its largest
+// possible region must be buffered.
+TEST(TextureFeatures, NeighborhoodKernel_ImageBoundary)
+{
+  using ImageType = itk::Image< unsigned int, 2 >;
+  using KernelType = itk::Statistics::TextureNeighborhoodKernel< ImageType >;
+
+  ImageType::IndexType index;
+  index.Fill( 0 );
+  ImageType::SizeType largestSize;
+  largestSize.Fill( 10 );
+  ImageType::SizeType bufferSize;
+  bufferSize.Fill( 6 );
+  KernelType::RadiusType radius;
+  radius.Fill( 2 );
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetLargestPossibleRegion( ImageType::RegionType( index, largestSize ) );
+  image->SetBufferedRegion( ImageType::RegionType( index, bufferSize ) );
+  image->Allocate();
+  image->FillBuffer( 7 );
+
+  ImageType::SizeType regionSize;
+  regionSize.Fill( 4 );
+  const KernelType kernel( radius, image.GetPointer(), ImageType::RegionType( index, regionSize ) );
+  EXPECT_EQ( kernel.GetIndex(), index );
+  EXPECT_EQ( kernel.GetCenterPixel(), 7u );
+  EXPECT_EQ( kernel.GetPixel( kernel.Size() - 1 ), 7u );
+
+  // The neighbors of the last voxel inside of the image are not all buffered
+  regionSize.Fill( 5 );
+  EXPECT_THROW( KernelType( radius, image.GetPointer(), ImageType::RegionType( index, regionSize ) ),
+                itk::ExceptionObject );
+}
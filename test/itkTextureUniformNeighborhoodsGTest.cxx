@@ -0,0 +1,91 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTextureUniformNeighborhoods.h"
+#include "itkImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkConstNeighborhoodIterator.h"
+
+#include "gtest/gtest.h"
+
+TEST(TextureFeatures, UniformNeighborhoods_MatchNeighborhoodScan)
+{
+  constexpr unsigned int ImageDimension = 3;
+  using ImageType = itk::Image< uint8_t, ImageDimension >;
+  using UniformNeighborhoodsType = itk::Statistics::TextureUniformNeighborhoods< ImageDimension >;
+  constexpr uint8_t outsideMaskValue = 255;
+  constexpr uint8_t outOfRangeValue = 254;
+
+  ImageType::IndexType bufferIndex = {{ -3, 2, 0 }};
+  ImageType::SizeType bufferSize = {{ 24, 18, 14 }};
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( ImageType::RegionType( bufferIndex, bufferSize ) );
+  image->Allocate();
+
+  // Piecewise constant blocks of two bins, with an outside of the mask slab
+  // and an out of range blob
+  for( itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetBufferedRegion() ); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    uint8_t value = ( index[0] < 8 ) ? 3 : 5;
+    if( index[2] >= 10 )
+      {
+      value = outsideMaskValue;
+      }
+    else if( index[0] >= 12 && index[0] < 15 && index[1] >= 8 && index[1] < 11 && index[2] < 6 )
+      {
+      value = outOfRangeValue;
+      }
+    it.Set( value );
+    }
+  image->SetPixel( {{ 2, 12, 4 }}, 4 );
+
+  ImageType::SizeType radius = {{ 2, 1, 2 }};
+  ImageType::RegionType region = image->GetBufferedRegion();
+  region.ShrinkByRadius( radius );
+
+  UniformNeighborhoodsType uniformNeighborhoods;
+  EXPECT_TRUE( uniformNeighborhoods.IsEmpty() );
+  uniformNeighborhoods.Compute( image.GetPointer(), region, radius, outOfRangeValue );
+  EXPECT_FALSE( uniformNeighborhoods.IsEmpty() );
+
+  unsigned int numberOfUniform = 0;
+  unsigned int numberOfInRange = 0;
+  unsigned int numberOfMismatches = 0;
+  itk::ConstNeighborhoodIterator< ImageType > nIt( radius, image, region );
+  for(; !nIt.IsAtEnd(); ++nIt )
+    {
+    bool inRange = true;
+    bool uniform = true;
+    for( itk::SizeValueType i = 0; i < nIt.Size(); ++i )
+      {
+      inRange = inRange && nIt.GetPixel( i ) < outOfRangeValue;
+      uniform = uniform && nIt.GetPixel( i ) == nIt.GetCenterPixel();
+      }
+    uniform = uniform && inRange;
+    numberOfInRange += inRange ? 1 : 0;
+    numberOfUniform += uniform ? 1 : 0;
+    numberOfMismatches += ( uniformNeighborhoods.IsInRange( nIt.GetIndex() ) != inRange ) ? 1 : 0;
+    numberOfMismatches += ( uniformNeighborhoods.IsUniform( nIt.GetIndex() ) != uniform ) ? 1 : 0;
+    }
+  EXPECT_GT( numberOfUniform, 0u );
+  EXPECT_GT( numberOfInRange, numberOfUniform );
+  EXPECT_EQ( numberOfMismatches, 0u );
+
+  uniformNeighborhoods.Clear();
+  EXPECT_TRUE( uniformNeighborhoods.IsEmpty() );
+}